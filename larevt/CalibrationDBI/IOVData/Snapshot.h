@@ -19,18 +19,62 @@
 #include "IOVDataError.h"
 #include "IOVTimeStamp.h"
 #include <algorithm>
+#include <limits>
 #include <sstream>
+#include <string>
 #include <vector>
 
 namespace lariov {
 
   /**
      \class Snapshot
+     Rows are kept sorted by channel.  If the channel range is compact, a dense
+     channel to row index is kept alongside, and GetRow/HasChannel are O(1);
+     otherwise they fall back to a binary search.  Rows added in channel order
+     extend the index in place; other insertions leave it stale until the next
+     lookup, which rebuilds it.  That rebuild is not thread-safe: call
+     UpdateIndex before sharing a modified snapshot between threads.
   */
   template <class T>
   class Snapshot {
 
   public:
+    /**
+       \class Builder
+       Bulk construction of the rows of a snapshot.  Rows are appended in any
+       order, then sorted once by channel when the builder is finalized, which
+       costs O(n log n), or O(n) if the rows were appended in channel order.
+       Only available if T has base class ChData.
+    */
+    class Builder {
+    public:
+      /// Policy for rows with the same channel
+      enum class Duplicates {
+        kKeepLast,  ///< Keep the row appended last (same as AddOrReplaceRow)
+        kKeepFirst, ///< Keep the row appended first
+        kThrow      ///< Throw IOVDataError
+      };
+
+      explicit Builder(Duplicates policy = Duplicates::kKeepLast) : fPolicy(policy) {}
+
+      void Reserve(size_t n) { fRows.reserve(n); }
+      size_t Size() const { return fRows.size(); }
+
+      void Append(const T& row)
+      {
+        if (!fRows.empty() && row < fRows.back()) fSorted = false;
+        fRows.push_back(row);
+      }
+
+      /// Replace the rows of the snapshot (the IoV is not changed) and reset the builder
+      void Finalize(Snapshot<T>& snapshot);
+
+    private:
+      Duplicates fPolicy;
+      bool fSorted = true; // Rows were appended in (non-decreasing) channel order.
+      std::vector<T> fRows;
+    };
+
     /// Default constructor
     Snapshot() : fStart(0, 0), fEnd(0, 0) {}
 
@@ -54,11 +98,7 @@ namespace lariov {
               typename std::enable_if<std::is_base_of<ChData, U>::value, int>::type = 0>
     bool HasChannel(unsigned int ch) const
     {
-
-      typename std::vector<T>::const_iterator it = std::lower_bound(fData.begin(), fData.end(), ch);
-      if (it == fData.end() || it->Channel() != ch) { return false; }
-      else
-        return true;
+      return FindRow(ch) != nullptr;
     }
 
     template <class U = T,
@@ -66,15 +106,15 @@ namespace lariov {
     const T& GetRow(unsigned int ch) const
     {
 
-      typename std::vector<T>::const_iterator it = std::lower_bound(fData.begin(), fData.end(), ch);
+      const T* row = FindRow(ch);
 
-      if (it == fData.end() || it->Channel() != ch) {
+      if (!row) {
         std::string msg("Channel not found: ");
         msg += std::to_string(ch);
         throw IOVDataError(msg);
       }
 
-      return *it;
+      return *row;
     }
 
     template <class U = T,
@@ -86,17 +126,65 @@ namespace lariov {
       if (it == fData.end() || data.Channel() != it->Channel()) {
         bool sort = (!(fData.empty()) && data < fData.back());
         fData.push_back(data);
-        if (sort) std::sort(fData.begin(), fData.end());
+        if (sort) {
+          std::sort(fData.begin(), fData.end());
+          fIndexStale = true; // Slots after the new row have moved.
+        }
+        else
+          AppendToIndex();
       }
       else {
         *it = data;
       }
     }
 
+    /// Rebuild the channel index now if rows were inserted out of channel order
+    void UpdateIndex()
+    {
+      if (fIndexStale) BuildIndex();
+    }
+
+    /// Whether lookups use the dense channel index (channel range is compact)
+    bool HasDenseIndex() const
+    {
+      if (fIndexStale) BuildIndex();
+      return !fIndex.empty();
+    }
+
+  private:
+    /// Index entry of channels with no row
+    static constexpr unsigned int kNoSlot = std::numeric_limits<unsigned int>::max();
+
+    /// The dense index is used if the channel range is at most this many times the row count
+    static constexpr size_t kMaxIndexSparsity = 4;
+
+    /// Row of channel ch, or nullptr: O(1) with the dense index, O(log n) otherwise
+    const T* FindRow(unsigned int ch) const
+    {
+      if (fIndexStale) BuildIndex();
+      if (!fIndex.empty()) {
+        if (ch < fFirstChannel || ch - fFirstChannel >= fIndex.size()) return nullptr;
+        unsigned int const slot = fIndex[ch - fFirstChannel];
+        return slot == kNoSlot ? nullptr : &fData[slot];
+      }
+      typename std::vector<T>::const_iterator it = std::lower_bound(fData.begin(), fData.end(), ch);
+      if (it == fData.end() || it->Channel() != ch) return nullptr;
+      return &*it;
+    }
+
+    /// Rebuild the channel to slot index from the (sorted) rows
+    void BuildIndex() const;
+
+    /// Extend the index with the last row, appended in channel order
+    void AppendToIndex();
+
   private:
     IOVTimeStamp fStart;
     IOVTimeStamp fEnd;
     std::vector<T> fData;
+    mutable unsigned int fFirstChannel = 0;   ///< Channel of fIndex[0]
+    mutable std::vector<unsigned int> fIndex; ///< Row of each channel, or kNoSlot; empty if sparse
+    mutable bool fIndexStale = false;         ///< fIndex must be rebuilt before use
   };
 
   //=============================================
@@ -106,10 +194,82 @@ namespace lariov {
   void Snapshot<T>::Clear()
   {
     fData.clear();
+    fIndex.clear();
+    fIndexStale = false;
     fStart = fEnd = IOVTimeStamp::MaxTimeStamp();
     fStart.SetStamp(fStart.Stamp() - 1, fStart.SubStamp());
   }
 
+  template <class T>
+  void Snapshot<T>::Builder::Finalize(Snapshot<T>& snapshot)
+  {
+    // A stable sort keeps rows of the same channel in the order they were appended.
+
+    if (!fSorted) std::stable_sort(fRows.begin(), fRows.end());
+
+    // Resolve duplicates in one pass.
+
+    size_t out = 0;
+    for (size_t in = 0; in < fRows.size(); ++in) {
+      if (out > 0 && fRows[out - 1].Channel() == fRows[in].Channel()) {
+        if (fPolicy == Duplicates::kThrow) {
+          std::string msg("Duplicate channel in snapshot: ");
+          msg += std::to_string(fRows[in].Channel());
+          throw IOVDataError(msg);
+        }
+        if (fPolicy == Duplicates::kKeepLast) fRows[out - 1] = std::move(fRows[in]);
+        continue;
+      }
+      if (out != in) fRows[out] = std::move(fRows[in]);
+      ++out;
+    }
+    fRows.erase(fRows.begin() + out, fRows.end());
+
+    snapshot.fData = std::move(fRows);
+    snapshot.BuildIndex();
+    fRows = std::vector<T>();
+    fSorted = true;
+  }
+
+  template <class T>
+  void Snapshot<T>::BuildIndex() const
+  {
+    fIndex.clear();
+    fIndexStale = false;
+    if (fData.empty()) return;
+
+    // Only worth it if most of the channel range has rows.
+
+    fFirstChannel = fData.front().Channel();
+    size_t const range = size_t(fData.back().Channel() - fFirstChannel) + 1;
+    if (range > kMaxIndexSparsity * fData.size()) return;
+
+    fIndex.assign(range, kNoSlot);
+    for (size_t slot = 0; slot < fData.size(); ++slot)
+      fIndex[fData[slot].Channel() - fFirstChannel] = slot;
+  }
+
+  template <class T>
+  void Snapshot<T>::AppendToIndex()
+  {
+    if (fIndexStale) return;
+    if (fData.size() == 1) {
+      BuildIndex();
+      return;
+    }
+
+    // Extend a dense index while the channel range stays compact; otherwise let
+    // the next lookup decide whether an index is worth it.
+
+    size_t const offset = size_t(fData.back().Channel() - fFirstChannel);
+    if (fIndex.empty() || offset >= kMaxIndexSparsity * fData.size()) {
+      fIndexStale = true;
+      return;
+    }
+    fIndex.resize(offset + 1, kNoSlot);
+    fIndex[offset] = fData.size() - 1;
+  }
+
   template <class T>
   void Snapshot<T>::SetIoV(const IOVTimeStamp& start, const IOVTimeStamp& end)
   {
@@ -14,11 +14,15 @@
 
 // LArSoft libraries
 #include "larcore/CoreUtils/ServiceUtil.h" // ServiceRequirementsChecker<>
+#include "larevt/CalibrationDBI/Interface/CalibrationDBIFwd.h"
 #include "larevt/CalibrationDBI/Interface/ChannelStatusProvider.h"
 
 // Framework libraries
 #include "art/Framework/Services/Registry/ServiceDeclarationMacros.h"
 
+// C/C++ standard libraries
+#include <memory>
+
 //forward declarations
 namespace lariov {
   class ChannelStatusProvider;
@@ -91,6 +95,13 @@ namespace lariov {
 
     ChannelStatusProvider const* provider() const { return GetProviderPtr(); }
 
+    /// Provider of channel statuses valid at the specified event time (`evt.time().value()`),
+    /// safe with events of different times processed concurrently (unlike GetProvider())
+    std::shared_ptr<const ChannelStatusProvider> ProviderFor(DBTimeStamp_t ts) const
+    {
+      return DoGetProviderFor(ts);
+    }
+
     //
     // end of interface
     //
@@ -102,6 +113,13 @@ namespace lariov {
     /// Returns a reference to the service provider
     virtual ChannelStatusProvider const& DoGetProvider() const = 0;
 
+    /// Returns the provider for the specified event time; by default, the one
+    /// updated for the current event (which is only correct with one schedule)
+    virtual std::shared_ptr<const ChannelStatusProvider> DoGetProviderFor(DBTimeStamp_t) const
+    {
+      return {std::shared_ptr<const void>(), &DoGetProvider()};
+    }
+
   }; // class ChannelStatusService
 
 } // namespace lariov
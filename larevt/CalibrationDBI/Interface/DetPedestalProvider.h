@@ -13,6 +13,9 @@
 #include "larcorealg/CoreUtils/UncopiableAndUnmovableClass.h"
 #include "larcoreobj/SimpleTypesAndConstants/RawTypes.h" // raw::ChannelID_t
 
+// C/C++ standard libraries
+#include <span>
+
 namespace lariov {
 
   /**
@@ -32,6 +35,19 @@ namespace lariov {
     virtual float PedMeanErr(raw::ChannelID_t ch) const = 0;
     virtual float PedRmsErr(raw::ChannelID_t ch) const = 0;
 
+    /**
+     * @brief Pedestal information of all channels, as contiguous arrays indexed by channel
+     *
+     * Entry `ch` of each array holds the value for channel `ch`; channels
+     * without pedestal have value 0.  The arrays are empty if the
+     * implementation does not provide them, and are valid until the next
+     * update of the pedestals.
+     */
+    virtual std::span<const float> PedMeans() const { return {}; }
+    virtual std::span<const float> PedRmss() const { return {}; }
+    virtual std::span<const float> PedMeanErrs() const { return {}; }
+    virtual std::span<const float> PedRmsErrs() const { return {}; }
+
     /* TODO DELME
       /// Update local state of implementation
       virtual bool Update(DBTimeStamp_t ts) = 0;
@@ -3,6 +3,9 @@
 
 #include "art/Framework/Services/Registry/ServiceDeclarationMacros.h"
 #include "larcore/CoreUtils/ServiceUtil.h" // unused; for includer's convenience
+#include "larevt/CalibrationDBI/Interface/CalibrationDBIFwd.h"
+
+#include <memory>
 
 //forward declarations
 namespace lariov {
@@ -27,8 +30,22 @@ namespace lariov {
 
     DetPedestalProvider const* provider() const { return &DoGetPedestalProvider(); }
 
+    /// Provider of pedestals valid at the specified event time (`evt.time().value()`),
+    /// safe with events of different times processed concurrently (unlike GetPedestalProvider())
+    std::shared_ptr<const DetPedestalProvider> ProviderFor(DBTimeStamp_t ts) const
+    {
+      return DoGetPedestalProviderFor(ts);
+    }
+
   private:
     virtual const DetPedestalProvider& DoGetPedestalProvider() const = 0;
+
+    /// Returns the provider for the specified event time; by default, the one
+    /// updated for the current event (which is only correct with one schedule)
+    virtual std::shared_ptr<const DetPedestalProvider> DoGetPedestalProviderFor(DBTimeStamp_t) const
+    {
+      return {std::shared_ptr<const void>(), &DoGetPedestalProvider()};
+    }
   };
 } //end namespace lariov
 
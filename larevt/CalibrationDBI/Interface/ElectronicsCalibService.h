@@ -11,6 +11,12 @@
 // Framework libraries
 #include "art/Framework/Services/Registry/ServiceDeclarationMacros.h"
 
+// LArSoft libraries
+#include "larevt/CalibrationDBI/Interface/CalibrationDBIFwd.h"
+
+// C/C++ standard libraries
+#include <memory>
+
 //forward declarations
 namespace lariov {
   class ElectronicsCalibProvider;
@@ -35,12 +41,27 @@ namespace lariov {
 
     ElectronicsCalibProvider const* GetProviderPtr() const { return DoGetProviderPtr(); }
 
+    /// Provider of electronics calibrations valid at the specified event time
+    /// (`evt.time().value()`), safe with events of different times processed
+    /// concurrently (unlike GetProvider())
+    std::shared_ptr<const ElectronicsCalibProvider> ProviderFor(DBTimeStamp_t ts) const
+    {
+      return DoGetProviderFor(ts);
+    }
+
   private:
     /// Returns a reference to the service provider
     virtual ElectronicsCalibProvider const& DoGetProvider() const = 0;
 
     virtual ElectronicsCalibProvider const* DoGetProviderPtr() const = 0;
 
+    /// Returns the provider for the specified event time; by default, the one
+    /// updated for the current event (which is only correct with one schedule)
+    virtual std::shared_ptr<const ElectronicsCalibProvider> DoGetProviderFor(DBTimeStamp_t) const
+    {
+      return {std::shared_ptr<const void>(), &DoGetProvider()};
+    }
+
   }; // class ElectronicsCalibService
 } // namespace lariov
 
@@ -11,6 +11,12 @@
 // Framework libraries
 #include "art/Framework/Services/Registry/ServiceDeclarationMacros.h"
 
+// LArSoft libraries
+#include "larevt/CalibrationDBI/Interface/CalibrationDBIFwd.h"
+
+// C/C++ standard libraries
+#include <memory>
+
 //forward declarations
 namespace lariov {
   class PmtGainProvider;
@@ -35,12 +41,26 @@ namespace lariov {
 
     PmtGainProvider const* GetProviderPtr() const { return DoGetProviderPtr(); }
 
+    /// Provider of pmt gains valid at the specified event time (`evt.time().value()`),
+    /// safe with events of different times processed concurrently (unlike GetProvider())
+    std::shared_ptr<const PmtGainProvider> ProviderFor(DBTimeStamp_t ts) const
+    {
+      return DoGetProviderFor(ts);
+    }
+
   private:
     /// Returns a reference to the service provider
     virtual PmtGainProvider const& DoGetProvider() const = 0;
 
     virtual PmtGainProvider const* DoGetProviderPtr() const = 0;
 
+    /// Returns the provider for the specified event time; by default, the one
+    /// updated for the current event (which is only correct with one schedule)
+    virtual std::shared_ptr<const PmtGainProvider> DoGetProviderFor(DBTimeStamp_t) const
+    {
+      return {std::shared_ptr<const void>(), &DoGetProvider()};
+    }
+
   }; // class PmtGainService
 } // namespace lariov
 
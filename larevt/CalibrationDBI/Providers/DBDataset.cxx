@@ -13,15 +13,33 @@
 #include "cetlib_except/exception.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 #include "wda.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
 #include <cstring>
 
 // Default constructor.
 
-lariov::DBDataset::DBDataset() : fBeginTime(0, 0), fEndTime(0, 0) {}
+lariov::DBDataset::DBDataset()
+  : fBeginTime(0, 0), fEndTime(0, 0), fSchemaID(0), fFingerprint(0), fIndexBase(0)
+{}
+
+// Get column storage kind from database column type.
+
+lariov::DBDataset::ColumnKind lariov::DBDataset::GetColumnKind(const std::string& type)
+{
+  if (type == "integer" || type == "bigint") return kLONG;
+  if (type == "real") return kDOUBLE;
+  if (type == "text") return kSTRING;
+  if (type == "boolean") return kBOOL;
+  mf::LogError("DBDataset") << "Unknown datatype = " << type << "\n";
+  throw cet::exception("DBDataset") << "Unknown datatype = " << type << "\n";
+}
 
 // Libwda initializing constructor.
 
-lariov::DBDataset::DBDataset(void* dataset, bool release) : fBeginTime(0, 0), fEndTime(0, 0)
+lariov::DBDataset::DBDataset(void* dataset, bool release)
+  : fBeginTime(0, 0), fEndTime(0, 0), fSchemaID(0), fFingerprint(0), fIndexBase(0)
 {
   // Parse dataset and get number of rows.
 
@@ -82,9 +100,24 @@ lariov::DBDataset::DBDataset(void* dataset, bool release) : fBeginTime(0, 0), fE
   }
   releaseTuple(tup);
 
+  // Determine column storage kinds.
+  // The first column (channel number) must be integer.
+
+  fColumns.reserve(ncols);
+  for (size_t col = 0; col < ncols; ++col) {
+    ColumnKind kind = GetColumnKind(fColTypes[col]);
+    if (col == 0 && kind != kLONG) {
+      mf::LogError("DBDataset") << "First column has wrong type " << fColTypes[col] << "."
+                                << "\n";
+      throw cet::exception("DBDataset") << "First column has wrong type " << fColTypes[col] << ".";
+    }
+    fColumns.emplace_back(kind);
+    fColumns.back().reserve(nrows);
+  }
+
   // Extract data.  Loop over rows.
+  // Values are decoded directly from the libwda buffer by their column decoder.
 
-  fData.reserve(nrows * ncols);
   for (size_t row = 0; row < nrows; ++row) {
     //mf::LogInfo("DBDataset") << "\nRow " << row << "\n";
     tup = getTuple(dataset, row + kNUMBER_HEADER_ROWS);
@@ -93,70 +126,22 @@ lariov::DBDataset::DBDataset(void* dataset, bool release) : fBeginTime(0, 0), fE
 
     for (size_t col = 0; col < ncols; ++col) {
       getStringValue(tup, col, buf, kBUFFER_SIZE, &err);
-
-      // Convert string value to DBDataset::value_type (std::variant).
-
-      if (fColTypes[col] == "integer" || fColTypes[col] == "bigint") {
-        long value = strtol(buf, 0, 10);
-        fData.push_back(value_type(value));
-        //mf::LogInfo("DBDataset") << "DBDataset: row=" << row << ", column=" << col << ", value=" << fData.back()
-        //	<< "\n";
-        if (col == 0) {
-          fChannels.push_back(value);
-          //mf::LogInfo("DBDataset") << "DBDataset: channel=" << fChannels.back() << "\n";
-        }
-      }
-      else if (fColTypes[col] == "real") {
-        double value = strtod(buf, 0);
-        fData.push_back(value_type(value));
-        //mf::LogInfo("DBDataset") << "DBDataset: row=" << row << ", column=" << col << ", value=" << fData.back()
-        //	<< "\n";
-        if (col == 0) {
-          mf::LogError("DBDataset") << "First column has wrong type real."
-                                    << "\n";
-          throw cet::exception("DBDataset") << "First column has wrong type real.";
-        }
-      }
-      else if (fColTypes[col] == "text") {
-        fData.emplace_back(std::make_unique<std::string>(buf));
-        //mf::LogInfo("DBDataset") << "DBDataset: row=" << row << ", column=" << col << ", value=" << fData.back()
-        //	<< "\n";
-        if (col == 0) {
-          mf::LogError("DBDataset") << "First column has wrong type text."
-                                    << "\n";
-          throw cet::exception("DBDataset") << "First column has wrong type text.";
-        }
-      }
-      else if (fColTypes[col] == "boolean") {
-        long value = 0;
-        std::string s = std::string(buf);
-        if (s == "true" || s == "True" || s == "TRUE" || s == "1")
-          value = 1;
-        else if (s == "false" || s == "False" || s == "FALSE" || s == "0")
-          value = 0;
-        else {
-          mf::LogError("DBDataset") << "Unknown string representation of boolean " << s << "\n";
-          throw cet::exception("DBDataset")
-            << "Unknown string representation of boolean " << s << "\n";
-        }
-        fData.push_back(value_type(value));
-        //mf::LogInfo("DBDataset") << "DBDataset: row=" << row << ", column=" << col << ", value=" << fData.back()
-        //	<< "\n";
-        if (col == 0) {
-          mf::LogError("DBDataset") << "First column has wrong type boolean."
-                                    << "\n";
-          throw cet::exception("DBDataset") << "First column has wrong type boolean.";
-        }
-      }
-      else {
-        mf::LogError("DBDataset") << "Unknown datatype = " << fColTypes[col] << "\n";
-        throw cet::exception("DBDataset")
-          << "Unknown datatype = " << fColTypes[col] << ": " << buf << "\n";
-      }
+      fColumns[col].appendText(std::string_view(buf, strnlen(buf, kBUFFER_SIZE)));
     }
     releaseTuple(tup);
   }
 
+  // Channel numbers are the first column.
+
+  if (ncols > 0) {
+    auto channels = fColumns[0].longs();
+    fChannels.assign(channels.begin(), channels.end());
+  }
+
+  computeSchemaID();
+  computeFingerprint();
+  buildRowIndex();
+
   // Maybe release dataset memory.
 
   if (release) releaseDataset(dataset);
@@ -169,54 +154,158 @@ lariov::DBDataset::DBDataset(const IOVTimeStamp& begin_time,        // IOV begin
                              std::vector<std::string>&& col_names,  // Column names.
                              std::vector<std::string>&& col_types,  // Column types.
                              std::vector<DBChannelID_t>&& channels, // Channels.
-                             std::vector<value_type>&& data)
+                             std::vector<Column>&& columns)
   : // Calibration data.
   fBeginTime(begin_time)
   , fEndTime(end_time)
   , fColNames(std::move(col_names))
   , fColTypes(std::move(col_types))
   , fChannels(std::move(channels))
-  , fData(std::move(data))
-{}
+  , fColumns(std::move(columns))
+  , fSchemaID(0)
+  , fFingerprint(0)
+  , fIndexBase(0)
+{
+  computeSchemaID();
+  computeFingerprint();
+  buildRowIndex();
+}
 
-// Get row number by channel number.
-// Return -1 if not found.
+// Initializing move constructor for borrowed columns.
+
+lariov::DBDataset::DBDataset(const IOVTimeStamp& begin_time,
+                             const IOVTimeStamp& end_time,
+                             std::vector<std::string>&& col_names,
+                             std::vector<std::string>&& col_types,
+                             std::vector<DBChannelID_t>&& channels,
+                             std::vector<Column>&& columns,
+                             std::shared_ptr<const void> keepalive,
+                             std::uint64_t fingerprint)
+  : fBeginTime(begin_time)
+  , fEndTime(end_time)
+  , fColNames(std::move(col_names))
+  , fColTypes(std::move(col_types))
+  , fChannels(std::move(channels))
+  , fColumns(std::move(columns))
+  , fKeepAlive(std::move(keepalive))
+  , fSchemaID(0)
+  , fFingerprint(0)
+  , fIndexBase(0)
+{
+  computeSchemaID();
+  if (fingerprint != 0)
+    fFingerprint = fingerprint;
+  else
+    computeFingerprint();
+  buildRowIndex();
+}
 
-int lariov::DBDataset::getRowNumber(DBChannelID_t ch) const
+// Compute schema id (64-bit FNV-1a hash of column names and types).
+
+void lariov::DBDataset::computeSchemaID()
 {
-  int result = -1;
+  fSchemaID = 0;
+  if (fColNames.empty()) return;
+  std::uint64_t h = 14695981039346656037ULL;
+  auto add = [&h](const std::string& s) {
+    for (unsigned char c : s) {
+      h ^= c;
+      h *= 1099511628211ULL;
+    }
+    h ^= 0xff; // Separator.
+    h *= 1099511628211ULL;
+  };
+  for (size_t col = 0; col < fColNames.size(); ++col) {
+    add(fColNames[col]);
+    add(col < fColTypes.size() ? fColTypes[col] : std::string());
+  }
+  fSchemaID = (h != 0) ? h : 1;
+}
 
-  // Do a binary search on channel numbers.
+// Compute content fingerprint.
+// Data are hashed eight bytes at a time (FNV-1a style multiply-xor on 64-bit words).
 
-  int low = 0;
-  int high = fChannels.size() - 1;
-  while (high - low > 1) {
-    int mid = (low + high) / 2;
-    if (fChannels[mid] < ch)
-      low = mid;
-    else if (fChannels[mid] > ch)
-      high = mid;
-    else {
+namespace {
+  constexpr std::uint64_t kFNVPrime = 1099511628211ULL;
 
-      // Found an exact match.  Break out of loop.
+  std::uint64_t hashBytes(std::uint64_t h, const void* data, size_t n)
+  {
+    const char* p = static_cast<const char*>(data);
+    std::uint64_t word = 0;
+    for (; n >= sizeof(word); n -= sizeof(word), p += sizeof(word)) {
+      std::memcpy(&word, p, sizeof(word));
+      h = (h ^ word) * kFNVPrime;
+    }
+    for (; n > 0; --n, ++p)
+      h = (h ^ (unsigned char)*p) * kFNVPrime;
+    h = (h ^ 0xff) * kFNVPrime; // Separator.
+    return h;
+  }
 
-      result = mid;
+  template <class T>
+  std::uint64_t hashSpan(std::uint64_t h, std::span<const T> values)
+  {
+    return hashBytes(h, values.data(), values.size_bytes());
+  }
+}
+
+void lariov::DBDataset::computeFingerprint()
+{
+  fFingerprint = 0;
+  if (fSchemaID == 0) return;
+  std::uint64_t h = hashBytes(14695981039346656037ULL, &fSchemaID, sizeof(fSchemaID));
+  h = hashSpan(h, std::span<const DBChannelID_t>(fChannels));
+  for (const Column& column : fColumns) {
+    std::uint64_t size = column.size();
+    h = hashBytes(h, &size, sizeof(size));
+    switch (column.kind()) {
+    case kLONG: h = hashSpan(h, column.longs()); break;
+    case kDOUBLE: h = hashSpan(h, column.doubles()); break;
+    case kBOOL: h = hashSpan(h, column.bits()); break;
+    case kSTRING:
+      h = hashSpan(h, column.offsets());
+      h = hashSpan(h, column.chars());
       break;
     }
   }
+  fFingerprint = (h != 0) ? h : 1;
+}
 
-  // If we fell out of loop without finding a match...
+// Build direct channel-to-row index, if channel numbers are dense enough.
 
-  if (result < 0) {
-    if (fChannels[low] == ch)
-      result = low;
-    else if (fChannels[high] == ch)
-      result = high;
+void lariov::DBDataset::buildRowIndex()
+{
+  fRowIndex.clear();
+  fIndexBase = 0;
+  if (fChannels.empty()) return;
+  auto [minit, maxit] = std::minmax_element(fChannels.begin(), fChannels.end());
+  size_t range = size_t(*maxit) - size_t(*minit) + 1;
+  if (range > 2 * fChannels.size() + 64) return; // Sparse, use binary search.
+  fIndexBase = *minit;
+  fRowIndex.assign(range, -1);
+  for (size_t row = 0; row < fChannels.size(); ++row) {
+    std::int32_t& index = fRowIndex[fChannels[row] - fIndexBase];
+    if (index < 0) index = row;
   }
+}
 
-  // Done.
+// Get row number by channel number.
+// Return -1 if not found.
 
-  return result;
+int lariov::DBDataset::getRowNumber(DBChannelID_t ch) const
+{
+  // Direct index.
+
+  if (!fRowIndex.empty()) {
+    if (ch < fIndexBase || ch - fIndexBase >= fRowIndex.size()) return -1;
+    return fRowIndex[ch - fIndexBase];
+  }
+
+  // Do a binary search on channel numbers.
+
+  auto it = std::lower_bound(fChannels.begin(), fChannels.end(), ch);
+  if (it == fChannels.end() || *it != ch) return -1;
+  return it - fChannels.begin();
 }
 
 // Get column number by column name.
@@ -237,3 +326,281 @@ int lariov::DBDataset::getColNumber(const std::string& name) const
 
   return result;
 }
+
+// Access one long column as a contiguous span.
+
+std::span<const std::int64_t> lariov::DBDataset::getLongColumn(size_t col) const
+{
+  if (fColumns[col].kind() != kLONG)
+    throw cet::exception("DBDataset")
+      << "Column " << fColNames[col] << " has type " << fColTypes[col] << ", not integer.\n";
+  return fColumns[col].longs();
+}
+
+// Access one double column as a contiguous span.
+
+std::span<const double> lariov::DBDataset::getDoubleColumn(size_t col) const
+{
+  if (fColumns[col].kind() != kDOUBLE)
+    throw cet::exception("DBDataset")
+      << "Column " << fColNames[col] << " has type " << fColTypes[col] << ", not real.\n";
+  return fColumns[col].doubles();
+}
+
+// Column constructors from complete storage arrays.
+
+lariov::DBDataset::Column::Column(std::vector<std::int64_t>&& data)
+  : fKind(kLONG), fSize(data.size()), fBorrowed(false), fLongs(std::move(data))
+{
+  rebind();
+}
+
+lariov::DBDataset::Column::Column(std::vector<double>&& data)
+  : fKind(kDOUBLE), fSize(data.size()), fBorrowed(false), fDoubles(std::move(data))
+{
+  rebind();
+}
+
+lariov::DBDataset::Column::Column(std::vector<std::uint64_t>&& bits, size_t size)
+  : fKind(kBOOL), fSize(size), fBorrowed(false), fBits(std::move(bits))
+{
+  if (fBits.size() != (fSize + 63) / 64)
+    throw cet::exception("DBDataset") << "Boolean column size mismatch.\n";
+  rebind();
+}
+
+lariov::DBDataset::Column::Column(std::vector<char>&& chars, std::vector<std::uint64_t>&& offsets)
+  : fKind(kSTRING)
+  , fSize(offsets.empty() ? 0 : offsets.size() - 1)
+  , fBorrowed(false)
+  , fChars(std::move(chars))
+  , fOffsets(std::move(offsets))
+{
+  if (fOffsets.empty()) fOffsets.push_back(0);
+  rebind();
+  checkOffsets(fCharView, fOffsetView);
+}
+
+// Borrowed columns.
+
+lariov::DBDataset::Column lariov::DBDataset::Column::borrowLongs(std::span<const std::int64_t> data)
+{
+  Column column(kLONG);
+  column.fBorrowed = true;
+  column.fSize = data.size();
+  column.fLongView = data;
+  return column;
+}
+
+lariov::DBDataset::Column lariov::DBDataset::Column::borrowDoubles(std::span<const double> data)
+{
+  Column column(kDOUBLE);
+  column.fBorrowed = true;
+  column.fSize = data.size();
+  column.fDoubleView = data;
+  return column;
+}
+
+lariov::DBDataset::Column lariov::DBDataset::Column::borrowBools(
+  std::span<const std::uint64_t> bits,
+  size_t size)
+{
+  if (bits.size() != (size + 63) / 64)
+    throw cet::exception("DBDataset") << "Boolean column size mismatch.\n";
+  Column column(kBOOL);
+  column.fBorrowed = true;
+  column.fSize = size;
+  column.fBitView = bits;
+  return column;
+}
+
+lariov::DBDataset::Column lariov::DBDataset::Column::borrowStrings(
+  std::span<const char> chars,
+  std::span<const std::uint64_t> offsets)
+{
+  if (offsets.empty()) throw cet::exception("DBDataset") << "String column has no offsets.\n";
+  checkOffsets(chars, offsets);
+  Column column(kSTRING);
+  column.fOffsets.clear();
+  column.fBorrowed = true;
+  column.fSize = offsets.size() - 1;
+  column.fCharView = chars;
+  column.fOffsetView = offsets;
+  return column;
+}
+
+// Copy and move.
+
+lariov::DBDataset::Column::Column(const Column& other)
+  : fKind(other.fKind)
+  , fSize(other.fSize)
+  , fBorrowed(other.fBorrowed)
+  , fLongs(other.fLongs)
+  , fDoubles(other.fDoubles)
+  , fBits(other.fBits)
+  , fChars(other.fChars)
+  , fOffsets(other.fOffsets)
+  , fLongView(other.fLongView)
+  , fDoubleView(other.fDoubleView)
+  , fBitView(other.fBitView)
+  , fCharView(other.fCharView)
+  , fOffsetView(other.fOffsetView)
+{
+  if (!fBorrowed) rebind();
+}
+
+lariov::DBDataset::Column::Column(Column&& other) noexcept
+  : fKind(other.fKind)
+  , fSize(other.fSize)
+  , fBorrowed(other.fBorrowed)
+  , fLongs(std::move(other.fLongs))
+  , fDoubles(std::move(other.fDoubles))
+  , fBits(std::move(other.fBits))
+  , fChars(std::move(other.fChars))
+  , fOffsets(std::move(other.fOffsets))
+  , fLongView(other.fLongView)
+  , fDoubleView(other.fDoubleView)
+  , fBitView(other.fBitView)
+  , fCharView(other.fCharView)
+  , fOffsetView(other.fOffsetView)
+{
+  if (!fBorrowed) rebind();
+}
+
+lariov::DBDataset::Column& lariov::DBDataset::Column::operator=(const Column& other)
+{
+  if (this != &other) *this = Column(other);
+  return *this;
+}
+
+lariov::DBDataset::Column& lariov::DBDataset::Column::operator=(Column&& other) noexcept
+{
+  fKind = other.fKind;
+  fSize = other.fSize;
+  fBorrowed = other.fBorrowed;
+  fLongs = std::move(other.fLongs);
+  fDoubles = std::move(other.fDoubles);
+  fBits = std::move(other.fBits);
+  fChars = std::move(other.fChars);
+  fOffsets = std::move(other.fOffsets);
+  fLongView = other.fLongView;
+  fDoubleView = other.fDoubleView;
+  fBitView = other.fBitView;
+  fCharView = other.fCharView;
+  fOffsetView = other.fOffsetView;
+  if (!fBorrowed) rebind();
+  return *this;
+}
+
+// Point views at owned storage.
+
+void lariov::DBDataset::Column::rebind()
+{
+  fLongView = fLongs;
+  fDoubleView = fDoubles;
+  fBitView = fBits;
+  fCharView = fChars;
+  fOffsetView = fOffsets;
+}
+
+// Check that string offsets are consistent with the string arena.
+
+void lariov::DBDataset::Column::checkOffsets(std::span<const char> chars,
+                                             std::span<const std::uint64_t> offsets)
+{
+  if (offsets.front() != 0 || offsets.back() != chars.size())
+    throw cet::exception("DBDataset") << "String column offsets mismatch.\n";
+  for (size_t i = 1; i < offsets.size(); ++i) {
+    if (offsets[i] < offsets[i - 1])
+      throw cet::exception("DBDataset") << "String column offsets not monotonic.\n";
+  }
+}
+
+// Decode one value from its text representation.
+// Numbers that std::from_chars does not accept in full (e.g. leading '+' or
+// whitespace) fall back to the lenient C conversions.
+
+void lariov::DBDataset::Column::appendText(std::string_view text)
+{
+  const char* first = text.data();
+  const char* last = text.data() + text.size();
+  switch (fKind) {
+  case kLONG: {
+    long value = 0;
+    auto result = std::from_chars(first, last, value);
+    if (result.ec != std::errc() || result.ptr != last)
+      value = strtol(std::string(text).c_str(), 0, 10);
+    pushLong(value);
+    break;
+  }
+  case kDOUBLE: {
+    double value = 0.;
+    auto result = std::from_chars(first, last, value);
+    if (result.ec != std::errc() || result.ptr != last)
+      value = strtod(std::string(text).c_str(), 0);
+    pushDouble(value);
+    break;
+  }
+  case kSTRING: pushString(text); break;
+  case kBOOL: {
+    if (text == "true" || text == "True" || text == "TRUE" || text == "1")
+      pushBool(true);
+    else if (text == "false" || text == "False" || text == "FALSE" || text == "0")
+      pushBool(false);
+    else {
+      mf::LogError("DBDataset") << "Unknown string representation of boolean " << text << "\n";
+      throw cet::exception("DBDataset")
+        << "Unknown string representation of boolean " << text << "\n";
+    }
+    break;
+  }
+  }
+}
+
+// Reserve space for the specified number of rows.
+
+void lariov::DBDataset::Column::reserve(size_t n)
+{
+  switch (fKind) {
+  case kLONG: fLongs.reserve(n); break;
+  case kDOUBLE: fDoubles.reserve(n); break;
+  case kBOOL: fBits.reserve((n + 63) / 64); break;
+  case kSTRING: fOffsets.reserve(n + 1); break;
+  }
+  if (!fBorrowed) rebind();
+}
+
+// Convert stored values to a wider kind.
+
+void lariov::DBDataset::Column::promote(ColumnKind kind)
+{
+  if (kind == fKind) return;
+  if (fBorrowed || kind == kLONG || kind == kBOOL || fKind == kSTRING) {
+    static const char* const names[] = {"long", "double", "bool", "string"};
+    throw cet::exception("DBDataset")
+      << "Cannot promote " << names[fKind] << " column to " << names[kind] << ".\n";
+  }
+  Column result(kind);
+  result.reserve(fSize);
+  for (size_t row = 0; row < fSize; ++row) {
+    if (kind == kDOUBLE)
+      result.pushDouble(getDouble(row));
+    else if (fKind == kDOUBLE) {
+      char buf[32];
+      auto const res = std::to_chars(buf, buf + sizeof(buf), getDouble(row));
+      result.pushString(std::string_view(buf, res.ptr - buf));
+    }
+    else
+      result.pushString(std::to_string(getLong(row)));
+  }
+  *this = std::move(result);
+}
+
+// Report access of a column using the wrong type.
+
+void lariov::DBDataset::Column::badKind(const char* requested) const
+{
+  static const char* const names[] = {"long", "double", "bool", "string"};
+  throw cet::exception("DBDataset")
+    << "Cannot access " << names[fKind] << " column as " << requested << ".\n";
+}
@@ -12,14 +12,18 @@
 //
 //          Database data are essentially a rectangular array of values, indexed by
 //          (row, column).  Accessors are provided to access data as string, long,
-//          or double.
+//          double, or bool.
 //
 //          Rows are labeled by channel number.  Columns are labeled by name and type.
 //
-//          Binary values, which are stored as strings by wda, are stored as
-//          std::variant<long, double, unique_ptr<std::string> > > in this class.
+//          Data are stored by column.  Each column holds a single contiguous typed
+//          array, whose storage kind is derived from the database column type:
 //
-//          Columns are labeled by column name and type.
+//          integer, bigint - int64 array.
+//          real            - double array.
+//          boolean         - bitset (one bit per row).
+//          text            - string arena (all characters of the column in one
+//                            array), plus an array of nrows+1 offsets into the arena.
 //
 // Data members:
 //
@@ -28,19 +32,30 @@
 // fColNames  - Names of columns.
 // fColTypes  - Data types of columns.
 // fChannels  - Channel numbers (indexed by row number).
-// fData      - Calibration data.
+// fColumns   - Calibration data (one Column object per database column).
+// fKeepAlive - Owner of memory borrowed by columns (may be null).
+// fSchemaID  - Hash of column names and types.
+// fFingerprint - Hash of content (excluding IOV).
+// fIndexBase - Lowest channel number (dense channel ranges only).
+// fRowIndex  - Row number indexed by channel - fIndexBase (dense channel ranges only).
 //
 // Normally, the first element of each row is an integer channel number.
 // Furthermore, it can be assumed that rows are ordered by increasing channel number.
 //
-// Calibration data is contained in data member fData, which is a rectangular array
-// of strings of dimension # channels x # cols.  For efficiency, calibration data are
-// stored using a single std::vector, which array is allocated once at
-// construction or update time.  Elements are accessed columnwise as follows.
+// If channel numbers are dense (at least half of the channel range is occupied),
+// a direct channel-to-row index is built at construction time, so that row lookup
+// by channel number takes constant time.  Otherwise, rows are found by binary search.
 //
-// value = fData[ncols*row + column]
+// Individual values can be accessed as follows.
 //
-// Or use the provided accessors.
+// value = getColumn(column).getDouble(row)
+//
+// Or use the provided accessors.  Whole numeric columns can be accessed as
+// contiguous spans using getLongColumn and getDoubleColumn.
+//
+// Columns either own their storage, or borrow memory owned by another object
+// (such as a memory mapped shared memory segment or file), which the dataset
+// keeps alive.  All reads go through views, so both kinds behave the same.
 //
 // Nested class DBRow provides access to data from a single database row.
 //
@@ -50,18 +65,173 @@
 
 #include "larevt/CalibrationDBI/IOVData/IOVTimeStamp.h"
 #include "larevt/CalibrationDBI/Interface/CalibrationDBIFwd.h"
+#include <cstdint>
 #include <memory>
+#include <span>
 #include <string>
-#include <variant>
+#include <string_view>
 #include <vector>
 
 namespace lariov {
   class DBDataset {
 
   public:
-    // Typedef
+    // Storage kind of a column.
+
+    enum ColumnKind { kLONG, kDOUBLE, kBOOL, kSTRING };
+
+    // Get storage kind from database column type.
+    // Throws an exception for unknown types.
+
+    static ColumnKind GetColumnKind(const std::string& type);
+
+    // Nested class representing data from one column.
+
+    class Column {
+    public:
+      // Constructors.
+
+      explicit Column(ColumnKind kind = kLONG) : fKind(kind), fSize(0), fBorrowed(false)
+      {
+        if (fKind == kSTRING) fOffsets.push_back(0);
+        rebind();
+      }
+      explicit Column(std::vector<std::int64_t>&& data);      // Long column.
+      explicit Column(std::vector<double>&& data);            // Double column.
+      Column(std::vector<std::uint64_t>&& bits, size_t size); // Bool column.
+      Column(std::vector<char>&& chars,                       // String column.
+             std::vector<std::uint64_t>&& offsets);
+
+      // Columns that borrow memory owned elsewhere (e.g. a memory mapped image).
+      // The memory must stay valid for the lifetime of the column and its copies.
+      // Borrowed columns can't be filled.
+
+      static Column borrowLongs(std::span<const std::int64_t> data);
+      static Column borrowDoubles(std::span<const double> data);
+      static Column borrowBools(std::span<const std::uint64_t> bits, size_t size);
+      static Column borrowStrings(std::span<const char> chars,
+                                  std::span<const std::uint64_t> offsets);
+
+      // Copy and move (views are rebound to owned storage).
+
+      Column(const Column& other);
+      Column(Column&& other) noexcept;
+      Column& operator=(const Column& other);
+      Column& operator=(Column&& other) noexcept;
+
+      // Fill.
+
+      void reserve(size_t n);
+      void pushLong(long value)
+      {
+        fLongs.push_back(value);
+        fLongView = fLongs;
+        ++fSize;
+      }
+      void pushDouble(double value)
+      {
+        fDoubles.push_back(value);
+        fDoubleView = fDoubles;
+        ++fSize;
+      }
+      void pushBool(bool value)
+      {
+        if (fSize % 64 == 0) fBits.push_back(0);
+        if (value) fBits.back() |= std::uint64_t(1) << (fSize % 64);
+        fBitView = fBits;
+        ++fSize;
+      }
+      void pushString(std::string_view value)
+      {
+        fChars.insert(fChars.end(), value.begin(), value.end());
+        fOffsets.push_back(fChars.size());
+        fCharView = fChars;
+        fOffsetView = fOffsets;
+        ++fSize;
+      }
+
+      // Decode one value from its database text representation and append it.
+      // Conversion is selected by the column kind, which is resolved once per
+      // column, rather than by comparing type names for every value.
+
+      void appendText(std::string_view text);
+
+      // Convert the values already stored to a wider kind: long or bool to
+      // double, any kind to string.  Used when later values do not fit the
+      // kind guessed for the column.
+
+      void promote(ColumnKind kind);
 
-    typedef std::variant<long, double, std::unique_ptr<std::string>> value_type;
+      // Accessors.
+
+      ColumnKind kind() const { return fKind; }
+      size_t size() const { return fSize; }
+      bool borrowed() const { return fBorrowed; }
+
+      // Access one value.
+      // Numeric values are widened from bool to long to double.  It is an error
+      // to access double data as long or bool (which would truncate them), or
+      // string data as numeric, or vice versa.
+
+      long getLong(size_t row) const
+      {
+        if (fKind == kLONG) return fLongView[row];
+        if (fKind == kBOOL) return getBool(row);
+        badKind("long");
+      }
+      double getDouble(size_t row) const
+      {
+        if (fKind == kDOUBLE) return fDoubleView[row];
+        if (fKind == kLONG) return fLongView[row];
+        if (fKind == kBOOL) return getBool(row);
+        badKind("double");
+      }
+      bool getBool(size_t row) const
+      {
+        if (fKind == kBOOL) return (fBitView[row / 64] >> (row % 64)) & 1;
+        if (fKind == kLONG) return fLongView[row] != 0;
+        badKind("bool");
+      }
+      std::string_view getString(size_t row) const
+      {
+        if (fKind != kSTRING) badKind("string");
+        return std::string_view(fCharView.data() + fOffsetView[row],
+                                fOffsetView[row + 1] - fOffsetView[row]);
+      }
+
+      // Access raw storage.
+
+      std::span<const std::int64_t> longs() const { return fLongView; }
+      std::span<const double> doubles() const { return fDoubleView; }
+      std::span<const std::uint64_t> bits() const { return fBitView; }
+      std::span<const char> chars() const { return fCharView; }
+      std::span<const std::uint64_t> offsets() const { return fOffsetView; }
+
+    private:
+      [[noreturn]] void badKind(const char* requested) const;
+      void rebind(); // Point views at owned storage.
+      static void checkOffsets(std::span<const char> chars,
+                               std::span<const std::uint64_t> offsets);
+
+      // Data members.
+
+      ColumnKind fKind;
+      size_t fSize;                        // Number of rows.
+      bool fBorrowed;                      // Views refer to borrowed memory.
+      std::vector<std::int64_t> fLongs;    // Long data.
+      std::vector<double> fDoubles;        // Double data.
+      std::vector<std::uint64_t> fBits;    // Bool data.
+      std::vector<char> fChars;            // String arena.
+      std::vector<std::uint64_t> fOffsets; // String offsets (length size+1).
+
+      // Views of data (all reads go through these).
+
+      std::span<const std::int64_t> fLongView;
+      std::span<const double> fDoubleView;
+      std::span<const std::uint64_t> fBitView;
+      std::span<const char> fCharView;
+      std::span<const std::uint64_t> fOffsetView;
+    };
 
     // Nested class representing data from one row.
 
@@ -69,24 +239,27 @@ namespace lariov {
     public:
       // Constructors.
 
-      DBRow() : fData(nullptr) {}
-      DBRow(const value_type* s) : fData(s) {}
+      DBRow() : fDataset(nullptr), fRow(0) {}
+      DBRow(const DBDataset* dataset, size_t row) : fDataset(dataset), fRow(row) {}
 
       // Accessors.
 
-      bool isValid() const { return fData != nullptr; }
-      const value_type& getData(size_t col) const { return fData[col]; }
-      const std::string& getStringData(size_t col) const
+      bool isValid() const { return fDataset != nullptr; }
+      size_t row() const { return fRow; }
+      std::string getStringData(size_t col) const { return std::string(getStringView(col)); }
+      std::string_view getStringView(size_t col) const
       {
-        return *std::get<std::unique_ptr<std::string>>(fData[col]);
+        return fDataset->getColumn(col).getString(fRow);
       }
-      long getLongData(size_t col) const { return std::get<long>(fData[col]); }
-      double getDoubleData(size_t col) const { return std::get<double>(fData[col]); }
+      long getLongData(size_t col) const { return fDataset->getColumn(col).getLong(fRow); }
+      double getDoubleData(size_t col) const { return fDataset->getColumn(col).getDouble(fRow); }
+      bool getBoolData(size_t col) const { return fDataset->getColumn(col).getBool(fRow); }
 
     private:
-      // Data member.
+      // Data members.
 
-      const value_type* fData; // Borrowed referenced from enclosing class.
+      const DBDataset* fDataset; // Borrowed referenced from enclosing class.
+      size_t fRow;
     };
 
     // Back to main class.
@@ -108,7 +281,20 @@ namespace lariov {
               std::vector<std::string>&& col_names,  // Column names.
               std::vector<std::string>&& col_types,  // Column types.
               std::vector<DBChannelID_t>&& channels, // Channels.
-              std::vector<value_type>&& data);       // Calibration data (length nchan*ncol).
+              std::vector<Column>&& columns);        // Calibration data (length ncols).
+
+    // Initializing move constructor for datasets whose columns borrow memory.
+    // The keepalive object owns the borrowed memory.  If fingerprint is nonzero,
+    // it is taken as the precomputed content fingerprint.
+
+    DBDataset(const IOVTimeStamp& begin_time,
+              const IOVTimeStamp& end_time,
+              std::vector<std::string>&& col_names,
+              std::vector<std::string>&& col_types,
+              std::vector<DBChannelID_t>&& channels,
+              std::vector<Column>&& columns,
+              std::shared_ptr<const void> keepalive,
+              std::uint64_t fingerprint = 0);
 
     // Simple accessors.
 
@@ -119,16 +305,34 @@ namespace lariov {
     const std::vector<std::string>& colNames() const { return fColNames; }
     const std::vector<std::string>& colTypes() const { return fColTypes; }
     const std::vector<DBChannelID_t>& channels() const { return fChannels; }
-    const std::vector<value_type>& data() const { return fData; }
+    const std::vector<Column>& columns() const { return fColumns; }
+
+    // Schema id (hash of column names and types, 0 for empty datasets).
+    // Datasets with the same schema id have the same columns in the same order.
+
+    std::uint64_t schemaID() const { return fSchemaID; }
+
+    // Content fingerprint (hash of schema, channels, and all values, 0 for empty datasets).
+    // The IOV begin and end times are not included, so that identical payloads
+    // published for different IOVs have the same fingerprint.
+
+    std::uint64_t fingerprint() const { return fFingerprint; }
 
     // Determine row and column numbers.
+    // Row lookup is a direct index for dense channel ranges, or a binary search otherwise.
 
     int getRowNumber(DBChannelID_t ch) const;
     int getColNumber(const std::string& name) const;
 
     // Access one row.
 
-    DBRow getRow(size_t row) const { return DBRow(&fData[ncols() * row]); }
+    DBRow getRow(size_t row) const { return DBRow(this, row); }
+
+    // Access one column.
+
+    const Column& getColumn(size_t col) const { return fColumns[col]; }
+    std::span<const std::int64_t> getLongColumn(size_t col) const;
+    std::span<const double> getDoubleColumn(size_t col) const;
 
   private:
     // Data members.
@@ -138,7 +342,16 @@ namespace lariov {
     std::vector<std::string> fColNames;   // Column names.
     std::vector<std::string> fColTypes;   // Column types.
     std::vector<DBChannelID_t> fChannels; // Channels.
-    std::vector<value_type> fData;        // Calibration data (length nchan*ncols).
+    std::vector<Column> fColumns;         // Calibration data (length ncols).
+    std::shared_ptr<const void> fKeepAlive; // Owner of borrowed memory (may be null).
+    std::uint64_t fSchemaID;              // Hash of column names and types.
+    std::uint64_t fFingerprint;           // Hash of content.
+    DBChannelID_t fIndexBase;             // Channel number of fRowIndex[0].
+    std::vector<std::int32_t> fRowIndex;  // Row number by channel-fIndexBase (-1 = none).
+
+    void computeSchemaID();
+    void computeFingerprint();
+    void buildRowIndex();
   };
 }
 
@@ -0,0 +1,337 @@
+//=================================================================================
+//
+// Name: DBDatasetImage.cxx
+//
+// Purpose: Implementation of DBDataset images and files.
+//
+// Created: 18-Oct-2026
+//
+//=================================================================================
+
+#include "DBDatasetImage.h"
+#include "cetlib_except/exception.h"
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+  constexpr char kMagic[8] = {'L', 'A', 'R', 'I', 'O', 'V', 'I', 'M'};
+  constexpr std::uint32_t kVersion = 1;
+
+  // Images are viewed in place, which requires little-endian hosts.
+
+  void checkByteOrder()
+  {
+    if constexpr (std::endian::native != std::endian::little)
+      throw cet::exception("DBDatasetImage") << "Dataset images require a little-endian host.\n";
+  }
+
+  // Sequential writer of image blocks.
+  // With a null destination, only the size is accumulated.
+
+  class Writer {
+  public:
+    explicit Writer(char* dest = nullptr) : fDest(dest), fPos(0) {}
+
+    size_t pos() const { return fPos; }
+
+    void put(const void* p, size_t n)
+    {
+      if (fDest && n > 0) std::memcpy(fDest + fPos, p, n);
+      fPos += n;
+    }
+
+    template <class T>
+    void put(const T& value)
+    {
+      put(&value, sizeof(T));
+    }
+
+    void align()
+    {
+      size_t pad = (8 - fPos % 8) % 8;
+      if (fDest) std::memset(fDest + fPos, 0, pad);
+      fPos += pad;
+    }
+
+    template <class T>
+    void putArray(std::span<const T> values)
+    {
+      put<std::uint64_t>(values.size());
+      put(values.data(), values.size_bytes());
+      align();
+    }
+
+    void putString(const std::string& s) { putArray(std::span<const char>(s)); }
+
+  private:
+    char* fDest;
+    size_t fPos;
+  };
+
+  // Lay out image (or compute its size).
+
+  void layout(const lariov::DBDataset& data, Writer& writer)
+  {
+    writer.put(kMagic, sizeof(kMagic));
+    writer.put<std::uint32_t>(kVersion);
+    writer.put<std::uint32_t>(data.ncols());
+    writer.put<std::uint64_t>(data.nrows());
+    writer.put<std::uint64_t>(data.fingerprint());
+    writer.put<std::uint64_t>(data.beginTime().Stamp());
+    writer.put<std::uint64_t>(data.beginTime().SubStamp());
+    writer.put<std::uint64_t>(data.endTime().Stamp());
+    writer.put<std::uint64_t>(data.endTime().SubStamp());
+    for (size_t col = 0; col < data.ncols(); ++col) {
+      writer.putString(data.colNames()[col]);
+      writer.putString(data.colTypes()[col]);
+    }
+    writer.putArray(std::span<const lariov::DBChannelID_t>(data.channels()));
+    for (const auto& column : data.columns()) {
+      writer.put<std::uint64_t>(column.kind());
+      switch (column.kind()) {
+      case lariov::DBDataset::kLONG: writer.putArray(column.longs()); break;
+      case lariov::DBDataset::kDOUBLE: writer.putArray(column.doubles()); break;
+      case lariov::DBDataset::kBOOL: writer.putArray(column.bits()); break;
+      case lariov::DBDataset::kSTRING:
+        writer.putArray(column.offsets());
+        writer.putArray(column.chars());
+        break;
+      }
+    }
+  }
+
+  // Bounds-checked sequential reader of image blocks.
+
+  class Reader {
+  public:
+    Reader(const char* image, size_t size) : fBegin(image), fPtr(image), fEnd(image + size) {}
+
+    template <class T>
+    T get()
+    {
+      need(sizeof(T));
+      T value;
+      std::memcpy(&value, fPtr, sizeof(T));
+      fPtr += sizeof(T);
+      return value;
+    }
+
+    template <class T>
+    std::span<const T> getArray()
+    {
+      std::uint64_t n = get<std::uint64_t>();
+      if (n > size_t(fEnd - fPtr) / sizeof(T)) corrupt();
+      std::span<const T> result(reinterpret_cast<const T*>(fPtr), n);
+      fPtr += n * sizeof(T);
+      align();
+      return result;
+    }
+
+    std::string getString()
+    {
+      auto chars = getArray<char>();
+      return std::string(chars.begin(), chars.end());
+    }
+
+    bool atEnd() const { return fPtr == fEnd; }
+
+    [[noreturn]] void corrupt() const
+    {
+      throw cet::exception("DBDatasetImage") << "Corrupt dataset image.\n";
+    }
+
+  private:
+    void need(size_t n) const
+    {
+      if (size_t(fEnd - fPtr) < n) corrupt();
+    }
+
+    void align()
+    {
+      size_t pad = (8 - (fPtr - fBegin) % 8) % 8;
+      need(pad);
+      fPtr += pad;
+    }
+
+    const char* fBegin;
+    const char* fPtr;
+    const char* fEnd;
+  };
+}
+
+namespace lariov {
+
+  // Image size.
+
+  size_t DatasetImageSize(const DBDataset& data)
+  {
+    Writer writer;
+    layout(data, writer);
+    return writer.pos();
+  }
+
+  // Write image.
+
+  void WriteDatasetImage(const DBDataset& data, char* dest, size_t size)
+  {
+    checkByteOrder();
+    if (size != DatasetImageSize(data))
+      throw cet::exception("DBDatasetImage") << "Wrong dataset image size " << size << ".\n";
+    Writer writer(dest);
+    layout(data, writer);
+  }
+
+  // View dataset from image.
+
+  DBDataset ViewDatasetImage(const char* image,
+                             size_t size,
+                             std::shared_ptr<const void> keepalive)
+  {
+    checkByteOrder();
+    if (reinterpret_cast<std::uintptr_t>(image) % 8 != 0)
+      throw cet::exception("DBDatasetImage") << "Misaligned dataset image.\n";
+    Reader reader(image, size);
+    char magic[sizeof(kMagic)];
+    for (auto& c : magic)
+      c = reader.get<char>();
+    if (std::memcmp(magic, kMagic, sizeof(kMagic)) != 0)
+      throw cet::exception("DBDatasetImage") << "Not a dataset image.\n";
+    std::uint32_t version = reader.get<std::uint32_t>();
+    if (version != kVersion) {
+      throw cet::exception("DBDatasetImage")
+        << "Dataset image version " << version << ", expected " << kVersion << ".\n";
+    }
+    std::uint32_t ncols = reader.get<std::uint32_t>();
+    std::uint64_t nrows = reader.get<std::uint64_t>();
+    std::uint64_t fingerprint = reader.get<std::uint64_t>();
+    std::uint64_t stamp = reader.get<std::uint64_t>();
+    std::uint64_t substamp = reader.get<std::uint64_t>();
+    IOVTimeStamp begin_time(stamp, substamp);
+    stamp = reader.get<std::uint64_t>();
+    substamp = reader.get<std::uint64_t>();
+    IOVTimeStamp end_time(stamp, substamp);
+
+    if (ncols > size) reader.corrupt();
+    std::vector<std::string> col_names(ncols);
+    std::vector<std::string> col_types(ncols);
+    for (size_t col = 0; col < ncols; ++col) {
+      col_names[col] = reader.getString();
+      col_types[col] = reader.getString();
+    }
+    auto channel_array = reader.getArray<DBChannelID_t>();
+    if (channel_array.size() != nrows) reader.corrupt();
+    std::vector<DBChannelID_t> channels(channel_array.begin(), channel_array.end());
+
+    std::vector<DBDataset::Column> columns;
+    columns.reserve(ncols);
+    for (size_t col = 0; col < ncols; ++col) {
+      auto kind = reader.get<std::uint64_t>();
+      if (kind == DBDataset::kLONG)
+        columns.push_back(DBDataset::Column::borrowLongs(reader.getArray<std::int64_t>()));
+      else if (kind == DBDataset::kDOUBLE)
+        columns.push_back(DBDataset::Column::borrowDoubles(reader.getArray<double>()));
+      else if (kind == DBDataset::kBOOL)
+        columns.push_back(DBDataset::Column::borrowBools(reader.getArray<std::uint64_t>(), nrows));
+      else if (kind == DBDataset::kSTRING) {
+        auto offsets = reader.getArray<std::uint64_t>();
+        auto chars = reader.getArray<char>();
+        columns.push_back(DBDataset::Column::borrowStrings(chars, offsets));
+      }
+      else
+        reader.corrupt();
+      if (columns.back().size() != nrows) reader.corrupt();
+    }
+    if (!reader.atEnd()) reader.corrupt();
+
+    // The fingerprint is recomputed from the data, so that images damaged
+    // (or partly overwritten) in a way that keeps them well formed are rejected.
+
+    DBDataset result(begin_time,
+                     end_time,
+                     std::move(col_names),
+                     std::move(col_types),
+                     std::move(channels),
+                     std::move(columns),
+                     std::move(keepalive));
+    if (result.fingerprint() != fingerprint) {
+      throw cet::exception("DBDatasetImage")
+        << "Dataset image content does not match its fingerprint.\n";
+    }
+    return result;
+  }
+
+  // Write dataset file.
+
+  void WriteDatasetFile(const DBDataset& data, const std::string& path)
+  {
+    // Build image in 8-byte aligned memory.
+
+    size_t size = DatasetImageSize(data);
+    std::vector<std::uint64_t> buf((size + 7) / 8);
+    WriteDatasetImage(data, reinterpret_cast<char*>(buf.data()), size);
+
+    // Write to a temporary file, then atomically rename into place.
+
+    static std::atomic<unsigned int> counter{0};
+    std::filesystem::path target(path);
+    std::string temp = (target.parent_path() / (".tmp." + target.filename().string() + "." +
+                                                std::to_string(getpid()) + "." +
+                                                std::to_string(counter++)))
+                         .string();
+    int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+      throw cet::exception("DBDatasetImage")
+        << "Unable to create file " << temp << ": " << std::strerror(errno) << "\n";
+    }
+    const char* p = reinterpret_cast<const char*>(buf.data());
+    size_t remaining = size;
+    while (remaining > 0) {
+      ssize_t n = write(fd, p, remaining);
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) break;
+      p += n;
+      remaining -= n;
+    }
+    if (close(fd) != 0 || remaining > 0 || rename(temp.c_str(), path.c_str()) != 0) {
+      int err = errno;
+      unlink(temp.c_str());
+      throw cet::exception("DBDatasetImage")
+        << "Unable to write file " << path << ": " << std::strerror(err) << "\n";
+    }
+  }
+
+  // Read dataset file.
+
+  DBDataset ReadDatasetFile(const std::string& path)
+  {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw cet::exception("DBDatasetImage")
+        << "Unable to open file " << path << ": " << std::strerror(errno) << "\n";
+    }
+    struct stat st;
+    void* addr = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+      addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+      throw cet::exception("DBDatasetImage") << "Unable to map file " << path << "\n";
+
+    size_t size = st.st_size;
+    std::shared_ptr<const void> keepalive(
+      addr, [size](const void* p) { munmap(const_cast<void*>(p), size); });
+    return ViewDatasetImage(static_cast<const char*>(addr), size, std::move(keepalive));
+  }
+}
@@ -0,0 +1,83 @@
+#ifndef DBDATASETIMAGE_H
+#define DBDATASETIMAGE_H
+//=================================================================================
+//
+// Name: DBDatasetImage.h
+//
+// Purpose: Binary image and file format of a DBDataset.
+//
+//          An image holds a complete dataset (IOV, schema, channels, and column
+//          data) in one block of memory, with every array aligned to 8 bytes.
+//          A dataset can be viewed directly from an image, with columns that
+//          borrow the image memory, so that no parsing or copying of column
+//          data is needed.  Images are used to share datasets between processes
+//          via shared memory segments, and as the file format of binary
+//          conditions snapshots, which are read by memory mapping.
+//
+//          The format is versioned.  Readers reject images with a different
+//          version, and images whose content fingerprint (recomputed when the
+//          image is viewed) does not match the one recorded in the header.  Images are little-endian.  Since they are viewed in place,
+//          they can only be written and read on little-endian hosts (readers and
+//          writers throw otherwise).
+//
+//          Image layout (blocks padded to multiples of 8 bytes):
+//
+//          char[8]     magic "LARIOVIM"
+//          uint32      version
+//          uint32      number of columns
+//          uint64      number of rows
+//          uint64      content fingerprint
+//          uint64 x 2  IOV begin time (stamp, substamp)
+//          uint64 x 2  IOV end time (stamp, substamp)
+//          per column  name, type (uint64 length + characters)
+//          array       channels (uint32)
+//          per column  uint64 kind + array(s) (long: int64, double: double,
+//                      bool: uint64 bit words, string: uint64 offsets + chars)
+//
+//          Each array is stored as a uint64 element count followed by the elements.
+//
+// Created: 18-Oct-2026
+//
+//=================================================================================
+
+#include "larevt/CalibrationDBI/Providers/DBDataset.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace lariov {
+
+  // Size in bytes of the image of a dataset.
+
+  size_t DatasetImageSize(const DBDataset& data);
+
+  // Write the image of a dataset into memory of size DatasetImageSize(data).
+  // The destination must be aligned to 8 bytes.
+
+  void WriteDatasetImage(const DBDataset& data, char* dest, size_t size);
+
+  // View a dataset from an image.  Columns borrow the image memory, which must
+  // remain valid as long as the keepalive object exists.  Throws if the image
+  // is corrupt (including a content fingerprint mismatch), of another version,
+  // or misaligned.
+
+  DBDataset ViewDatasetImage(const char* image,
+                             size_t size,
+                             std::shared_ptr<const void> keepalive);
+
+  // Write the image of a dataset to a file.  The file is written to a temporary
+  // name (.tmp.<name>.<pid>.<n>) in the same directory and atomically renamed
+  // into place, so readers never see partially written files.  Throws if the
+  // file can't be written.
+
+  void WriteDatasetFile(const DBDataset& data, const std::string& path);
+
+  // Read a dataset from a file, by mapping the file into memory (read-only)
+  // and viewing the image in place.  The mapping is released when the dataset
+  // (and any copy thereof) is destroyed.  Files must not be modified in place
+  // while mapped.  Throws if the file can't be read or is corrupt.
+
+  DBDataset ReadDatasetFile(const std::string& path);
+}
+
+#endif
@@ -0,0 +1,288 @@
+//=================================================================================
+//
+// Name: DBDiskCache.cxx
+//
+// Purpose: Implementation for class DBDiskCache.
+//
+// Created: 18-Oct-2026
+//
+//=================================================================================
+
+#include "DBDiskCache.h"
+#include "DBDatasetImage.h"
+#include "cetlib_except/exception.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+  // File name constants.
+
+  const std::string kSuffix = ".dbds";
+  const std::string kTempPrefix = ".tmp.";
+
+  // Temporary files older than this are assumed to be left over by crashed writers.
+
+  constexpr auto kStaleTempAge = std::chrono::hours(1);
+
+  // The total size of the cache root is rescanned when it is older than this.
+
+  constexpr auto kRootScanInterval = std::chrono::minutes(1);
+
+  // 64-bit FNV-1a hash.  Used to generate stable directory names.
+
+  std::uint64_t fnv1a(const std::string& s, std::uint64_t h = 14695981039346656037ULL)
+  {
+    for (unsigned char c : s) {
+      h ^= c;
+      h *= 1099511628211ULL;
+    }
+    return h;
+  }
+
+  // File name for IOV.
+
+  std::string fileName(const lariov::IOVTimeStamp& begin_time,
+                       const lariov::IOVTimeStamp& end_time)
+  {
+    return begin_time.DBStamp() + "_" + end_time.DBStamp() + kSuffix;
+  }
+
+  // Decode IOV from file name.  Return false if this is not a cache file.
+
+  bool parseFileName(const std::string& name,
+                     lariov::IOVTimeStamp& begin_time,
+                     lariov::IOVTimeStamp& end_time)
+  {
+    if (name.size() <= kSuffix.size() ||
+        name.compare(name.size() - kSuffix.size(), kSuffix.size(), kSuffix) != 0)
+      return false;
+    size_t sep = name.find('_');
+    if (sep == std::string::npos) return false;
+    try {
+      begin_time = lariov::IOVTimeStamp::GetFromString(name.substr(0, sep));
+      end_time = lariov::IOVTimeStamp::GetFromString(
+        name.substr(sep + 1, name.size() - kSuffix.size() - sep - 1));
+    }
+    catch (...) {
+      return false;
+    }
+    return true;
+  }
+}
+
+namespace lariov {
+
+  // Constructor.
+
+  DBDiskCache::DBDiskCache(const std::string& root,
+                           const std::string& url,
+                           const std::string& folder,
+                           const std::string& tag,
+                           std::uint64_t max_bytes)
+    : fRoot(root), fMaxBytes(max_bytes)
+  {
+    // Directory name is the (sanitized) folder name, followed by a hash
+    // of the full cache key, so that the name stays readable and unique.
+
+    std::string name;
+    for (char c : folder)
+      name += (std::isalnum((unsigned char)c) || c == '_' || c == '-' || c == '.') ? c : '_';
+    std::ostringstream dir;
+    dir << fRoot << "/" << name << "-" << std::hex << std::setw(16) << std::setfill('0')
+        << fnv1a(url + '\n' + folder + '\n' + tag);
+    fDirectory = dir.str();
+
+    std::error_code ec;
+    std::filesystem::create_directories(fDirectory, ec);
+    if (ec) {
+      mf::LogWarning("DBDiskCache") << "Unable to create cache directory " << fDirectory << ": "
+                                    << ec.message() << "\n";
+    }
+  }
+
+  // Look up payload valid at the specified time.
+
+  bool DBDiskCache::Find(const IOVTimeStamp& ts, DBDataset& data) const
+  {
+    namespace fs = std::filesystem;
+
+    // Find the cached IOV containing the requested time.
+    // File names encode the IOV, so only the file of that IOV is opened.
+
+    std::lock_guard<std::mutex> lock(fMutex);
+    Refresh();
+    auto entry = fEntries.upper_bound(ts);
+    if (entry == fEntries.begin()) return false;
+    --entry;
+    if (!(ts < entry->second)) return false;
+    fs::path path = fs::path(fDirectory) / fileName(entry->first, entry->second);
+    std::error_code ec;
+
+    // Map file.  The file may have been evicted by another process in the meantime,
+    // in which case this is simply a cache miss.  Files are only ever replaced or
+    // removed, never modified in place, so a mapping stays valid after eviction.
+
+    if (!fs::exists(path, ec)) {
+      fEntries.erase(entry);
+      return false;
+    }
+    DBDataset result;
+    try {
+      result = ReadDatasetFile(path.string());
+    }
+    catch (cet::exception&) {
+    }
+    if (result.ncols() == 0 ||
+        fileName(result.beginTime(), result.endTime()) != path.filename().string()) {
+      mf::LogWarning("DBDiskCache") << "Removing corrupt cache file " << path.string() << "\n";
+      fs::remove(path, ec);
+      fEntries.erase(entry);
+      return false;
+    }
+
+    // Refresh modification time for LRU bookkeeping.
+
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+
+    data = std::move(result);
+    return true;
+  }
+
+  // Check whether a payload is cached.
+
+  bool DBDiskCache::Contains(const IOVTimeStamp& ts) const
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    Refresh();
+    auto entry = fEntries.upper_bound(ts);
+    if (entry == fEntries.begin()) return false;
+    --entry;
+    return ts < entry->second;
+  }
+
+  // Store payload.
+
+  void DBDiskCache::Store(const DBDataset& data) const
+  {
+    namespace fs = std::filesystem;
+
+    if (data.endTime() == IOVTimeStamp::MaxTimeStamp()) return;
+
+    std::uint64_t size = DatasetImageSize(data);
+    if (size > fMaxBytes) return;
+    {
+      std::lock_guard<std::mutex> lock(fMutex);
+      auto now = std::chrono::steady_clock::now();
+      if (!fRootScanned || now - fRootScanTime > kRootScanInterval) {
+        fRootBytes = ScanRoot(nullptr);
+        fRootScanTime = now;
+        fRootScanned = true;
+      }
+      if (fRootBytes + size > fMaxBytes) Evict(size);
+    }
+
+    std::error_code ec;
+    fs::create_directories(fDirectory, ec);
+    fs::path path = fs::path(fDirectory) / fileName(data.beginTime(), data.endTime());
+    try {
+      WriteDatasetFile(data, path.string());
+    }
+    catch (cet::exception& e) {
+      mf::LogWarning("DBDiskCache") << "Unable to write cache file: " << e.what();
+      return;
+    }
+    std::lock_guard<std::mutex> lock(fMutex);
+    fEntries.insert_or_assign(data.beginTime(), data.endTime());
+    fRootBytes += size;
+  }
+
+  // Rescan the cache directory.
+
+  void DBDiskCache::Refresh() const
+  {
+    namespace fs = std::filesystem;
+
+    std::error_code ec;
+    auto mtime = fs::last_write_time(fDirectory, ec);
+    if (ec || (fScanned && mtime == fScanTime)) return;
+
+    fEntries.clear();
+    for (fs::directory_iterator it(fDirectory, ec), end; !ec && it != end; it.increment(ec)) {
+      IOVTimeStamp begin_time(0, 0);
+      IOVTimeStamp end_time(0, 0);
+      if (parseFileName(it->path().filename().string(), begin_time, end_time))
+        fEntries.insert_or_assign(begin_time, end_time);
+    }
+    fScanTime = mtime;
+    fScanned = true;
+  }
+
+  // Total size of cache files under the cache root.
+
+  std::uint64_t DBDiskCache::ScanRoot(FileList* files) const
+  {
+    namespace fs = std::filesystem;
+
+    std::uint64_t total = 0;
+    auto now = fs::file_time_type::clock::now();
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(fRoot, ec), end; !ec && it != end;
+         it.increment(ec)) {
+      std::error_code fec;
+      if (!it->is_regular_file(fec)) continue;
+      std::string name = it->path().filename().string();
+      auto mtime = it->last_write_time(fec);
+      if (fec) continue;
+
+      // Remove stale temporary files.
+
+      if (name.compare(0, kTempPrefix.size(), kTempPrefix) == 0) {
+        if (now - mtime > kStaleTempAge) fs::remove(it->path(), fec);
+        continue;
+      }
+      if (name.size() <= kSuffix.size() ||
+          name.compare(name.size() - kSuffix.size(), kSuffix.size(), kSuffix) != 0)
+        continue;
+      std::uint64_t size = it->file_size(fec);
+      if (fec) continue;
+      if (files) files->emplace_back(mtime, size, it->path());
+      total += size;
+    }
+    return total;
+  }
+
+  // Delete least recently used files.
+
+  void DBDiskCache::Evict(std::uint64_t needed) const
+  {
+    namespace fs = std::filesystem;
+
+    // Collect all cache files under the cache root (the running total may be
+    // out of date if other processes use the same root).
+
+    FileList files;
+    std::uint64_t total = ScanRoot(&files);
+    fRootScanTime = std::chrono::steady_clock::now();
+    fRootScanned = true;
+
+    // Delete oldest files first.
+
+    if (total + needed > fMaxBytes) {
+      std::sort(files.begin(), files.end());
+      std::error_code ec;
+      for (const auto& [mtime, size, path] : files) {
+        if (total + needed <= fMaxBytes) break;
+        if (fs::remove(path, ec)) total -= size;
+      }
+    }
+    fRootBytes = total;
+  }
+}
@@ -0,0 +1,137 @@
+#ifndef DBDISKCACHE_H
+#define DBDISKCACHE_H
+//=================================================================================
+//
+// Name: DBDiskCache.h
+//
+// Purpose: Header for class DBDiskCache.
+//          This class implements a node-local persistent cache of DBDataset
+//          payloads retrieved from the http conditions database server.
+//          The cache is consulted by DBFolder before any http request is made,
+//          so that many jobs running on the same node share a single download
+//          of each IOV.
+//
+//          The cache lives under a configurable root directory.  Each combination
+//          of (url, folder, tag) has its own subdirectory, and each IOV is stored
+//          in one file whose name encodes the IOV begin and end times:
+//
+//          <root>/<folder>-<hash of url, folder and tag>/<begin>_<end>.dbds
+//
+//          Cache files are binary dataset images (see DBDatasetImage.h), which
+//          are memory mapped when read, without parsing or copying column data.
+//          Pre-built snapshot files (written by WriteDatasetFile) can be used by
+//          placing them in the cache directory under the same naming scheme.
+//
+//          Files are written to a temporary name in the same directory and
+//          atomically renamed into place, so that concurrent processes never see
+//          partially written payloads.  Files are only ever replaced, never
+//          modified in place.
+//
+//          The total size of the cache root is bounded.  Every cache hit refreshes
+//          the modification time of the file, and the least recently used files
+//          are deleted whenever a store would exceed the size limit.  The total
+//          size is kept in memory and updated by each store, so that the cache
+//          root is only scanned when files must be deleted, or when the total is
+//          older than a minute.  Stores made by other processes are therefore only
+//          accounted for after up to a minute, during which the cache root can
+//          exceed the limit.
+//
+//          Open-ended IOVs (end time = infinity) are never cached, because the
+//          validity range of such payloads changes when new IOVs are added.
+//          Cached payloads are otherwise assumed to be immutable, which is only
+//          guaranteed for tagged folders, so DBFolder does not use the cache for
+//          untagged (HEAD) folders.
+//
+//          The IOVs present in the cache directory are kept in memory, so that a
+//          lookup opens the file of the right IOV directly.  The directory is only
+//          scanned again when its modification time changes (e.g. when another
+//          process stores a payload).
+//
+// Created: 18-Oct-2026
+//
+//=================================================================================
+
+#include "larevt/CalibrationDBI/IOVData/IOVTimeStamp.h"
+#include "larevt/CalibrationDBI/Providers/DBDataset.h"
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace lariov {
+  class DBDiskCache {
+
+  public:
+    // Constructor.
+
+    DBDiskCache(const std::string& root,   // Cache root directory.
+                const std::string& url,    // Database url.
+                const std::string& folder, // Folder name.
+                const std::string& tag,    // Folder tag.
+                std::uint64_t max_bytes);  // Maximum total size of cache root.
+
+    // Accessors.
+
+    const std::string& Root() const { return fRoot; }
+    const std::string& Directory() const { return fDirectory; }
+    std::uint64_t MaxBytes() const { return fMaxBytes; }
+
+    // Look up the payload valid at the specified time.
+    // Return true and fill data if found.
+
+    bool Find(const IOVTimeStamp& ts, DBDataset& data) const;
+
+    // Check whether a payload valid at the specified time is cached, without
+    // reading it.
+
+    bool Contains(const IOVTimeStamp& ts) const;
+
+    // Store payload (does nothing for open-ended IOVs).
+
+    void Store(const DBDataset& data) const;
+
+  private:
+    // Total size of cache files under the cache root.  Stale temporary files
+    // are removed.  If files is not null, it is filled with the cache files
+    // (modification time, size, path).
+
+    using FileEntry =
+      std::tuple<std::filesystem::file_time_type, std::uint64_t, std::filesystem::path>;
+    using FileList = std::vector<FileEntry>;
+    std::uint64_t ScanRoot(FileList* files) const;
+
+    // Delete least recently used files until the cache root has enough room
+    // for a new file of the specified size (lock held).
+
+    void Evict(std::uint64_t needed) const;
+
+    // Rescan the cache directory if it changed since the last scan (lock held).
+
+    void Refresh() const;
+
+    // Data members.
+
+    std::string fRoot;      // Cache root directory.
+    std::string fDirectory; // Cache directory for this (url, folder, tag).
+    std::uint64_t fMaxBytes;
+
+    // IOVs in the cache directory (begin time -> end time).
+
+    mutable std::mutex fMutex;
+    mutable std::map<IOVTimeStamp, IOVTimeStamp> fEntries;
+    mutable std::filesystem::file_time_type fScanTime; // Directory time at last scan.
+    mutable bool fScanned = false;
+
+    // Total size of the cache root, and when it was last obtained by a scan.
+
+    mutable std::uint64_t fRootBytes = 0;
+    mutable std::chrono::steady_clock::time_point fRootScanTime;
+    mutable bool fRootScanned = false;
+  };
+}
+
+#endif
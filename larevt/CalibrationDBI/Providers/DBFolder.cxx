@@ -1,4 +1,7 @@
 #include "DBFolder.h"
+#include "DBDatasetImage.h"
+#include "DBDiskCache.h"
+#include "DBSharedCache.h"
 #include "WebDBIConstants.h"
 #include "WebError.h"
 #include "larevt/CalibrationDBI/IOVData/TimeStampDecoder.h"
@@ -8,12 +11,197 @@
 #include "messagefacility/MessageLogger/MessageLogger.h"
 #include "sqlite3.h"
 #include "wda.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
 #include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <random>
 #include <sstream>
 #include <stdlib.h>
+#include <thread>
+#include <utility>
+
+namespace {
+
+  // Timeout of prefetch requests (seconds).
+
+  constexpr int kPrefetchTimeout = 60;
+
+  // Number of recent response times used to determine the hedging delay,
+  // and minimum number needed before the percentile is used.
+
+  constexpr size_t kLatencyWindow = 64;
+  constexpr size_t kMinLatencySamples = 8;
+
+  // Limits of hedging delay and retry backoff (seconds).
+
+  constexpr double kMinHedgeDelay = 0.01;
+  constexpr double kMaxBackoff = 60.;
+
+  // Maximum number of threads running http requests in the background.
+
+  constexpr size_t kMaxRequestThreads = 16;
+
+  // Number of mismatching values listed per column by CompareDataset.
+
+  constexpr size_t kCompareExamples = 5;
+
+  // Outcome of a race between http requests for the same data.
+
+  struct HedgeState {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done = false;      // Result has been set.
+    int winner = -1;        // Request that delivered the result.
+    unsigned int failures = 0;
+    std::exception_ptr error; // First failure.
+    lariov::DBDataset result;
+  };
+
+  // Threads running http requests that the caller may stop waiting for.
+  // Requests only touch the state they share with the caller, and metrics,
+  // so the threads are detached and the pool is never destroyed: neither
+  // a folder nor the end of the job waits for a slow server.  Threads are
+  // started on demand, up to kMaxRequestThreads, and reused.
+
+  class RequestPool {
+  public:
+    static RequestPool& Instance()
+    {
+      static RequestPool* pool = new RequestPool; // Never destroyed.
+      return *pool;
+    }
+
+    // Run task (which must not throw) on a pool thread.
+
+    void Submit(std::function<void()> task)
+    {
+      std::lock_guard<std::mutex> lock(fMutex);
+      fQueue.push_back(std::move(task));
+      if (fIdle < fQueue.size() && fThreads < kMaxRequestThreads) {
+        ++fThreads;
+        std::thread(&RequestPool::Work, this).detach();
+      }
+      else
+        fCV.notify_one();
+    }
+
+  private:
+    void Work()
+    {
+      std::unique_lock<std::mutex> lock(fMutex);
+      for (;;) {
+        ++fIdle;
+        fCV.wait(lock, [this]() { return !fQueue.empty(); });
+        --fIdle;
+        std::function<void()> task = std::move(fQueue.front());
+        fQueue.pop_front();
+        lock.unlock();
+        task();
+        lock.lock();
+      }
+    }
+
+    std::mutex fMutex;
+    std::condition_variable fCV;
+    std::deque<std::function<void()>> fQueue;
+    size_t fIdle = 0;    // Threads waiting for a task.
+    size_t fThreads = 0; // Threads started.
+  };
+
+  // Reset a reusable sqlite statement when going out of scope.
+
+  struct SQLiteReset {
+    sqlite3_stmt* stmt;
+    ~SQLiteReset() { sqlite3_reset(stmt); }
+  };
+
+  // Column type implied by the declared type of an sqlite column, following
+  // the sqlite type affinity rules.  Null if the affinity implies no type
+  // (e.g. NUMERIC, or an expression column).
+
+  const char* SQLiteDeclaredType(const char* declared)
+  {
+    if (declared == nullptr) return nullptr;
+    std::string type(declared);
+    std::transform(type.begin(), type.end(), type.begin(), ::toupper);
+    if (type.find("INT") != std::string::npos) return "integer";
+    if (type.find("CHAR") != std::string::npos || type.find("CLOB") != std::string::npos ||
+        type.find("TEXT") != std::string::npos)
+      return "text";
+    if (type.find("REAL") != std::string::npos || type.find("FLOA") != std::string::npos ||
+        type.find("DOUB") != std::string::npos)
+      return "real";
+    return nullptr;
+  }
+
+  // Column type of one (non-null) sqlite value.
+
+  const char* SQLiteValueType(int dtype)
+  {
+    if (dtype == SQLITE_INTEGER) return "integer";
+    if (dtype == SQLITE_FLOAT) return "real";
+    if (dtype == SQLITE_TEXT) return "text";
+    mf::LogError("DBFolder") << "Unknown type " << dtype << "\n";
+    throw cet::exception("DBFolder") << "Unknown type " << dtype;
+  }
+}
 
 namespace lariov {
 
+  // Outcome of a prefetch request (see RunPrefetch).
+
+  struct DBFolder::PrefetchState {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::atomic<bool> cancelled{false}; // Result is no longer wanted.
+    bool done = false;                  // Request has finished.
+    DBDataset result;
+    std::string error; // Failure message (empty if none).
+  };
+
+  // Statistics of the http requests of a folder (see RequestPolicy).
+
+  struct DBFolder::RequestStats {
+    std::mutex mutex;              // Protects latencies.
+    std::vector<double> latencies; // Recent response times (ring buffer).
+    size_t next_latency = 0;       // Next ring buffer slot.
+    std::atomic<unsigned int> retries{0};
+    std::atomic<unsigned int> hedges_issued{0};
+    std::atomic<unsigned int> hedges_won{0};
+
+    // Time to wait for the primary server before hedging (seconds).
+
+    double HedgeDelay(double percentile, double initial_delay)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (latencies.size() < kMinLatencySamples) return initial_delay;
+      std::vector<double> sorted(latencies);
+      size_t n = std::min(sorted.size() - 1, size_t(percentile * sorted.size()));
+      std::nth_element(sorted.begin(), sorted.begin() + n, sorted.end());
+      return std::max(kMinHedgeDelay, sorted[n]);
+    }
+
+    // Record http response time.
+
+    void RecordLatency(double seconds)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (latencies.size() < kLatencyWindow)
+        latencies.push_back(seconds);
+      else
+        latencies[next_latency] = seconds;
+      next_latency = (next_latency + 1) % kLatencyWindow;
+    }
+  };
+
   // Constructor.
 
   DBFolder::DBFolder(const std::string& name,
@@ -36,6 +224,43 @@ namespace lariov {
 
     fMaximumTimeout = 4 * 60; //4 minutes
 
+    fMaxRecent = 0;
+
+    fMaxPrefetch = 0;
+
+    fSQLiteDB = nullptr;
+    fSQLiteIOVStmt = nullptr;
+    fSQLiteDataStmt = nullptr;
+    fPrefetchesIssued = 0;
+    fPrefetchesUsed = 0;
+    fPrefetchesUnused = 0;
+    fResolvedSchemaID = 0;
+    fHaveChangedRows = false;
+    fPreviousFingerprint = 0;
+    fGeneration = 0;
+    fUpdateErrorTime = 0;
+    fMaxRetries = 0;
+    fRetryBackoff = 1.;
+    fHedgePercentile = 0.;
+    fHedgeInitialDelay = 1.;
+    fRequestStats = std::make_shared<RequestStats>();
+    fCompareTolerance = 1.e-9;
+
+    DBMetrics& metrics = DBMetrics::Instance();
+    fMetrics.http_time = &metrics.GetHistogram(fFolderName, "http_time");
+    fMetrics.http_parse_time = &metrics.GetHistogram(fFolderName, "http_parse_time");
+    fMetrics.http_requests = &metrics.GetCounter(fFolderName, "http_requests");
+    fMetrics.http_errors = &metrics.GetCounter(fFolderName, "http_errors");
+    fMetrics.http_bytes = &metrics.GetCounter(fFolderName, "http_bytes");
+    fMetrics.sqlite_time = &metrics.GetHistogram(fFolderName, "sqlite_time");
+    fMetrics.sqlite_rows = &metrics.GetCounter(fFolderName, "sqlite_rows");
+    fMetrics.iov_crossings = &metrics.GetCounter(fFolderName, "iov_crossings");
+    fMetrics.recent_hits = &metrics.GetCounter(fFolderName, "recent_hits");
+    fMetrics.prefetch_hits = &metrics.GetCounter(fFolderName, "prefetch_hits");
+    fMetrics.shared_cache_hits = &metrics.GetCounter(fFolderName, "shared_cache_hits");
+    fMetrics.disk_cache_hits = &metrics.GetCounter(fFolderName, "disk_cache_hits");
+    fMetrics.misses = &metrics.GetCounter(fFolderName, "misses");
+
     // If UsqSQLite is true, hunt for sqlite database file.
     // It is an error if this file can't be found.
 
@@ -69,7 +294,80 @@ namespace lariov {
 
   // Destructor.
 
-  DBFolder::~DBFolder() {}
+  DBFolder::~DBFolder()
+  {
+    // Outstanding prefetches are not waited for.  Their threads are detached,
+    // and only touch their shared state.
+
+    for (auto& prefetch : fPrefetches)
+      prefetch.state->cancelled = true;
+    fPrefetchesUnused += fPrefetches.size();
+    fPrefetches.clear();
+    fCancelledPrefetches.clear();
+
+    CloseSQLite();
+
+    if (fPrefetchesIssued > 0) {
+      mf::LogInfo("DBFolder") << "DBFolder: folder " << fFolderName << " prefetched "
+                              << fPrefetchesIssued << " IOVs, " << fPrefetchesUsed << " used, "
+                              << fPrefetchesUnused << " unused.\n";
+    }
+    if (Retries() > 0 || HedgesIssued() > 0) {
+      mf::LogInfo("DBFolder") << "DBFolder: folder " << fFolderName << " retried " << Retries()
+                              << " http requests, sent " << HedgesIssued()
+                              << " hedged requests, " << HedgesWon() << " answered first.\n";
+    }
+  }
+
+  // Enable persistent http payload cache.
+
+  void DBFolder::SetDiskCache(const std::string& dir, std::uint64_t max_bytes)
+  {
+    if (dir.empty())
+      fDiskCache.reset();
+    else if (fTag.empty()) {
+      // Payloads of untagged folders can change, so they must not be cached.
+      fDiskCache.reset();
+      mf::LogWarning("DBFolder") << "DBFolder: payload cache " << dir
+                                 << " not used for untagged folder " << fFolderName << "\n";
+    }
+    else {
+      fDiskCache = std::make_unique<DBDiskCache>(dir, fURL, fFolderName, fTag, max_bytes);
+      mf::LogInfo("DBFolder") << "DBFolder: using payload cache " << fDiskCache->Directory()
+                              << " for folder " << fFolderName << "\n";
+    }
+  }
+
+  // Enable node-wide shared memory cache.
+
+  void DBFolder::SetSharedMemoryCache(bool enable, std::uint64_t max_bytes)
+  {
+    fSharedCache.reset();
+    if (!enable || fTestMode) return;
+    if (fTag.empty()) {
+      // Payloads of untagged folders can change, so they must not be cached.
+      mf::LogWarning("DBFolder") << "DBFolder: shared memory cache not used for untagged folder "
+                                 << fFolderName << "\n";
+      return;
+    }
+    if (!HasIOVIndex() && !LoadIOVIndex()) {
+      mf::LogWarning("DBFolder") << "DBFolder: no IOV index for folder " << fFolderName
+                                 << ", shared memory cache disabled.\n";
+      return;
+    }
+    fSharedCache = std::make_unique<DBSharedCache>(fURL, fFolderName, fTag, max_bytes);
+    mf::LogInfo("DBFolder") << "DBFolder: using shared memory cache " << fSharedCache->Prefix()
+                            << " for folder " << fFolderName << "\n";
+  }
+
+  // Set number of recently used datasets to keep.
+
+  void DBFolder::SetIOVCacheSize(size_t n)
+  {
+    fMaxRecent = n;
+    while (fRecent.size() > fMaxRecent)
+      fRecent.pop_back();
+  }
 
   // Data accessors.
 
@@ -162,6 +460,67 @@ namespace lariov {
     return err;
   }
 
+  // Bulk column accessors.
+
+  int DBFolder::GetNamedColumnData(const std::string& name, std::vector<bool>& data) const
+  {
+    const DBDataset::Column& column = fCache.getColumn(GetColumn(name));
+    data.resize(column.size());
+    for (size_t row = 0; row < data.size(); ++row)
+      data[row] = column.getBool(row);
+    return 0;
+  }
+
+  int DBFolder::GetNamedColumnData(const std::string& name, std::vector<long>& data) const
+  {
+    const DBDataset::Column& column = fCache.getColumn(GetColumn(name));
+    if (column.kind() == DBDataset::kLONG) {
+      auto values = column.longs();
+      data.assign(values.begin(), values.end());
+    }
+    else {
+      data.resize(column.size());
+      for (size_t row = 0; row < data.size(); ++row)
+        data[row] = column.getLong(row);
+    }
+    return 0;
+  }
+
+  int DBFolder::GetNamedColumnData(const std::string& name, std::vector<double>& data) const
+  {
+    const DBDataset::Column& column = fCache.getColumn(GetColumn(name));
+    if (column.kind() == DBDataset::kDOUBLE) {
+      auto values = column.doubles();
+      data.assign(values.begin(), values.end());
+    }
+    else {
+      data.resize(column.size());
+      for (size_t row = 0; row < data.size(); ++row)
+        data[row] = column.getDouble(row);
+    }
+    return 0;
+  }
+
+  int DBFolder::GetNamedColumnData(const std::string& name, std::vector<std::string>& data) const
+  {
+    const DBDataset::Column& column = fCache.getColumn(GetColumn(name));
+    data.clear();
+    data.reserve(column.size());
+    for (size_t row = 0; row < column.size(); ++row)
+      data.emplace_back(column.getString(row));
+    return 0;
+  }
+
+  std::span<const std::int64_t> DBFolder::GetLongColumn(const std::string& name) const
+  {
+    return fCache.getLongColumn(GetColumn(name));
+  }
+
+  std::span<const double> DBFolder::GetDoubleColumn(const std::string& name) const
+  {
+    return fCache.getDoubleColumn(GetColumn(name));
+  }
+
   // Not sure why the following accessor is included.  Doesn't seem to be used.
 
   /*
@@ -263,6 +622,138 @@ namespace lariov {
     return col;
   }
 
+  // Load IOV index.
+
+  bool DBFolder::LoadIOVIndex()
+  {
+    fIOVIndex.clear();
+    try {
+      if (fSQLitePath != "" && !fTestMode)
+        LoadSQLiteIOVIndex();
+      else
+        LoadHTTPIOVIndex();
+    }
+    catch (std::exception& e) {
+      mf::LogWarning("DBFolder") << "Failed to load IOV index for folder " << fFolderName << ": "
+                                 << e.what() << "\n";
+      fIOVIndex.clear();
+    }
+    std::sort(fIOVIndex.begin(), fIOVIndex.end());
+    fIOVIndex.erase(std::unique(fIOVIndex.begin(), fIOVIndex.end()), fIOVIndex.end());
+    mf::LogInfo("DBFolder") << "Loaded " << fIOVIndex.size() << " IOVs for folder " << fFolderName
+                            << ", tag " << fTag << "\n";
+    return !fIOVIndex.empty();
+  }
+
+  // Load IOV index from sqlite database.
+
+  void DBFolder::LoadSQLiteIOVIndex()
+  {
+    OpenSQLite();
+    std::string table_iovs = fFolderName + "_iovs";
+    std::string table_tag_iovs = fFolderName + "_tag_iovs";
+    std::ostringstream sql;
+    sql << "SELECT DISTINCT " << table_iovs << ".begin_time"
+        << " FROM " << table_tag_iovs << "," << table_iovs << " WHERE " << table_tag_iovs
+        << ".tag=?1"
+        << " AND " << table_tag_iovs << ".iov_id=" << table_iovs << ".iov_id"
+        << " ORDER BY " << table_iovs << ".begin_time";
+    sqlite3_stmt* stmt = PrepareSQLite(sql.str());
+    sqlite3_bind_text(stmt, 1, fTag.c_str(), -1, SQLITE_STATIC);
+    int rc = SQLITE_ROW;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+      fIOVIndex.emplace_back(sqlite3_column_int64(stmt, 0), 0);
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE) {
+      mf::LogError("DBFolder") << "sqlite3_step returned error result = " << rc << "\n";
+      throw cet::exception("DBFolder") << "sqlite3_step error.";
+    }
+  }
+
+  // Load IOV index from http server.
+  // The first field of each returned row is an IOV begin time.  Rows whose first
+  // field is not a time stamp (headers) are skipped.
+
+  void DBFolder::LoadHTTPIOVIndex()
+  {
+    std::stringstream fullurl;
+    fullurl << fURL << "/iovs?f=" << fFolderName;
+    if (fTag.length() > 0) fullurl << "&tag=" << fTag;
+
+    int err = 0;
+    Dataset data = getDataWithTimeout(fullurl.str().c_str(), NULL, fMaximumTimeout, &err);
+    int status = getHTTPstatus(data);
+    if (status != 200) {
+      std::string msg = "HTTP error from " + fullurl.str() + ": status: " +
+                        std::to_string(status) + ": " + std::string(getHTTPmessage(data));
+      releaseDataset(data);
+      throw WebError(msg);
+    }
+    int ntuples = getNtuples(data);
+    char buf[kBUFFER_SIZE];
+    for (int i = 0; i < ntuples; ++i) {
+      Tuple tup = getTuple(data, i);
+      buf[0] = 0;
+      if (getNfields(tup) > 0) getStringValue(tup, 0, buf, kBUFFER_SIZE, &err);
+      releaseTuple(tup);
+      size_t n = strnlen(buf, kBUFFER_SIZE);
+      if (n == 0 || strspn(buf, "0123456789.") != n) continue;
+      fIOVIndex.push_back(IOVTimeStamp::GetFromString(buf));
+    }
+    releaseDataset(data);
+  }
+
+  // Find IOV containing time.
+
+  bool DBFolder::FindIOV(const IOVTimeStamp& ts, IOVTimeStamp& begin, IOVTimeStamp& end) const
+  {
+    auto it = std::upper_bound(fIOVIndex.begin(), fIOVIndex.end(), ts);
+    if (it == fIOVIndex.begin()) return false;
+    end = (it == fIOVIndex.end()) ? IOVTimeStamp::MaxTimeStamp() : *it;
+    begin = *(it - 1);
+    return true;
+  }
+
+  // Begin times of IOVs that overlap a time range.
+
+  std::vector<IOVTimeStamp> DBFolder::IOVsInRange(const IOVTimeStamp& begin,
+                                                  const IOVTimeStamp& end) const
+  {
+    auto first = std::upper_bound(fIOVIndex.begin(), fIOVIndex.end(), begin);
+    if (first != fIOVIndex.begin()) --first;
+    auto last = std::lower_bound(first, fIOVIndex.end(), end);
+    return std::vector<IOVTimeStamp>(first, last);
+  }
+
+  // Time used to request the dataset valid at the specified time.
+
+  IOVTimeStamp DBFolder::RequestTime(const IOVTimeStamp& ts) const
+  {
+    IOVTimeStamp begin(0, 0);
+    IOVTimeStamp end(0, 0);
+    if (FindIOV(ts, begin, end)) return begin;
+    return ts;
+  }
+
+  // Look up column number for a column handle.
+  // Report if the schema changed since a handle was last resolved.
+
+  size_t DBFolder::ResolveColumnNumber(const std::string& name, std::uint64_t old_schema) const
+  {
+    if (fCache.schemaID() != fResolvedSchemaID) {
+      if (old_schema != 0 && fResolvedSchemaID != 0) {
+        mf::LogWarning log("DBFolder");
+        log << "Schema of folder " << fFolderName << " changed at IOV "
+            << fCache.beginTime().DBStamp() << ".  Columns:";
+        for (size_t col = 0; col < fCache.ncols(); ++col)
+          log << " " << fCache.colNames()[col] << "(" << fCache.colTypes()[col] << ")";
+        log << "\n";
+      }
+      fResolvedSchemaID = fCache.schemaID();
+    }
+    return GetColumn(name);
+  }
+
   //returns true if an Update is performed, false if not
   bool DBFolder::UpdateData(DBTimeStamp_t raw_time)
   {
@@ -273,24 +764,96 @@ namespace lariov {
     //check if cache is updated
     if (IsValid(ts)) return false;
 
-    //release cached data.
+    //report a failed update for the same time, made on behalf of the client
+    if (fUpdateError) {
+      std::exception_ptr error = std::exchange(fUpdateError, nullptr);
+      if (raw_time == fUpdateErrorTime) std::rethrow_exception(error);
+    }
+
+    //release cached data, but keep it until the changes are known.
+    DBDataset previous = std::move(fCache);
     fCache = DBDataset();
     fCachedRow = DBDataset::DBRow();
     fCachedRowNumber = -1;
     fCachedChannel = 0;
 
-    //get full url string
-    std::stringstream fullurl;
-    fullurl << fURL << "/data?f=" << fFolderName << "&t=" << ts.DBStamp();
-    if (fTag.length() > 0) fullurl << "&tag=" << fTag;
+    try {
+      LoadData(ts, raw_time);
+    }
+    catch (...) {
+      RememberDataset(std::move(previous));
+      throw;
+    }
+
+    // Find rows that changed since the previous dataset.
+
+    FindChangedRows(previous);
+    RememberDataset(std::move(previous));
+
+    // Start fetching the following IOV in the background.
+
+    SchedulePrefetch();
+    ++fGeneration;
+    fMetrics.iov_crossings->Add();
+    return true;
+  }
+
+  // Keep failure of an update made on behalf of the client.
+
+  void DBFolder::SetUpdateError(DBTimeStamp_t raw_time, std::exception_ptr error)
+  {
+    fUpdateErrorTime = raw_time;
+    fUpdateError = error;
+  }
+
+  // Check whether the cached dataset is valid at the specified time.
+
+  bool DBFolder::NeedsUpdate(DBTimeStamp_t raw_time) const
+  {
+    return !IsValid(TimeStampDecoder::DecodeTimeStamp(raw_time));
+  }
+
+  // Load dataset valid at the specified time into the cache.
+
+  void DBFolder::LoadData(const IOVTimeStamp& ts, DBTimeStamp_t raw_time)
+  {
+    //with an IOV index, always request data using the exact IOV begin time
+    IOVTimeStamp req = RequestTime(ts);
+    long sqlite_time = fIOVIndex.empty() ? raw_time / 1000000000 : req.Stamp();
+
+    //check if a recently used or prefetched dataset is valid
+    for (auto it = fRecent.begin(); it != fRecent.end(); ++it) {
+      if (ts >= it->beginTime() && ts < it->endTime()) {
+        fCache = std::move(*it);
+        fRecent.erase(it);
+        fMetrics.recent_hits->Add();
+        return;
+      }
+    }
+    if (UsePrefetch(ts)) {
+      fMetrics.prefetch_hits->Add();
+      return;
+    }
+
+    //check node-wide shared memory cache (looked up by IOV begin time)
+    IOVTimeStamp iov_begin(0, 0);
+    IOVTimeStamp iov_end(0, 0);
+    bool use_shared_cache = fSharedCache && FindIOV(ts, iov_begin, iov_end);
+    if (use_shared_cache && fSharedCache->Find(iov_begin, fCache)) {
+      fMetrics.shared_cache_hits->Add();
+      return;
+    }
 
     //mf::LogInfo log("DBFolder")
     //log << "In DBFolder::UpdateData" << "\n";
     //log << "t=" << raw_time/1000000000 << "\n";
-    //log << "Full url = " << fullurl.str() << "\n";
+    //log << "Full url = " << DataURL(fURL, ts) << "\n";
 
     //get new dataset
-    if (fSQLitePath != "" && !fTestMode) { GetSQLiteData(raw_time / 1000000000, fCache); }
+    if (fSQLitePath != "" && !fTestMode) {
+      fMetrics.misses->Add();
+      GetSQLiteData(sqlite_time, fCache);
+    }
     else {
       if (fTestMode) {
         mf::LogInfo log("DBFolder");
@@ -298,17 +861,9 @@ namespace lariov {
             << "\n";
         log << "Folder = " << fFolderName << "\n";
       }
-      int err = 0;
-      Dataset data = getDataWithTimeout(fullurl.str().c_str(), NULL, fMaximumTimeout, &err);
-      int status = getHTTPstatus(data);
-      if (status != 200) {
-        std::string msg = "HTTP error from " + fullurl.str() +
-                          ": status: " + std::to_string(status) + ": " +
-                          std::string(getHTTPmessage(data));
-        throw WebError(msg);
-      }
-      fCache = DBDataset(data, true);
+      fCache = FetchData(req, fMaximumTimeout);
     }
+    if (use_shared_cache) fSharedCache->Store(fCache);
     //DumpDataset(fCache);
 
     // If test mode is selected, get comparison data.
@@ -318,292 +873,652 @@ namespace lariov {
         DBDataset compare1;
         mf::LogInfo("DBFolder") << "Accessing comparison data from sqlite database " << fSQLitePath
                                 << "\n";
-        GetSQLiteData(raw_time / 1000000000, compare1);
+        GetSQLiteData(sqlite_time, compare1);
         CompareDataset(fCache, compare1);
       }
       if (fURL2 != "") {
         mf::LogInfo("DBFolder") << "Accessing comparison data from second database url."
                                 << "\n";
-        std::stringstream fullurl2;
-        fullurl2 << fURL2 << "/data?f=" << fFolderName << "&t=" << ts.DBStamp();
-        if (fTag.length() > 0) fullurl2 << "&tag=" << fTag;
-        mf::LogInfo("DBFolder") << "Full url = " << fullurl2.str() << "\n";
-        int err = 0;
-        Dataset data = getDataWithTimeout(fullurl2.str().c_str(), NULL, fMaximumTimeout, &err);
-        int status = getHTTPstatus(data);
-        if (status != 200) {
-          std::string msg = "HTTP error from " + fullurl2.str() +
-                            ": status: " + std::to_string(status) + ": " +
-                            std::string(getHTTPmessage(data));
-          throw WebError(msg);
-        }
-        DBDataset compare2(data, true);
+        std::string fullurl2 = DataURL(fURL2, req);
+        mf::LogInfo("DBFolder") << "Full url = " << fullurl2 << "\n";
+        DBDataset compare2 = GetHTTPData(fullurl2, fMaximumTimeout, &fMetrics);
         CompareDataset(fCache, compare2);
       }
     }
-    return true;
   }
 
-  // Query data from sqlite database.
-  // The return value of type Dataset (aka void*), is partially opaque type HttpResponse*
-  // (defined in wda.c and copied above).
+  // Find rows of the current dataset that differ from the previous dataset.
+  // A row-wise comparison is only possible if both datasets have the same
+  // schema and the same channels (in the same order).
 
-  void DBFolder::GetSQLiteData(int t, DBDataset& data) const
+  void DBFolder::FindChangedRows(const DBDataset& previous)
   {
-    if (fSQLitePath == "") return;
+    fChangedRows.clear();
+    fHaveChangedRows = false;
+    fPreviousFingerprint = previous.fingerprint();
+    if (previous.schemaID() == 0 || previous.schemaID() != fCache.schemaID() ||
+        previous.channels() != fCache.channels())
+      return;
+    fHaveChangedRows = true;
+    if (previous.fingerprint() == fCache.fingerprint()) return;
+
+    // Compare column by column.
+
+    size_t nrows = fCache.nrows();
+    std::vector<char> changed(nrows, 0);
+    for (size_t col = 0; col < fCache.ncols(); ++col) {
+      const DBDataset::Column& column1 = previous.getColumn(col);
+      const DBDataset::Column& column2 = fCache.getColumn(col);
+      if (column1.kind() != column2.kind()) {
+        std::fill(changed.begin(), changed.end(), 1);
+        break;
+      }
+      switch (column2.kind()) {
+      case DBDataset::kLONG: {
+        auto values1 = column1.longs();
+        auto values2 = column2.longs();
+        for (size_t row = 0; row < nrows; ++row)
+          changed[row] |= (values1[row] != values2[row]);
+        break;
+      }
+      case DBDataset::kDOUBLE: {
+        auto values1 = column1.doubles();
+        auto values2 = column2.doubles();
+        for (size_t row = 0; row < nrows; ++row)
+          changed[row] |= (std::memcmp(&values1[row], &values2[row], sizeof(double)) != 0);
+        break;
+      }
+      case DBDataset::kBOOL:
+        for (size_t row = 0; row < nrows; ++row)
+          changed[row] |= (column1.getBool(row) != column2.getBool(row));
+        break;
+      case DBDataset::kSTRING:
+        for (size_t row = 0; row < nrows; ++row)
+          changed[row] |= (column1.getString(row) != column2.getString(row));
+        break;
+      }
+    }
+    for (size_t row = 0; row < nrows; ++row) {
+      if (changed[row]) fChangedRows.push_back(row);
+    }
+  }
 
-    // DBDataset data to be filled.
 
-    IOVTimeStamp begin_ts(0, 0);               // IOV begin time.
-    IOVTimeStamp end_ts(0, 0);                 // IOV end time.
-    std::vector<std::string> column_names;     // Column names.
-    std::vector<std::string> column_types;     // Column types.
-    std::vector<DBChannelID_t> channels;       // Channels.
-    std::vector<DBDataset::value_type> values; // Calibration data (length nchan*ncols).
+  // Full url for the data valid at the specified time.
 
-    //mf::LogInfo log("DBFolder")
-    //log << "DBFolder::GetSQLiteData" << "\n";
-    //log << "t=" << t << "\n";
-    //log << "sqlite path = " << fSQLitePath << "\n";
+  std::string DBFolder::DataURL(const std::string& url, const IOVTimeStamp& ts) const
+  {
+    std::stringstream fullurl;
+    fullurl << url << "/data?f=" << fFolderName << "&t=" << ts.DBStamp();
+    if (fTag.length() > 0) fullurl << "&tag=" << fTag;
+    return fullurl.str();
+  }
 
-    // Open sqlite database.
+  // Fetch and parse data from http server.
+  // Metrics are not recorded if metrics is null.
 
-    //mf::LogInfo("DBFolder") << "Opening sqlite database " << fSQLitePath << "\n";
-    sqlite3* db;
-    int rc = sqlite3_open(fSQLitePath.c_str(), &db);
-    if (rc != SQLITE_OK) {
-      mf::LogError("DBFolder") << "Failed to open sqlite database " << fSQLitePath << "\n";
-      throw cet::exception("DBFolder") << "Failed to open sqlite database " << fSQLitePath;
+  DBDataset DBFolder::GetHTTPData(const std::string& fullurl,
+                                  int timeout,
+                                  const Metrics* metrics)
+  {
+    int err = 0;
+    if (metrics) metrics->http_requests->Add();
+    Dataset data = nullptr;
+    {
+      std::optional<DBMetrics::ScopedTimer> timer;
+      if (metrics) timer.emplace(*metrics->http_time);
+      data = getDataWithTimeout(fullurl.c_str(), NULL, timeout, &err);
     }
+    int status = getHTTPstatus(data);
+    if (status != 200) {
+      if (metrics) metrics->http_errors->Add();
+      std::string msg = "HTTP error from " + fullurl + ": status: " + std::to_string(status) +
+                        ": " + std::string(getHTTPmessage(data));
+      releaseDataset(data);
+      throw WebError(msg);
+    }
+    if (!metrics) return DBDataset(data, true);
+    DBMetrics::ScopedTimer timer(*metrics->http_parse_time);
+    DBDataset result(data, true);
+    metrics->http_bytes->Add(DatasetImageSize(result));
+    return result;
+  }
 
-    // Query begin time of IOV.
+  // Get data valid at the specified time from the primary server,
+  // consulting the persistent cache first.
+  // The cache is bypassed in test mode, which is meant to exercise the server.
 
-    std::string table_iovs = fFolderName + "_iovs";
-    std::string table_tag_iovs = fFolderName + "_tag_iovs";
-    std::ostringstream sql;
-    sql << "SELECT " << table_iovs << ".iov_id," << table_iovs << ".begin_time"
-        << " FROM " << table_tag_iovs << "," << table_iovs << " WHERE " << table_tag_iovs
-        << ".tag='" << fTag << "'"
-        << " AND " << table_tag_iovs << ".iov_id=" << table_iovs << ".iov_id"
-        << " AND " << table_iovs << ".begin_time <= " << t << " ORDER BY " << table_iovs
-        << ".begin_time desc";
-    //mf::LogInfo("DBFolder") << "sql = " << sql.str() << "\n";
+  DBDataset DBFolder::FetchData(const IOVTimeStamp& ts, int timeout) const
+  {
+    DBDataset result;
+    bool use_disk_cache = fDiskCache && !fTestMode;
+    if (use_disk_cache && fDiskCache->Find(ts, result)) {
+      fMetrics.disk_cache_hits->Add();
+      return result;
+    }
+    if (!fTestMode) fMetrics.misses->Add();
+    result = FetchHTTPData(ts, timeout);
+    if (use_disk_cache) fDiskCache->Store(result);
+    return result;
+  }
 
-    // Prepare query.
+  // Fetch dataset of an IOV.
 
-    sqlite3_stmt* stmt;
-    rc = sqlite3_prepare_v2(db, sql.str().c_str(), -1, &stmt, 0);
-    if (rc != SQLITE_OK) {
-      mf::LogError log("DBFolder");
-      log << "sqlite3_prepare_v2 failed." << fSQLitePath << "\n";
-      log << "Failed sql = " << sql.str() << "\n";
-      throw cet::exception("DBFolder") << "sqlite3_prepare_v2 error.";
+  DBDataset DBFolder::GetIOVData(const IOVTimeStamp& begin_time) const
+  {
+    return FetchData(begin_time, fMaximumTimeout);
+  }
+
+  // Get data from the http server(s), retrying failed requests.
+
+  DBDataset DBFolder::FetchHTTPData(const IOVTimeStamp& ts, int timeout) const
+  {
+    return SendRequest(MakeRequestPolicy(ts, timeout), *fRequestStats, &fMetrics);
+  }
+
+  // Retry and hedging policy of a request for the dataset valid at ts.
+
+  DBFolder::RequestPolicy DBFolder::MakeRequestPolicy(const IOVTimeStamp& ts, int timeout) const
+  {
+    bool hedge = fHedgePercentile > 0. && fURL2 != "" && !fTestMode;
+    RequestPolicy policy;
+    policy.url = DataURL(fURL, ts);
+    policy.url2 = hedge ? DataURL(fURL2, ts) : "";
+    policy.timeout = timeout;
+    policy.max_retries = fMaxRetries;
+    policy.backoff = fRetryBackoff;
+    policy.hedge_delay =
+      hedge ? fRequestStats->HedgeDelay(fHedgePercentile, fHedgeInitialDelay) : 0.;
+    return policy;
+  }
+
+  // Send a request following the policy, retrying failed requests.
+
+  DBDataset DBFolder::SendRequest(const RequestPolicy& policy,
+                                  RequestStats& stats,
+                                  const Metrics* metrics)
+  {
+    for (unsigned int attempt = 0;; ++attempt) {
+      try {
+        return HedgedRequest(policy, stats, metrics);
+      }
+      catch (WebError& e) {
+        if (attempt >= policy.max_retries) throw;
+
+        // Exponential backoff with jitter, so that many jobs that failed
+        // together don't retry together.
+
+        thread_local std::mt19937 engine{std::random_device{}()};
+        double delay = std::min(kMaxBackoff, policy.backoff * std::ldexp(1., attempt));
+        delay *= std::uniform_real_distribution<double>(0.5, 1.)(engine);
+        mf::LogWarning("DBFolder") << e.what() << "\nRetrying in " << delay << " s (retry "
+                                   << attempt + 1 << " of " << policy.max_retries << ").\n";
+        ++stats.retries;
+        std::this_thread::sleep_for(std::chrono::duration<double>(delay));
+      }
     }
+  }
 
-    // Execute query.
-    // Just retrieve first row.
-    // It is an error if we don't get at least one row.
+  // Send request to the primary url, and to the secondary url if the primary
+  // is slow or fails.  Return the first answer.  Throws if all requests failed.
 
-    rc = sqlite3_step(stmt);
-    //int iov_id = 0;
-    int begin_time = 0;
-    if (rc == SQLITE_ROW) {
-      //iov_id = sqlite3_column_int(stmt, 0);
-      begin_time = sqlite3_column_int(stmt, 1);
-      //mf::LogInfo log("DBFolder")
-      //log << "iov_id = " << iov_id << "\n";
-      //log << "begin_time = " << begin_time << "\n";
+  DBDataset DBFolder::HedgedRequest(const RequestPolicy& policy,
+                                    RequestStats& stats,
+                                    const Metrics* metrics)
+  {
+    auto start = std::chrono::steady_clock::now();
+    auto elapsed = [start]() {
+      return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    if (policy.url2.empty()) {
+      DBDataset result = GetHTTPData(policy.url, policy.timeout, metrics);
+      stats.RecordLatency(elapsed());
+      return result;
     }
-    else {
-      mf::LogError("DBFolder") << "sqlite3_step returned error result = " << rc << "\n";
-      throw cet::exception("DBFolder") << "sqlite3_step error.";
+
+    // Requests run on the request pool, and only touch the shared state and
+    // the metrics, so that the loser of the race is not waited for.
+
+    auto state = std::make_shared<HedgeState>();
+    std::optional<Metrics> shared_metrics;
+    if (metrics) shared_metrics = *metrics;
+    auto launch = [state, timeout = policy.timeout, shared_metrics](std::string url, int which) {
+      RequestPool::Instance().Submit([state, timeout, shared_metrics, url, which]() {
+        try {
+          DBDataset result =
+            GetHTTPData(url, timeout, shared_metrics ? &*shared_metrics : nullptr);
+          std::lock_guard<std::mutex> lock(state->mutex);
+          if (!state->done) {
+            state->done = true;
+            state->winner = which;
+            state->result = std::move(result);
+          }
+        }
+        catch (...) {
+          std::lock_guard<std::mutex> lock(state->mutex);
+          if (!state->error) state->error = std::current_exception();
+          ++state->failures;
+        }
+        state->cv.notify_all();
+      });
+    };
+
+    // Primary request.  Hedge if there is no answer within the hedging delay,
+    // or if the primary request fails.
+
+    launch(policy.url, 0);
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait_for(lock, std::chrono::duration<double>(policy.hedge_delay), [&state]() {
+      return state->done || state->failures > 0;
+    });
+    if (!state->done) {
+      lock.unlock();
+      launch(policy.url2, 1);
+      ++stats.hedges_issued;
+      lock.lock();
+      state->cv.wait(lock, [&state]() { return state->done || state->failures == 2; });
     }
+    bool done = state->done;
+    int winner = state->winner;
+    DBDataset result = std::move(state->result);
+    std::exception_ptr error = state->error;
+    lock.unlock();
+
+    if (!done) std::rethrow_exception(error);
+    if (winner == 1) ++stats.hedges_won;
+    stats.RecordLatency(elapsed());
+    return result;
+  }
 
-    // Delete query.
+  // Retry and hedging statistics.
 
-    sqlite3_finalize(stmt);
+  unsigned int DBFolder::Retries() const
+  {
+    return fRequestStats->retries;
+  }
 
-    // Query end time of IOV.
+  unsigned int DBFolder::HedgesIssued() const
+  {
+    return fRequestStats->hedges_issued;
+  }
 
-    sql.str("");
-    sql << "SELECT " << table_iovs << ".begin_time"
-        << " FROM " << table_tag_iovs << "," << table_iovs << " WHERE " << table_tag_iovs
-        << ".tag='" << fTag << "'"
-        << " AND " << table_tag_iovs << ".iov_id=" << table_iovs << ".iov_id"
-        << " AND " << table_iovs << ".begin_time > " << t << " ORDER BY " << table_iovs
-        << ".begin_time";
-    //mf::LogInfo("DBFolder") << "sql = " << sql.str() << "\n";
+  unsigned int DBFolder::HedgesWon() const
+  {
+    return fRequestStats->hedges_won;
+  }
 
-    // Prepare query.
+  // Configure retries.
 
-    rc = sqlite3_prepare_v2(db, sql.str().c_str(), -1, &stmt, 0);
-    if (rc != SQLITE_OK) {
-      mf::LogError log("DBFolder");
-      log << "sqlite3_prepare_v2 failed." << fSQLitePath << "\n";
-      log << "Failed sql = " << sql.str() << "\n";
-      throw cet::exception("DBFolder") << "sqlite3_prepare_v2 error.";
-    }
+  void DBFolder::SetRetries(unsigned int max_retries, double backoff)
+  {
+    fMaxRetries = max_retries;
+    fRetryBackoff = backoff;
+  }
 
-    // Execute query.
-    // Just retrieve first row.
-    // If we don't get any rows, then end time is infinite.
+  // Set relative tolerance for comparisons of real values in test mode.
 
-    rc = sqlite3_step(stmt);
-    int end_time = 0;
-    if (rc == SQLITE_ROW) {
-      end_time = sqlite3_column_int(stmt, 0);
-      //mf::LogInfo("DBFolder") << "end_time = " << end_time << "\n";
-    }
-    else if (rc != SQLITE_DONE) {
-      mf::LogError("DBFolder") << "sqlite3_step returned error result = " << rc << "\n";
-      throw cet::exception("DBFolder") << "sqlite3_step error.";
+  void DBFolder::SetCompareTolerance(double tolerance)
+  {
+    fCompareTolerance = tolerance;
+  }
+
+  // Configure hedged requests.
+
+  void DBFolder::SetHedging(double percentile, double initial_delay)
+  {
+    fHedgePercentile = std::clamp(percentile, 0., 1.);
+    fHedgeInitialDelay = initial_delay;
+    if (fHedgePercentile > 0. && fURL2 == "") {
+      mf::LogWarning("DBFolder") << "DBFolder: no secondary url for folder " << fFolderName
+                                 << ", hedged requests disabled.\n";
+      fHedgePercentile = 0.;
     }
+  }
 
-    // Delete query.
+  // Enable asynchronous prefetch.
 
-    sqlite3_finalize(stmt);
+  void DBFolder::SetPrefetch(size_t max_in_flight)
+  {
+    fMaxPrefetch = (fSQLitePath == "" && !fTestMode) ? max_in_flight : 0;
+  }
 
-    // Query count of channels.
-    // We do this so that we know how much memory to allocate.
+  // Start a background request for the IOV following the current one,
+  // and cancel prefetches that no longer follow the current IOV.
 
-    std::string table_data = fFolderName + "_data";
-    sql.str("");
-    sql << "SELECT COUNT(DISTINCT channel)"
-        << " FROM " << table_data << "," << table_iovs << "," << table_tag_iovs << " WHERE "
-        << table_tag_iovs << ".tag='" << fTag << "'"
-        << " AND " << table_iovs << ".iov_id=" << table_tag_iovs << ".iov_id"
-        << " AND " << table_data << ".__iov_id=" << table_tag_iovs << ".iov_id"
-        << " AND " << table_iovs << ".begin_time <= " << t;
-    //mf::LogInfo("DBFolder") << "sql = " << sql.str() << "\n";
+  void DBFolder::SchedulePrefetch()
+  {
+    const IOVTimeStamp& next = fCache.endTime();
+    for (auto it = fPrefetches.begin(); it != fPrefetches.end();) {
+      if (it->time != next) {
+        it->state->cancelled = true;
+        fCancelledPrefetches.push_back(std::move(it->state));
+        it = fPrefetches.erase(it);
+        ++fPrefetchesUnused;
+      }
+      else
+        ++it;
+    }
 
-    // Prepare query.
+    // Forget cancelled requests that have finished.
 
-    rc = sqlite3_prepare_v2(db, sql.str().c_str(), -1, &stmt, 0);
-    if (rc != SQLITE_OK) {
-      mf::LogError log("DBFolder");
-      log << "sqlite3_prepare_v2 failed." << fSQLitePath << "\n";
-      log << "Failed sql = " << sql.str() << "\n";
-      throw cet::exception("DBFolder") << "sqlite3_prepare_v2 error.";
+    fCancelledPrefetches.remove_if([](const std::shared_ptr<PrefetchState>& state) {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      return state->done;
+    });
+
+    // Check whether a new request is needed and allowed.
+    // Cancelled requests that are still running count against the in-flight limit.
+
+    if (fMaxPrefetch == 0 || !fPrefetches.empty()) return;
+    if (!(fCache.beginTime() < next) || next == IOVTimeStamp::MaxTimeStamp()) return;
+    for (const auto& data : fRecent) {
+      if (next >= data.beginTime() && next < data.endTime()) return;
     }
+    if (fCancelledPrefetches.size() >= fMaxPrefetch) return;
+    if (fDiskCache && fDiskCache->Contains(next)) return;
+
+    auto state = std::make_shared<PrefetchState>();
+    int timeout = std::min(fMaximumTimeout, kPrefetchTimeout);
+    std::thread(RunPrefetch, state, MakeRequestPolicy(next, timeout), fRequestStats, fMetrics)
+      .detach();
+    fPrefetches.push_back({next, std::move(state)});
+    ++fPrefetchesIssued;
+  }
 
-    // Execute query.
-    // Retrieve one row.
-    // It is an error if we don't get at least one row.
+  // Body of a prefetch thread: fetch and decode a dataset into the shared state,
+  // retrying and hedging like any other request.  Nothing but the shared state,
+  // the request statistics and the metrics is touched, so the folder may be
+  // destroyed in the meantime.
 
-    rc = sqlite3_step(stmt);
-    unsigned int nrows = 0;
-    if (rc == SQLITE_ROW) {
-      nrows = sqlite3_column_int(stmt, 0);
-      //mf::LogInfo("DBFolder") << "Number of data rows = " << nrows << "\n";
+  void DBFolder::RunPrefetch(std::shared_ptr<PrefetchState> state,
+                             const RequestPolicy& policy,
+                             std::shared_ptr<RequestStats> stats,
+                             const Metrics& metrics)
+  {
+    DBDataset result;
+    std::string error;
+    if (!state->cancelled) {
+      try {
+        result = SendRequest(policy, *stats, &metrics);
+      }
+      catch (std::exception& e) {
+        error = e.what();
+      }
+      catch (...) {
+        error = "unknown exception";
+      }
     }
-    else {
-      mf::LogError("DBFolder") << "sqlite3_step returned error result = " << rc << "\n";
-      throw cet::exception("DBFolder") << "sqlite3_step error.";
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->result = std::move(result);
+    state->error = std::move(error);
+    state->done = true;
+    state->cv.notify_all();
+  }
+
+  // Use a prefetched dataset, if one is valid at the specified time.
+  // Prefetched datasets that were requested for earlier times, but
+  // turn out not to be valid, are kept as recently used datasets.
+
+  bool DBFolder::UsePrefetch(const IOVTimeStamp& ts)
+  {
+    bool found = false;
+    for (auto it = fPrefetches.begin(); it != fPrefetches.end();) {
+
+      // The IOV of a dataset requested for a later time can't contain ts.
+
+      if (ts < it->time) {
+        ++it;
+        continue;
+      }
+
+      // Nor can the IOV of a dataset requested for an earlier time if, according
+      // to the IOV index, that IOV ends before ts.  Unless the request has already
+      // finished, it is then cancelled rather than waited for, and the dataset
+      // valid at ts is fetched directly.
+
+      PrefetchState& state = *it->state;
+      std::unique_lock<std::mutex> lock(state.mutex);
+      IOVTimeStamp begin(0, 0);
+      IOVTimeStamp end(0, 0);
+      if (!state.done && FindIOV(it->time, begin, end) && !(ts < end)) {
+        lock.unlock();
+        state.cancelled = true;
+        fCancelledPrefetches.push_back(std::move(it->state));
+        it = fPrefetches.erase(it);
+        ++fPrefetchesUnused;
+        continue;
+      }
+
+      // Otherwise wait for the request to finish, and take over its result.
+
+      state.cv.wait(lock, [&state]() { return state.done; });
+      DBDataset data = std::move(state.result);
+      std::string error = std::move(state.error);
+      lock.unlock();
+      it = fPrefetches.erase(it);
+
+      // Keep the dataset in the persistent cache.  The requests were recorded
+      // in the metrics by the prefetch thread.
+
+      if (!error.empty()) {
+        mf::LogWarning("DBFolder") << "Prefetch for folder " << fFolderName << " failed: " << error
+                                   << "\n";
+      }
+      else if (fDiskCache)
+        fDiskCache->Store(data);
+      if (!found && ts >= data.beginTime() && ts < data.endTime()) {
+        fCache = std::move(data);
+        ++fPrefetchesUsed;
+        found = true;
+      }
+      else {
+        RememberDataset(std::move(data));
+        ++fPrefetchesUnused;
+      }
     }
+    return found;
+  }
 
-    // Reserve collections that depend on number of rows (only).
+  // Add a dataset to the front of the recently used list.
 
-    channels.reserve(nrows);
+  void DBFolder::RememberDataset(DBDataset&& data)
+  {
+    if (fMaxRecent > 0 && data.beginTime() < data.endTime()) {
+      fRecent.push_front(std::move(data));
+      if (fRecent.size() > fMaxRecent) fRecent.pop_back();
+    }
+  }
 
-    // Delete query.
+  // Open sqlite database and prepare queries, if not already done.
+  // The connection and prepared statements are kept for the lifetime of this folder.
+  // The database is opened read-only and immutable, which means that sqlite
+  // does no locking or change detection, and the page cache can be shared
+  // between processes.  The database file must not be modified while in use.
 
-    sqlite3_finalize(stmt);
+  void DBFolder::OpenSQLite() const
+  {
+    if (fSQLiteDB != nullptr) return;
 
-    // Stash begin time.
+    // Make an sqlite uri, escaping characters that are special in uris.
 
-    begin_ts = IOVTimeStamp(begin_time, 0);
+    std::string uri = "file:";
+    for (char c : fSQLitePath) {
+      if (c == '%' || c == '?' || c == '#') {
+        char buf[4];
+        snprintf(buf, sizeof(buf), "%%%02X", (unsigned char)c);
+        uri += buf;
+      }
+      else
+        uri += c;
+    }
+    uri += "?immutable=1";
 
-    // Stash end time.
+    //mf::LogInfo("DBFolder") << "Opening sqlite database " << fSQLitePath << "\n";
+    int rc =
+      sqlite3_open_v2(uri.c_str(), &fSQLiteDB, SQLITE_OPEN_READONLY | SQLITE_OPEN_URI, nullptr);
+    if (rc != SQLITE_OK) {
+      sqlite3_close(fSQLiteDB);
+      fSQLiteDB = nullptr;
+      mf::LogError("DBFolder") << "Failed to open sqlite database " << fSQLitePath << "\n";
+      throw cet::exception("DBFolder") << "Failed to open sqlite database " << fSQLitePath;
+    }
 
-    if (end_time == 0)
-      end_ts = IOVTimeStamp::MaxTimeStamp();
-    else
-      end_ts = IOVTimeStamp(end_time, 0);
+    // IOV query.
+    // Returns IOV begin time, IOV end time (next begin time, or null), and number of channels,
+    // for parameters tag (1) and time (2).
 
-    // Main data query.
+    std::string table_iovs = fFolderName + "_iovs";
+    std::string table_tag_iovs = fFolderName + "_tag_iovs";
+    std::string table_data = fFolderName + "_data";
+    std::ostringstream sql;
+    sql << "SELECT (SELECT " << table_iovs << ".begin_time"
+        << " FROM " << table_tag_iovs << "," << table_iovs << " WHERE " << table_tag_iovs
+        << ".tag=?1"
+        << " AND " << table_tag_iovs << ".iov_id=" << table_iovs << ".iov_id"
+        << " AND " << table_iovs << ".begin_time <= ?2 ORDER BY " << table_iovs
+        << ".begin_time desc LIMIT 1),"
+        << " (SELECT " << table_iovs << ".begin_time"
+        << " FROM " << table_tag_iovs << "," << table_iovs << " WHERE " << table_tag_iovs
+        << ".tag=?1"
+        << " AND " << table_tag_iovs << ".iov_id=" << table_iovs << ".iov_id"
+        << " AND " << table_iovs << ".begin_time > ?2 ORDER BY " << table_iovs
+        << ".begin_time LIMIT 1),"
+        << " (SELECT COUNT(DISTINCT channel)"
+        << " FROM " << table_data << "," << table_iovs << "," << table_tag_iovs << " WHERE "
+        << table_tag_iovs << ".tag=?1"
+        << " AND " << table_iovs << ".iov_id=" << table_tag_iovs << ".iov_id"
+        << " AND " << table_data << ".__iov_id=" << table_tag_iovs << ".iov_id"
+        << " AND " << table_iovs << ".begin_time <= ?2)";
+    fSQLiteIOVStmt = PrepareSQLite(sql.str());
+
+    // Main data query, for parameters tag (1) and time (2).
 
     sql.str("");
     sql << "SELECT " << table_data << ".*,MAX(begin_time)"
         << " FROM " << table_data << "," << table_iovs << "," << table_tag_iovs << " WHERE "
-        << table_tag_iovs << ".tag='" << fTag << "'"
+        << table_tag_iovs << ".tag=?1"
         << " AND " << table_iovs << ".iov_id=" << table_tag_iovs << ".iov_id"
         << " AND " << table_data << ".__iov_id=" << table_tag_iovs << ".iov_id"
-        << " AND " << table_iovs << ".begin_time <= " << t << " GROUP BY channel"
+        << " AND " << table_iovs << ".begin_time <= ?2 GROUP BY channel"
         << " ORDER BY channel";
-    //mf::LogInfo("DBFolder") << "sql = " << sql.str() << "\n";
+    fSQLiteDataStmt = PrepareSQLite(sql.str());
 
-    // Prepare query.
+    // Find relevant columns.
+    // Ignore columns that begin with "_".
+    // Also ignore utility column MAX(begin_time).
 
-    rc = sqlite3_prepare_v2(db, sql.str().c_str(), -1, &stmt, 0);
+    int ncols = sqlite3_column_count(fSQLiteDataStmt);
+    for (int col = 0; col < ncols; ++col) {
+      std::string colname = sqlite3_column_name(fSQLiteDataStmt, col);
+      if (colname[0] != '_' && colname.substr(0, 3) != "MAX") fSQLiteColumns.push_back(col);
+    }
+  }
+
+  // Prepare an sqlite statement.
+
+  sqlite3_stmt* DBFolder::PrepareSQLite(const std::string& sql) const
+  {
+    //mf::LogInfo("DBFolder") << "sql = " << sql << "\n";
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v3(fSQLiteDB, sql.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &stmt, 0);
     if (rc != SQLITE_OK) {
       mf::LogError log("DBFolder");
-      log << "sqlite3_prepare_v2 failed." << fSQLitePath << "\n";
-      log << "Failed sql = " << sql.str() << "\n";
-      throw cet::exception("DBFolder") << "sqlite3_prepare_v2 error.";
+      log << "sqlite3_prepare_v3 failed." << fSQLitePath << "\n";
+      log << "Failed sql = " << sql << "\n";
+      throw cet::exception("DBFolder") << "sqlite3_prepare_v3 error.";
     }
+    return stmt;
+  }
 
-    // Execute the query and retrieve one row.
-    // We do this to extract the number, names, and types of relevant columns.
+  // Close sqlite database.
 
-    int ncols = sqlite3_column_count(stmt);
-    column_names.reserve(ncols);
-    column_types.reserve(ncols);
+  void DBFolder::CloseSQLite() const
+  {
+    sqlite3_finalize(fSQLiteIOVStmt);
+    sqlite3_finalize(fSQLiteDataStmt);
+    sqlite3_close(fSQLiteDB);
+    fSQLiteIOVStmt = nullptr;
+    fSQLiteDataStmt = nullptr;
+    fSQLiteDB = nullptr;
+    fSQLiteColumns.clear();
+  }
 
-    rc = sqlite3_step(stmt);
-    if (rc == SQLITE_ROW) {
+  // Query data from sqlite database.
 
-      // Loop over columns.
+  void DBFolder::GetSQLiteData(long t, DBDataset& data) const
+  {
+    if (fSQLitePath == "") return;
+    DBMetrics::ScopedTimer timer(*fMetrics.sqlite_time);
 
-      for (int col = 0; col < ncols; ++col) {
-        std::string colname = sqlite3_column_name(stmt, col);
-
-        // Ignore columns that begin with "_".
-        // Also ignore utility column MAX(begin_time).
-
-        if (colname[0] != '_' && colname.substr(0, 3) != "MAX") {
-          column_names.push_back(colname);
-          int dtype = sqlite3_column_type(stmt, col);
-          if (dtype == SQLITE_INTEGER)
-            column_types.push_back("integer");
-          else if (dtype == SQLITE_FLOAT)
-            column_types.push_back("real");
-          else if (dtype == SQLITE_TEXT)
-            column_types.push_back("text");
-          else if (dtype == SQLITE_NULL)
-            column_types.push_back("NULL");
-          else {
-            mf::LogError("DBFolder") << "Unknown type " << dtype << "\n";
-            throw cet::exception("DBFolder") << "Unknown type " << dtype;
-          }
-          //mf::LogInfo("DBFolder") << "Column " << col
-          //	    << ", name=" << column_names.back()
-          //	    << ", type=" << column_types.back() << "\n";
-        }
-      }
-    }
-    else {
-      mf::LogError("DBFolder") << "No data rows."
-                               << "\n";
-      throw cet::exception("DBFolder") << "No data rows.";
+    // DBDataset data to be filled.
+
+    IOVTimeStamp begin_ts(0, 0);               // IOV begin time.
+    IOVTimeStamp end_ts(0, 0);                 // IOV end time.
+    std::vector<std::string> column_names;     // Column names.
+    std::vector<std::string> column_types;     // Column types.
+    std::vector<DBChannelID_t> channels;       // Channels.
+    std::vector<DBDataset::Column> columns;    // Calibration data (length ncols).
+
+    //mf::LogInfo log("DBFolder")
+    //log << "DBFolder::GetSQLiteData" << "\n";
+    //log << "t=" << t << "\n";
+    //log << "sqlite path = " << fSQLitePath << "\n";
+
+    OpenSQLite();
+
+    // Query begin time, end time, and number of channels of IOV.
+    // It is an error if there is no begin time.
+    // If there is no end time, then end time is infinite.
+
+    SQLiteReset iov_reset{fSQLiteIOVStmt};
+    sqlite3_bind_text(fSQLiteIOVStmt, 1, fTag.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int64(fSQLiteIOVStmt, 2, t);
+    int rc = sqlite3_step(fSQLiteIOVStmt);
+    if (rc != SQLITE_ROW || sqlite3_column_type(fSQLiteIOVStmt, 0) == SQLITE_NULL) {
+      mf::LogError("DBFolder") << "sqlite3_step returned error result = " << rc << "\n";
+      throw cet::exception("DBFolder") << "sqlite3_step error.";
     }
+    long begin_time = sqlite3_column_int64(fSQLiteIOVStmt, 0);
+    long end_time = sqlite3_column_int64(fSQLiteIOVStmt, 1); // Null converts to 0.
+    unsigned int nrows = sqlite3_column_int64(fSQLiteIOVStmt, 2);
+    //mf::LogInfo log("DBFolder")
+    //log << "begin_time = " << begin_time << "\n";
+    //log << "end_time = " << end_time << "\n";
+    //log << "Number of data rows = " << nrows << "\n";
+
+    // Reserve collections that depend on number of rows (only).
+
+    channels.reserve(nrows);
+
+    // Stash begin time.
 
-    // Remember the number of relevant columns.
+    begin_ts = IOVTimeStamp(begin_time, 0);
+
+    // Stash end time.
 
-    size_t nrelcols = column_names.size();
-    values.reserve(nrows * nrelcols);
+    if (end_time == 0)
+      end_ts = IOVTimeStamp::MaxTimeStamp();
+    else
+      end_ts = IOVTimeStamp(end_time, 0);
 
-    // Re-execute query.
+    // Main data query.
     // Retrieve all data rows and stash in result.
+    // The first row is also used to extract the names of relevant columns.
+
+    SQLiteReset data_reset{fSQLiteDataStmt};
+    sqlite3_bind_text(fSQLiteDataStmt, 1, fTag.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int64(fSQLiteDataStmt, 2, t);
+    size_t nrelcols = fSQLiteColumns.size();
+    column_names.reserve(nrelcols);
+    column_types.reserve(nrelcols);
+    columns.reserve(nrelcols);
+    std::vector<bool> typed; // Column type known (declared, or from a value).
+    typed.reserve(nrelcols);
 
-    rc = sqlite3_reset(stmt);
-    if (rc != SQLITE_OK) {
-      mf::LogError("DBFolder") << "sqlite3_reset failed."
-                               << "\n";
-      throw cet::exception("DBFolder") << "sqlite3_failed.";
-    }
     size_t irow = 0;
+    rc = SQLITE_OK;
     while (rc != SQLITE_DONE) {
-      rc = sqlite3_step(stmt);
+      rc = sqlite3_step(fSQLiteDataStmt);
       if (rc == SQLITE_ROW) {
         ++irow;
         //mf::LogInfo("DBFolder") << irow << " rows." << "\n";
@@ -612,61 +1527,84 @@ namespace lariov {
           throw cet::exception("DBFolder") << "Too many data rows " << irow;
         }
 
-        // Loop over columns.
-        // Remember that ncols is the number of columns returned by the query,
-        // not the number of columns that get stored (some columns are ignored).
-
-        bool firstcol = true;
-        for (int col = 0; col < ncols; ++col) {
-          std::string colname = sqlite3_column_name(stmt, col);
-
-          // Ignore columns that begin with "_".
-          // Also ignore utility column MAX(begin_time).
+        // On the first row, extract column names and set up typed columns.
+        // The type of a column is its declared type, or else the type of its
+        // first non-null value.  A column is promoted (long to double to
+        // string) if a later value does not fit, so no value is truncated.
+
+        if (irow == 1) {
+          for (size_t i = 0; i < nrelcols; ++i) {
+            int col = fSQLiteColumns[i];
+            column_names.push_back(sqlite3_column_name(fSQLiteDataStmt, col));
+            const char* type = "integer"; // Channel column.
+            if (i != 0) type = SQLiteDeclaredType(sqlite3_column_decltype(fSQLiteDataStmt, col));
+            typed.push_back(type != nullptr);
+            column_types.push_back(type ? type : "integer");
+            columns.emplace_back(DBDataset::GetColumnKind(column_types.back()));
+            columns.back().reserve(nrows);
+          }
+        }
 
-          if (colname[0] != '_' && colname.substr(0, 3) != "MAX") {
-            int dtype = sqlite3_column_type(stmt, col);
+        // Loop over relevant columns.
 
-            if (dtype == SQLITE_INTEGER) {
-              long value = sqlite3_column_int(stmt, col);
-              //mf::LogInfo("DBFolder") << "Value = " << value << "\n";
-              values.push_back(DBDataset::value_type(value));
-              if (firstcol) channels.push_back(value);
-            }
-            else if (dtype == SQLITE_FLOAT) {
-              double value = sqlite3_column_double(stmt, col);
-              //mf::LogInfo("DBFolder") << "Value = " << value << "\n";
-              values.push_back(DBDataset::value_type(value));
-              if (firstcol) {
-                mf::LogError("DBFolder") << "First column has wrong type float."
-                                         << "\n";
-                throw cet::exception("DBFolder") << "First column has wrong type float.";
-              }
-            }
-            else if (dtype == SQLITE_TEXT) {
-              const char* s = (const char*)sqlite3_column_text(stmt, col);
-              //mf::LogInfo("DBFolder") << "Value = " << s << "\n";
-              values.emplace_back(std::make_unique<std::string>(s));
-              if (firstcol) {
-                mf::LogError("DBFolder") << "First column has wrong type text."
-                                         << "\n";
-                throw cet::exception("DBFolder") << "First column has wrong type text.";
-              }
-            }
-            else if (dtype == SQLITE_NULL) {
-              values.push_back(DBDataset::value_type());
-              //mf::LogInfo("DBFolder") << "Value = NULL" << "\n";
-              if (firstcol) {
-                mf::LogError("DBFolder") << "First column has wrong type null."
-                                         << "\n";
-                throw cet::exception("DBFolder") << "First column has wrong type null.";
+        for (size_t i = 0; i < nrelcols; ++i) {
+          int col = fSQLiteColumns[i];
+          int dtype = sqlite3_column_type(fSQLiteDataStmt, col);
+          DBDataset::Column& column = columns[i];
+          if (i == 0 && dtype != SQLITE_INTEGER) {
+            mf::LogError("DBFolder") << "First column has wrong type " << dtype << ".\n";
+            throw cet::exception("DBFolder") << "First column has wrong type " << dtype << ".";
+          }
+          if (dtype != SQLITE_NULL) {
+            const char* type = SQLiteValueType(dtype);
+            DBDataset::ColumnKind kind = DBDataset::GetColumnKind(type);
+            if (!typed[i]) {
+
+              // First non-null value of an undeclared column: earlier values were null.
+
+              column = DBDataset::Column(kind);
+              column.reserve(nrows);
+              for (size_t row = 1; row < irow; ++row) {
+                if (kind == DBDataset::kSTRING)
+                  column.pushString("");
+                else if (kind == DBDataset::kDOUBLE)
+                  column.pushDouble(0.);
+                else
+                  column.pushLong(0);
               }
+              column_types[i] = type;
+              typed[i] = true;
             }
-            else {
-              mf::LogError("DBFolder") << "Unrecognized sqlite data type"
-                                       << "\n";
-              throw cet::exception("DBFolder") << "Unrecognized sqlite data type.";
+            else if ((kind == DBDataset::kSTRING && column.kind() != DBDataset::kSTRING) ||
+                     (kind == DBDataset::kDOUBLE && column.kind() == DBDataset::kLONG)) {
+              mf::LogWarning("DBFolder")
+                << "Column " << column_names[i] << " of type " << column_types[i] << " has "
+                << type << " value in row " << irow << ", promoted to " << type << ".";
+              column.promote(kind);
+              column_types[i] = type;
             }
-            firstcol = false;
+          }
+
+          // Null values read as zero or empty.
+
+          switch (column.kind()) {
+          case DBDataset::kLONG: {
+            long value = sqlite3_column_int64(fSQLiteDataStmt, col);
+            column.pushLong(value);
+            if (i == 0) channels.push_back(value);
+            break;
+          }
+          case DBDataset::kDOUBLE:
+            column.pushDouble(sqlite3_column_double(fSQLiteDataStmt, col));
+            break;
+          case DBDataset::kSTRING: {
+            const char* s = (const char*)sqlite3_column_text(fSQLiteDataStmt, col);
+            column.pushString(s ? s : "");
+            break;
+          }
+          case DBDataset::kBOOL:
+            column.pushBool(sqlite3_column_int64(fSQLiteDataStmt, col) != 0);
+            break;
           }
         }
       }
@@ -675,34 +1613,32 @@ namespace lariov {
         throw cet::exception("DBFolder") << "sqlite3_step error.";
       }
     }
+    if (irow == 0) {
+      mf::LogError("DBFolder") << "No data rows."
+                               << "\n";
+      throw cet::exception("DBFolder") << "No data rows.";
+    }
     if (irow != nrows) {
       mf::LogError("DBFolder") << "Wrong number of data rows " << irow << "," << nrows << "\n";
       throw cet::exception("DBFolder")
         << "Wrong number of data rows " << irow << "," << nrows << "\n";
     }
-    if (values.size() != nrows * nrelcols) {
-      mf::LogError("DBFolder") << "Wrong number of values " << values.size() << "," << nrows << ","
-                               << nrelcols << "\n";
+    if (columns.size() != nrelcols) {
+      mf::LogError("DBFolder") << "Wrong number of columns " << columns.size() << "," << nrelcols
+                               << "\n";
       throw cet::exception("DBFolder")
-        << "Wrong number of values " << values.size() << "," << nrows << "," << nrelcols << "\n";
+        << "Wrong number of columns " << columns.size() << "," << nrelcols << "\n";
     }
 
-    // Delete statement.
-
-    sqlite3_finalize(stmt);
-
-    // Close database.
-
-    sqlite3_close(db);
-
     // Fill result.
 
+    fMetrics.sqlite_rows->Add(irow);
     data = DBDataset(begin_ts,
                      end_ts,
                      std::move(column_names),
                      std::move(column_types),
                      std::move(channels),
-                     std::move(values));
+                     std::move(columns));
 
     // Done.
 
@@ -748,21 +1684,15 @@ namespace lariov {
       // Loop over columns.
 
       for (size_t col = 0; col < ncols; ++col) {
-        if (types[col] == "bigint" || types[col] == "integer" || types[col] == "boolean") {
-          long value = dbrow.getLongData(col);
-          log << names[col] << " = " << value << "\n";
-        }
-        else if (types[col] == "real") {
-          double value = dbrow.getDoubleData(col);
-          log << names[col] << " = " << value << "\n";
-        }
-        else if (types[col] == "text" or types[col] == "boolean") {
-          std::string value = dbrow.getStringData(col);
-          log << names[col] << " = " << value << "\n";
-        }
-        else {
-          mf::LogError("DBFolder") << "Unknown type " << types[col] << "\n";
-          throw cet::exception("DBFolder") << "Unknown type.";
+        switch (data.getColumn(col).kind()) {
+        case DBDataset::kLONG:
+        case DBDataset::kBOOL: log << names[col] << " = " << dbrow.getLongData(col) << "\n"; break;
+        case DBDataset::kDOUBLE:
+          log << names[col] << " = " << dbrow.getDoubleData(col) << "\n";
+          break;
+        case DBDataset::kSTRING:
+          log << names[col] << " = " << dbrow.getStringView(col) << "\n";
+          break;
         }
       }
     }
@@ -770,153 +1700,148 @@ namespace lariov {
 
   bool DBFolder::CompareDataset(const DBDataset& data1, const DBDataset& data2) const
   {
-    bool compare_ok = true;
     mf::LogInfo("DBFolder") << "\nComparing datasets."
                             << "\n";
 
-    size_t nrows1 = data1.nrows();
-    size_t nrows2 = data2.nrows();
-    //mf::LogInfo log("DBFolder");
-    //log << "Dataset 1 contains " << nrows1 << " rows." << "\n";
-    //log << "Dataset 2 contains " << nrows2 << " rows." << "\n";
-    if (nrows1 != nrows2) compare_ok = false;
-
-    // Compare begin time.
-
-    std::string begin1 = data1.beginTime().DBStamp();
-    std::string begin2 = data2.beginTime().DBStamp();
-    if (begin1 != begin2) compare_ok = false;
-
-    // Compare end time.
+    // Problems are collected and reported together at the end.
 
-    std::string end1 = data1.beginTime().DBStamp();
-    std::string end2 = data2.beginTime().DBStamp();
-    if (end1 != end2) compare_ok = false;
-
-    // Compare column names.
-
-    size_t ncols1 = data1.ncols();
-    size_t ncols2 = data2.ncols();
-    const std::vector<std::string>& names1 = data1.colNames();
-    const std::vector<std::string>& names2 = data2.colNames();
-    if (ncols1 != ncols2 || ncols1 != names1.size() || ncols2 != names2.size()) {
-      mf::LogWarning("DBFolder") << "Columns names size mismatch " << ncols1 << " vs. " << ncols2
-                                 << " vs. " << names1.size() << " vs. " << names2.size() << "\n";
-      compare_ok = false;
-    }
-    if (compare_ok) {
-      for (size_t c = 0; c < ncols1; ++c) {
-        if (names1[c] != names2[c]) {
-          mf::LogWarning("DBFolder")
-            << "Name mismatch " << names1[c] << " vs. " << names2[c] << "\n";
-          compare_ok = false;
-        }
-      }
-    }
-
-    // Compare column types.
-
-    const std::vector<std::string>& types1 = data1.colTypes();
-    const std::vector<std::string>& types2 = data2.colTypes();
-    if (ncols1 != ncols2 || ncols1 != types1.size() || ncols2 != types2.size()) {
-      mf::LogWarning("DBFolder") << "Column types ize mismatch " << ncols1 << " vs. " << ncols2
-                                 << " vs. " << types1.size() << " vs. " << types2.size() << "\n";
+    std::ostringstream report;
+    bool compare_ok = true;
+    auto fail = [&](const std::string& msg) {
+      report << msg << "\n";
       compare_ok = false;
-    }
-    if (compare_ok) {
-      for (size_t c = 0; c < ncols2; ++c) {
-
-        // Type "bigint" matches "integer."
-        // Type "boolean" matches "integer."
-
-        std::string type1 = types1[c];
-        std::string type2 = types2[c];
+    };
+
+    // Compare IOV.
+
+    if (data1.beginTime() != data2.beginTime())
+      fail("Begin time mismatch " + data1.beginTime().DBStamp() + " vs. " +
+           data2.beginTime().DBStamp());
+    if (data1.endTime() != data2.endTime())
+      fail("End time mismatch " + data1.endTime().DBStamp() + " vs. " +
+           data2.endTime().DBStamp());
+
+    // Identical content fingerprints mean identical schema, channels, and values,
+    // so the column comparison can be skipped.
+
+    bool same_content = data1.fingerprint() != 0 && data1.fingerprint() == data2.fingerprint();
+
+    // Compare column names and types.
+    // Type "bigint" matches "integer."
+    // Type "boolean" matches "integer."
+
+    size_t ncols = data1.ncols();
+    size_t nrows = data1.nrows();
+    if (!same_content) {
+      if (ncols != data2.ncols())
+        fail("Number of columns mismatch " + std::to_string(ncols) + " vs. " +
+             std::to_string(data2.ncols()));
+      for (size_t col = 0; compare_ok && col < ncols; ++col) {
+        const std::string& name1 = data1.colNames()[col];
+        const std::string& name2 = data2.colNames()[col];
+        if (name1 != name2) fail("Name mismatch " + name1 + " vs. " + name2);
+        std::string type1 = data1.colTypes()[col];
+        std::string type2 = data2.colTypes()[col];
         if (type1 == "bigint" || type1 == "boolean") type1 = "integer";
         if (type2 == "bigint" || type2 == "boolean") type2 = "integer";
-        if (type1 != type2) {
-          mf::LogWarning("DBFolder") << "Type mismatch " << type1 << " vs. " << type2 << "\n";
-          compare_ok = false;
-        }
+        if (type1 != type2) fail("Type mismatch " + type1 + " vs. " + type2);
       }
-    }
 
-    // Compare channels.
-
-    const std::vector<DBChannelID_t>& channels1 = data1.channels();
-    const std::vector<DBChannelID_t>& channels2 = data2.channels();
-    if (nrows1 != nrows2 || nrows1 != channels1.size() || nrows2 != channels2.size()) {
-      mf::LogWarning("DBFolder") << "Channels size mismatch " << nrows1 << " vs. " << nrows2
-                                 << " vs. " << channels1.size() << " vs. " << channels2.size()
-                                 << "\n";
-      compare_ok = false;
-    }
-    if (compare_ok) {
-      for (size_t r = 0; r < nrows1; ++r) {
-        if (channels1[r] != channels2[r]) {
-          mf::LogWarning("DBFolder")
-            << "Channel mismatch " << channels1[r] << " vs. " << channels2[r] << "\n";
-          compare_ok = false;
-        }
+      // Compare channels.
+
+      if (nrows != data2.nrows())
+        fail("Number of rows mismatch " + std::to_string(nrows) + " vs. " +
+             std::to_string(data2.nrows()));
+      else if (data1.channels() != data2.channels()) {
+        auto diff = std::mismatch(
+          data1.channels().begin(), data1.channels().end(), data2.channels().begin());
+        fail("Channel mismatch " + std::to_string(*diff.first) + " vs. " +
+             std::to_string(*diff.second) + " in row " +
+             std::to_string(diff.first - data1.channels().begin()));
       }
     }
 
-    // Compare number of values.
+    // Compare values column by column.
+    // Mismatches are first counted in a branch-free pass over the whole column.
+    // Only columns with mismatches are scanned again, to collect examples.
 
-    if (data1.data().size() != data2.data().size()) {
-      mf::LogWarning("DBFolder") << "Values size mismatch " << data1.data().size() << " vs. "
-                                 << data2.data().size() << "\n";
-      compare_ok = false;
-    }
-
-    // Data rows.
-    if (compare_ok) {
-      for (size_t row = 0; row < nrows1; ++row) {
-
-        DBDataset::DBRow dbrow1 = data1.getRow(row);
-        DBDataset::DBRow dbrow2 = data2.getRow(row);
-        //mf::LogInfo("DBFolder") << "\nRow " << row << "\n";
-
-        // Loop over columns.
-
-        for (size_t col = 0; col < ncols1; ++col) {
-          if (types1[col] == "integer" || types1[col] == "bigint" || types1[col] == "boolean") {
-            long value1 = dbrow1.getLongData(col);
-            long value2 = dbrow2.getLongData(col);
-            //mf::LogInfo log("DBFolder")
-            //log << names1[col] << " 1 = " << value1 << "\n";
-            //log << names2[col] << " 2 = " << value2 << "\n";
-            if (value1 != value2) {
-              mf::LogWarning("DBFolder")
-                << "Value mismatch " << value1 << " vs. " << value2 << "\n";
-              compare_ok = false;
-            }
-          }
-          else if (types1[col] == "real") {
-            double value1 = dbrow1.getDoubleData(col);
-            double value2 = dbrow2.getDoubleData(col);
-            //mf::LogInfo log("DBFolder")
-            //log << names1[col] << " 1 = " << value1 << "\n";
-            //log << names2[col] << " 2 = " << value2 << "\n";
-            if (value1 != value2) {
-              mf::LogWarning("DBFolder")
-                << "Value mismatch " << value1 << " vs. " << value2 << "\n";
-              compare_ok = false;
-            }
-          }
-          else if (types1[col] == "text") {
-            std::string value1 = dbrow2.getStringData(col);
-            std::string value2 = dbrow2.getStringData(col);
-            if (value1 != value2) {
-              mf::LogWarning("DBFolder")
-                << "Value mismatch " << value1 << " vs. " << value2 << "\n";
-              compare_ok = false;
-            }
-          }
-          else {
-            mf::LogError("DBFolder") << "Unknown type " << types1[col] << "\n";
-            throw cet::exception("DBFolder") << "Unknown type.";
+    if (!same_content && compare_ok) {
+      const std::vector<DBChannelID_t>& channels = data1.channels();
+      double tol = fCompareTolerance;
+      for (size_t col = 0; col < ncols; ++col) {
+        const DBDataset::Column& column1 = data1.getColumn(col);
+        const DBDataset::Column& column2 = data2.getColumn(col);
+        DBDataset::ColumnKind kind1 = column1.kind();
+        DBDataset::ColumnKind kind2 = column2.kind();
+        if ((kind1 == DBDataset::kSTRING) != (kind2 == DBDataset::kSTRING)) {
+          fail("Column " + data1.colNames()[col] + ": storage mismatch");
+          continue;
+        }
+        bool is_double = kind1 == DBDataset::kDOUBLE || kind2 == DBDataset::kDOUBLE;
+
+        // Return true if the values of one row differ.
+        // Reals are equal within tolerance, and NaNs equal NaNs (no branches,
+        // so that the loops below can be vectorized).
+
+        auto reals_differ = [tol](double value1, double value2) {
+          bool same = (std::abs(value1 - value2) <=
+                       tol * std::max(std::abs(value1), std::abs(value2))) |
+                      (value1 == value2) | ((value1 != value1) & (value2 != value2));
+          return !same;
+        };
+        auto row_differs = [&](size_t row) {
+          if (kind1 == DBDataset::kSTRING) return column1.getString(row) != column2.getString(row);
+          if (is_double) return reals_differ(column1.getDouble(row), column2.getDouble(row));
+          return column1.getLong(row) != column2.getLong(row);
+        };
+
+        size_t mismatches = 0;
+        if (kind1 == DBDataset::kDOUBLE && kind2 == DBDataset::kDOUBLE) {
+          const double* values1 = column1.doubles().data();
+          const double* values2 = column2.doubles().data();
+          for (size_t row = 0; row < nrows; ++row)
+            mismatches += reals_differ(values1[row], values2[row]);
+        }
+        else if (kind1 == DBDataset::kLONG && kind2 == DBDataset::kLONG) {
+          const std::int64_t* values1 = column1.longs().data();
+          const std::int64_t* values2 = column2.longs().data();
+          for (size_t row = 0; row < nrows; ++row)
+            mismatches += (values1[row] != values2[row]);
+        }
+        else {
+          for (size_t row = 0; row < nrows; ++row)
+            mismatches += row_differs(row);
+        }
+        if (mismatches == 0) continue;
+
+        // Summarize column.
+
+        compare_ok = false;
+        report << "Column " << data1.colNames()[col] << ": " << mismatches << " of " << nrows
+               << " values differ";
+        if (is_double) {
+          double max_diff = 0.;
+          for (size_t row = 0; row < nrows; ++row) {
+            double diff = std::abs(column1.getDouble(row) - column2.getDouble(row));
+            if (diff > max_diff) max_diff = diff;
           }
+          report << " (max abs. difference " << max_diff << ")";
+        }
+        report << ", e.g.";
+        size_t examples = 0;
+        for (size_t row = 0; row < nrows && examples < kCompareExamples; ++row) {
+          if (!row_differs(row)) continue;
+          report << "\n  channel " << channels[row] << ": ";
+          if (kind1 == DBDataset::kSTRING)
+            report << "\"" << column1.getString(row) << "\" vs. \"" << column2.getString(row)
+                   << "\"";
+          else if (is_double)
+            report << column1.getDouble(row) << " vs. " << column2.getDouble(row);
+          else
+            report << column1.getLong(row) << " vs. " << column2.getLong(row);
+          ++examples;
         }
+        report << "\n";
       }
     }
 
@@ -925,9 +1850,9 @@ namespace lariov {
                               << "\n";
     }
     else {
-      mf::LogError("DBFolder") << "Comparison fail."
-                               << "\n";
-      throw cet::exception("DBFolder") << "Comparison fail.";
+      throw cet::exception("DBFolder") << "Comparison fail for folder " << fFolderName << ", IOV "
+                                       << data1.beginTime().DBStamp() << ":\n"
+                                       << report.str();
     }
     return compare_ok;
   }
@@ -4,17 +4,74 @@
 #include "larevt/CalibrationDBI/IOVData/IOVTimeStamp.h"
 #include "larevt/CalibrationDBI/Interface/CalibrationDBIFwd.h"
 #include "larevt/CalibrationDBI/Providers/DBDataset.h"
+#include "larevt/CalibrationDBI/Providers/DBMetrics.h"
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <span>
 #include <string>
+#include <type_traits>
 #include <vector>
 
+struct sqlite3;
+struct sqlite3_stmt;
+
 namespace lariov {
 
   typedef void* Dataset;
   typedef void* Tuple;
 
+  class DBDiskCache;
+  class DBSharedCache;
+
   class DBFolder {
 
   public:
+    // Typed handle of a named column (T = bool, long, double, or std::string).
+    //
+    // A handle is bound to the current dataset by ResolveColumn, which must be
+    // called after each UpdateData.  The column name is only looked up when the
+    // dataset schema (see DBDataset::schemaID) differs from the schema that the
+    // handle was last resolved against.  Otherwise resolving is a constant-time
+    // rebind.  Values are then read by row number (index in Channels()), which
+    // is a single indexed load when the column storage type matches T.
+
+    template <class T>
+    class ColumnHandle {
+    public:
+      explicit ColumnHandle(const std::string& name) : fName(name) {}
+
+      const std::string& Name() const { return fName; }
+      size_t ColumnNumber() const { return fColumnNumber; }
+      std::uint64_t SchemaID() const { return fSchemaID; }
+
+      T operator[](size_t row) const
+      {
+        if constexpr (std::is_same_v<T, bool>)
+          return fColumn->getBool(row);
+        else if constexpr (std::is_same_v<T, std::string>)
+          return std::string(fColumn->getString(row));
+        else if (!fDirect.empty())
+          return fDirect[row];
+        else if constexpr (std::is_same_v<T, double>)
+          return fColumn->getDouble(row);
+        else
+          return fColumn->getLong(row);
+      }
+
+    private:
+      friend class DBFolder;
+
+      std::string fName;
+      std::uint64_t fSchemaID = 0; // Schema resolved against (0 = not resolved).
+      size_t fColumnNumber = 0;
+      const DBDataset::Column* fColumn = nullptr; // Borrowed from current dataset.
+      std::span<const T> fDirect;                 // Set if storage type matches T.
+    };
+
     DBFolder(const std::string& name,
              const std::string& url,
              const std::string& url2,
@@ -29,26 +86,177 @@ namespace lariov {
     int GetNamedChannelData(DBChannelID_t channel, const std::string& name, std::string& data);
     //int GetNamedChannelData(DBChannelID_t channel, const std::string& name, std::vector<double>& data);
 
+    // Bulk column accessors.
+    // Fill data with the named column for all channels, in channel order (same order
+    // as GetChannelList).  The column name is resolved once per call.
+
+    int GetNamedColumnData(const std::string& name, std::vector<bool>& data) const;
+    int GetNamedColumnData(const std::string& name, std::vector<long>& data) const;
+    int GetNamedColumnData(const std::string& name, std::vector<double>& data) const;
+    int GetNamedColumnData(const std::string& name, std::vector<std::string>& data) const;
+
+    // Zero-copy column accessors.
+    // The returned channels and spans are only valid until the next call of UpdateData.
+    // The span accessors throw if the column storage type does not match.
+
+    const std::vector<DBChannelID_t>& Channels() const { return fCache.channels(); }
+    std::span<const std::int64_t> GetLongColumn(const std::string& name) const;
+    std::span<const double> GetDoubleColumn(const std::string& name) const;
+
+    // Bind column handle to the current dataset (see ColumnHandle).
+    // Throws if the column is not present.
+
+    template <class T>
+    ColumnHandle<T>& ResolveColumn(ColumnHandle<T>& handle) const;
+
     const std::string& URL() const { return fURL; }
     const std::string& FolderName() const { return fFolderName; }
     const std::string& Tag() const { return fTag; }
 
     const IOVTimeStamp& CachedStart() const { return fCache.beginTime(); }
     const IOVTimeStamp& CachedEnd() const { return fCache.endTime(); }
+    std::uint64_t CachedFingerprint() const { return fCache.fingerprint(); }
+
+    // Changes made by the most recent update of the cached dataset.
+    // If HasChangedRows is true, the current and previous datasets have the same
+    // schema and channels, and ChangedRows lists the row numbers (in increasing
+    // order) whose values differ.  PreviousFingerprint is the fingerprint of the
+    // previous dataset, which lets clients check that they hold its content.
+
+    bool HasChangedRows() const { return fHaveChangedRows; }
+    const std::vector<size_t>& ChangedRows() const { return fChangedRows; }
+    std::uint64_t PreviousFingerprint() const { return fPreviousFingerprint; }
 
     bool UpdateData(DBTimeStamp_t raw_time);
 
-    void GetSQLiteData(int t, DBDataset& data) const;
+    // Return true if UpdateData would load a new dataset for the specified time.
+
+    bool NeedsUpdate(DBTimeStamp_t raw_time) const;
+
+    // Number of times the cached dataset was replaced by UpdateData.
+    // Lets clients detect updates made on their behalf (see DBFolderRegistry).
+
+    unsigned long Generation() const { return fGeneration; }
+
+    // Keep the failure of an update made on behalf of the client (see
+    // DBFolderRegistry).  The next UpdateData throws it, instead of repeating
+    // the request, if it is for the same time.
+
+    void SetUpdateError(DBTimeStamp_t raw_time, std::exception_ptr error);
+
+    // Enable node-local persistent cache of http payloads (see DBDiskCache).
+    // An empty directory disables the cache, which is never used for untagged folders.
+
+    void SetDiskCache(const std::string& dir, std::uint64_t max_bytes);
+
+    // Enable node-wide cache of datasets in shared memory (see DBSharedCache).
+    // The shared cache requires an IOV index, which is loaded if necessary.
+    // The cache stays disabled if the index can't be loaded, in test mode, and
+    // for untagged folders.
+
+    void SetSharedMemoryCache(bool enable, std::uint64_t max_bytes);
+    bool UseSharedMemoryCache() const { return fSharedCache != nullptr; }
+
+    // Set number of recently used datasets (in addition to the current one)
+    // that are kept in memory, so that returning to a recent IOV needs no refetch.
+
+    void SetIOVCacheSize(size_t n);
+
+    // Enable asynchronous prefetch of the IOV following the current one, with
+    // at most max_in_flight outstanding http requests (0 = disabled).
+    // Prefetch is never used for sqlite databases or in test mode.
+
+    void SetPrefetch(size_t max_in_flight);
+
+    // Load the complete list of IOV begin times of this folder and tag, from the
+    // sqlite database (table <folder>_iovs) or from the http server (/iovs query).
+    // Afterwards, times are resolved to IOVs locally, and data are always requested
+    // using the exact IOV begin time.  Returns false (and keeps working without an
+    // index) if the list could not be loaded.
+
+    bool LoadIOVIndex();
+    bool HasIOVIndex() const { return !fIOVIndex.empty(); }
+    const std::vector<IOVTimeStamp>& IOVBeginTimes() const { return fIOVIndex; }
+
+    // Find IOV containing the specified time using the IOV index.
+    // Returns false if there is no index, or if the time precedes the first IOV.
+    // The end time of the last IOV is infinite.
+
+    bool FindIOV(const IOVTimeStamp& ts, IOVTimeStamp& begin, IOVTimeStamp& end) const;
+
+    // Begin times of all IOVs that overlap the time range [begin, end) (requires index).
+
+    std::vector<IOVTimeStamp> IOVsInRange(const IOVTimeStamp& begin,
+                                          const IOVTimeStamp& end) const;
+
+    // Fetch the dataset of the IOV beginning at the specified time from the primary
+    // server (consulting the persistent cache), without touching the cached dataset.
+    // May be called concurrently from several threads (used for bulk downloads).
+
+    DBDataset GetIOVData(const IOVTimeStamp& begin_time) const;
+
+    // Retry failed http requests up to max_retries times (0 = fail immediately).
+    // Retries are delayed by exponential backoff with jitter: the n-th retry waits
+    // between 0.5 and 1 times backoff * 2^(n-1) seconds (at most one minute).
+
+    void SetRetries(unsigned int max_retries, double backoff);
+
+    // Enable hedged http requests to the secondary url (0 = disabled).
+    // If the primary server has not answered within the specified percentile of
+    // recent response times (or initial_delay seconds, until enough responses have
+    // been seen), or if it fails, the same request is sent to the secondary url,
+    // and whichever answer arrives first is used.  Hedging requires a secondary
+    // url, and is disabled in test mode, where the secondary url is used for
+    // comparisons.
+
+    void SetHedging(double percentile, double initial_delay);
+
+    // Prefetch statistics.
+
+    unsigned int PrefetchesIssued() const { return fPrefetchesIssued; }
+    unsigned int PrefetchesUsed() const { return fPrefetchesUsed; }
+    unsigned int PrefetchesUnused() const { return fPrefetchesUnused; }
+
+    // Retry and hedging statistics.
+
+    unsigned int Retries() const;
+    unsigned int HedgesIssued() const;
+    unsigned int HedgesWon() const;
+
+    // Access metrics are recorded in DBMetrics under the folder name:
+    //
+    // http_time, http_parse_time - Http request and parse times (us, histograms).
+    // http_requests, http_errors - Number of http requests and failed requests.
+    // http_bytes                 - Size of parsed http payloads (binary image size).
+    // sqlite_time, sqlite_rows   - Sqlite query time (us, histogram) and rows read.
+    // iov_crossings              - Number of times the cached dataset was replaced.
+    // recent_hits, prefetch_hits,
+    // shared_cache_hits,
+    // disk_cache_hits            - Datasets found in memory or in a cache.
+    // misses                     - Datasets fetched from the database (including prefetches).
+
+    void GetSQLiteData(long t, DBDataset& data) const;
 
     int GetChannelList(std::vector<DBChannelID_t>& channels) const;
 
     void DumpDataset(const DBDataset& data) const;
 
+    // Compare datasets (used in test mode).  Datasets with the same content
+    // fingerprint are equal.  Otherwise, columns are compared value by value,
+    // real values with relative tolerance (see SetCompareTolerance).
+    // Throws if the datasets differ.  The exception message reports the
+    // mismatches as a summary per column, with a few examples.
+
     bool CompareDataset(const DBDataset& data1, const DBDataset& data2) const;
 
+    // Relative tolerance for real values in CompareDataset (default 1e-9).
+
+    void SetCompareTolerance(double tolerance);
+
   private:
     void GetRow(DBChannelID_t channel);
     size_t GetColumn(const std::string& name) const;
+    size_t ResolveColumnNumber(const std::string& name, std::uint64_t old_schema) const;
 
     bool IsValid(const IOVTimeStamp& time) const
     {
@@ -58,6 +266,71 @@ namespace lariov {
         return false;
     }
 
+    // Load the dataset valid at the specified time into the (empty) cache.
+
+    void LoadData(const IOVTimeStamp& ts, DBTimeStamp_t raw_time);
+
+    // Compare the new dataset to the previous one.
+
+    void FindChangedRows(const DBDataset& previous);
+
+    // Add a dataset to the list of recently used datasets.
+
+    void RememberDataset(DBDataset&& data);
+
+    // Sqlite access.
+
+    void OpenSQLite() const;
+    sqlite3_stmt* PrepareSQLite(const std::string& sql) const;
+    void CloseSQLite() const;
+
+    // Http access.
+
+    std::string DataURL(const std::string& url, const IOVTimeStamp& ts) const;
+    struct Metrics; // Defined below.
+    static DBDataset GetHTTPData(const std::string& fullurl,
+                                 int timeout,
+                                 const Metrics* metrics); // Null: not recorded.
+    DBDataset FetchData(const IOVTimeStamp& ts, int timeout) const;
+    DBDataset FetchHTTPData(const IOVTimeStamp& ts, int timeout) const;
+
+    // Retry and hedging policy of one http request.  The policy and the request
+    // statistics of the folder are held by the request, so that prefetches
+    // follow the same policy without depending on the folder.
+
+    struct RequestStats; // Defined in DBFolder.cxx.
+    struct RequestPolicy {
+      std::string url;          // Primary url.
+      std::string url2;         // Secondary url (empty if not hedged).
+      int timeout;              // Seconds.
+      unsigned int max_retries; // See SetRetries.
+      double backoff;           // Seconds.
+      double hedge_delay;       // Seconds.
+    };
+    RequestPolicy MakeRequestPolicy(const IOVTimeStamp& ts, int timeout) const;
+    static DBDataset SendRequest(const RequestPolicy& policy,
+                                 RequestStats& stats,
+                                 const Metrics* metrics);
+    static DBDataset HedgedRequest(const RequestPolicy& policy,
+                                   RequestStats& stats,
+                                   const Metrics* metrics);
+
+    // IOV index.
+
+    void LoadSQLiteIOVIndex();
+    void LoadHTTPIOVIndex();
+    IOVTimeStamp RequestTime(const IOVTimeStamp& ts) const;
+
+    // Prefetch.
+
+    struct PrefetchState; // Defined in DBFolder.cxx.
+    void SchedulePrefetch();
+    bool UsePrefetch(const IOVTimeStamp& ts);
+    static void RunPrefetch(std::shared_ptr<PrefetchState> state,
+                            const RequestPolicy& policy,
+                            std::shared_ptr<RequestStats> stats,
+                            const Metrics& metrics);
+
     std::string fURL;
     std::string fURL2;
     std::string fFolderName;
@@ -67,9 +340,97 @@ namespace lariov {
     std::string fSQLitePath;
     int fMaximumTimeout;
 
+    // Sqlite connection and prepared statements (opened on first use).
+
+    mutable sqlite3* fSQLiteDB;
+    mutable sqlite3_stmt* fSQLiteIOVStmt;  // IOV begin time, end time, and row count.
+    mutable sqlite3_stmt* fSQLiteDataStmt; // Data rows.
+    mutable std::vector<int> fSQLiteColumns; // Relevant columns of data query.
+
+    // Persistent http payload cache (may be null).
+
+    std::unique_ptr<DBDiskCache> fDiskCache;
+
+    // Node-wide shared memory cache (may be null).
+
+    std::unique_ptr<DBSharedCache> fSharedCache;
+
     // Database cache.
 
     DBDataset fCache;
+    unsigned long fGeneration;
+
+    // Failed update on behalf of the client (see SetUpdateError).
+
+    DBTimeStamp_t fUpdateErrorTime;
+    std::exception_ptr fUpdateError;
+
+    // Changes since the previous dataset.
+
+    bool fHaveChangedRows;
+    std::vector<size_t> fChangedRows;
+    std::uint64_t fPreviousFingerprint;
+
+    // Sorted IOV begin times (empty if not loaded).
+
+    std::vector<IOVTimeStamp> fIOVIndex;
+
+    // Recently used datasets, most recent first.
+
+    std::list<DBDataset> fRecent;
+    size_t fMaxRecent;
+
+    // Pending prefetch requests.  Each request runs on a detached thread that
+    // only fetches and decodes a dataset (with the retry and hedging policy of
+    // the folder), which is handed over through the shared state.  Caches are
+    // updated when the dataset is used.
+
+    struct Prefetch {
+      IOVTimeStamp time;                    // Requested time.
+      std::shared_ptr<PrefetchState> state; // Shared with the request thread.
+    };
+    std::list<Prefetch> fPrefetches;
+    std::list<std::shared_ptr<PrefetchState>> fCancelledPrefetches; // Still running.
+    size_t fMaxPrefetch;
+    unsigned int fPrefetchesIssued;
+    unsigned int fPrefetchesUsed;
+    unsigned int fPrefetchesUnused;
+
+    // Retries and hedged requests.
+
+    unsigned int fMaxRetries;
+    double fRetryBackoff;                       // Seconds.
+    double fHedgePercentile;                    // 0 = hedging disabled.
+    double fHedgeInitialDelay;                  // Seconds.
+    std::shared_ptr<RequestStats> fRequestStats; // Shared with prefetch requests.
+
+    // Relative tolerance of CompareDataset.
+
+    double fCompareTolerance;
+
+    // Access metrics (owned by DBMetrics, which outlives all folders, so that
+    // requests still running after the folder is destroyed can update them).
+
+    struct Metrics {
+      DBMetrics::Histogram* http_time;
+      DBMetrics::Histogram* http_parse_time;
+      DBMetrics::Counter* http_requests;
+      DBMetrics::Counter* http_errors;
+      DBMetrics::Counter* http_bytes;
+      DBMetrics::Histogram* sqlite_time;
+      DBMetrics::Counter* sqlite_rows;
+      DBMetrics::Counter* iov_crossings;
+      DBMetrics::Counter* recent_hits;
+      DBMetrics::Counter* prefetch_hits;
+      DBMetrics::Counter* shared_cache_hits;
+      DBMetrics::Counter* disk_cache_hits;
+      DBMetrics::Counter* misses;
+    };
+    Metrics fMetrics;
+
+    // Last schema id seen by ResolveColumn (used to report schema changes).
+
+    mutable std::uint64_t fResolvedSchemaID;
 
     // Database row cache.
 
@@ -77,6 +438,24 @@ namespace lariov {
     DBChannelID_t fCachedChannel;
     DBDataset::DBRow fCachedRow;
   };
+
+  template <class T>
+  DBFolder::ColumnHandle<T>& DBFolder::ResolveColumn(ColumnHandle<T>& handle) const
+  {
+    if (handle.fSchemaID != fCache.schemaID()) {
+      handle.fColumnNumber = ResolveColumnNumber(handle.fName, handle.fSchemaID);
+      handle.fSchemaID = fCache.schemaID();
+    }
+    handle.fColumn = &fCache.getColumn(handle.fColumnNumber);
+    handle.fDirect = std::span<const T>();
+    if constexpr (std::is_same_v<T, double>) {
+      if (handle.fColumn->kind() == DBDataset::kDOUBLE) handle.fDirect = handle.fColumn->doubles();
+    }
+    else if constexpr (std::is_same_v<T, long> && std::is_same_v<long, std::int64_t>) {
+      if (handle.fColumn->kind() == DBDataset::kLONG) handle.fDirect = handle.fColumn->longs();
+    }
+    return handle;
+  }
 }
 
 #endif
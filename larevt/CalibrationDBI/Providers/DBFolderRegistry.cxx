@@ -0,0 +1,137 @@
+//=================================================================================
+//
+// Name: DBFolderRegistry.cxx
+//
+// Purpose: Implementation for class DBFolderRegistry.
+//
+// Created: 18-Oct-2026
+//
+//=================================================================================
+
+#include "DBFolderRegistry.h"
+#include "DBFolder.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+#include <algorithm>
+#include <exception>
+
+namespace lariov {
+
+  // Process-wide registry.
+
+  DBFolderRegistry& DBFolderRegistry::Instance()
+  {
+    static DBFolderRegistry registry;
+    return registry;
+  }
+
+  // Destructor.
+
+  DBFolderRegistry::~DBFolderRegistry()
+  {
+    {
+      std::lock_guard<std::mutex> lock(fQueueMutex);
+      fStop = true;
+    }
+    fQueueCV.notify_all();
+    for (auto& thread : fThreads)
+      thread.join();
+  }
+
+  // Register folder.
+
+  void DBFolderRegistry::Register(DBFolder* folder, std::mutex* mutex)
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    auto it = std::find(fFolders.begin(), fFolders.end(), folder);
+    if (it == fFolders.end()) {
+      fFolders.push_back(folder);
+      fMutexes.push_back(mutex);
+    }
+    else
+      fMutexes[it - fFolders.begin()] = mutex;
+    fLastTime = 0;
+  }
+
+  // Unregister folder.
+
+  void DBFolderRegistry::Unregister(DBFolder* folder)
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    auto it = std::find(fFolders.begin(), fFolders.end(), folder);
+    if (it == fFolders.end()) return;
+    fMutexes.erase(fMutexes.begin() + (it - fFolders.begin()));
+    fFolders.erase(it);
+  }
+
+  // Update all registered folders.
+
+  void DBFolderRegistry::WarmUp(DBTimeStamp_t raw_time)
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    if (raw_time == fLastTime) return;
+    fLastTime = raw_time;
+
+    // Find folders that need a new IOV.
+
+    std::vector<size_t> stale;
+    for (size_t i = 0; i < fFolders.size(); ++i) {
+      std::unique_lock<std::mutex> folder_lock;
+      if (fMutexes[i]) folder_lock = std::unique_lock<std::mutex>(*fMutexes[i]);
+      if (fFolders[i]->NeedsUpdate(raw_time)) stale.push_back(i);
+    }
+    if (stale.empty()) return;
+
+    auto update = [this, raw_time](size_t i) {
+      DBFolder* folder = fFolders[i];
+      std::unique_lock<std::mutex> folder_lock;
+      if (fMutexes[i]) folder_lock = std::unique_lock<std::mutex>(*fMutexes[i]);
+      try {
+        folder->UpdateData(raw_time);
+      }
+      catch (std::exception& e) {
+        mf::LogWarning("DBFolderRegistry") << "Warm-up of folder " << folder->FolderName()
+                                           << " failed: " << e.what() << "\n";
+        folder->SetUpdateError(raw_time, std::current_exception());
+      }
+      catch (...) {
+        folder->SetUpdateError(raw_time, std::current_exception());
+      }
+    };
+
+    // A single folder is updated in the calling thread.
+
+    if (stale.size() == 1) {
+      update(stale.front());
+      return;
+    }
+
+    // Queue updates for the worker pool (started or grown as needed), and wait.
+
+    std::unique_lock<std::mutex> queue_lock(fQueueMutex);
+    size_t nthreads = std::min<size_t>(stale.size(), kMaxThreads);
+    while (fThreads.size() < nthreads)
+      fThreads.emplace_back(&DBFolderRegistry::Work, this);
+    for (size_t i : stale)
+      fQueue.push_back([&update, i]() { update(i); });
+    fPending += stale.size();
+    fQueueCV.notify_all();
+    fDoneCV.wait(queue_lock, [this]() { return fPending == 0; });
+  }
+
+  // Run queued tasks until stopped.
+
+  void DBFolderRegistry::Work()
+  {
+    std::unique_lock<std::mutex> lock(fQueueMutex);
+    while (true) {
+      fQueueCV.wait(lock, [this]() { return fStop || !fQueue.empty(); });
+      if (fQueue.empty()) return;
+      std::function<void()> task = std::move(fQueue.front());
+      fQueue.pop_front();
+      lock.unlock();
+      task();
+      lock.lock();
+      if (--fPending == 0) fDoneCV.notify_all();
+    }
+  }
+}
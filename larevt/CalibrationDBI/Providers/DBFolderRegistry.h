@@ -0,0 +1,98 @@
+#ifndef DBFOLDERREGISTRY_H
+#define DBFOLDERREGISTRY_H
+//=================================================================================
+//
+// Name: DBFolderRegistry.h
+//
+// Purpose: Header for class DBFolderRegistry.
+//          This class coordinates concurrent updates of several DBFolders.
+//
+//          Each provider owns its own DBFolder, which is normally updated lazily,
+//          the first time the provider is accessed with a new event time.  When
+//          several folders need new IOVs for the same event (e.g. at the start of
+//          a run), the fetches then happen one after the other.
+//
+//          Folders that are registered with the (process-wide) registry are
+//          instead all updated together by WarmUp, which is called once per event
+//          time, before any provider is accessed.  Folders that need a new IOV are
+//          updated concurrently, by a pool of up to kMaxThreads worker threads
+//          that are started on first use and kept for the whole job.  WarmUp
+//          returns when all updates are done, so that the latency is that of the
+//          slowest folder, rather than the sum over all folders.
+//
+//          A failed update is logged, and kept by the folder (see
+//          DBFolder::SetUpdateError), so that the owning provider gets the
+//          exception from its next update for the same time, without repeating
+//          the request, and reports it in the usual way.
+//
+//          Each folder may be registered together with the mutex that its owner
+//          holds while accessing it; WarmUp then holds that mutex while updating
+//          the folder, so that warm-ups can run concurrently with accesses from
+//          other schedules.  Folders registered without a mutex must not be
+//          accessed while WarmUp runs.
+//
+// Created: 18-Oct-2026
+//
+//=================================================================================
+
+#include "larevt/CalibrationDBI/Interface/CalibrationDBIFwd.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lariov {
+
+  class DBFolder;
+
+  class DBFolderRegistry {
+
+  public:
+    // Maximum number of concurrent folder updates.
+
+    static constexpr unsigned int kMaxThreads = 8;
+
+    // Process-wide registry.
+
+    static DBFolderRegistry& Instance();
+
+    // Register and unregister folders (folders and mutexes are not owned).
+
+    void Register(DBFolder* folder, std::mutex* mutex = nullptr);
+    void Unregister(DBFolder* folder);
+
+    // Update all registered folders to the specified event time.
+    // Does nothing if the time is the same as in the previous call.
+
+    void WarmUp(DBTimeStamp_t raw_time);
+
+  private:
+    DBFolderRegistry() = default;
+    ~DBFolderRegistry(); // Stops worker threads.
+
+    // Run queued tasks until stopped (body of worker threads).
+
+    void Work();
+
+    // Data members.
+
+    std::mutex fMutex;
+    std::vector<DBFolder*> fFolders;   // Registered folders.
+    std::vector<std::mutex*> fMutexes; // Mutex held to update each folder (may be null).
+    DBTimeStamp_t fLastTime = 0;       // Time of last warm-up.
+
+    // Worker pool.
+
+    std::vector<std::thread> fThreads;
+    std::mutex fQueueMutex;                   // Protects members below.
+    std::condition_variable fQueueCV;         // Signals queued tasks, or stop.
+    std::condition_variable fDoneCV;          // Signals that all tasks are done.
+    std::deque<std::function<void()>> fQueue; // Queued tasks.
+    size_t fPending = 0;                      // Tasks queued or running.
+    bool fStop = false;
+  };
+}
+
+#endif
@@ -0,0 +1,137 @@
+//=================================================================================
+//
+// Name: DBMetrics.cxx
+//
+// Purpose: Implementation for class DBMetrics.
+//
+// Created: 18-Oct-2026
+//
+//=================================================================================
+
+#include "DBMetrics.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+namespace lariov {
+
+  // Fill histogram.
+
+  void DBMetrics::Histogram::Fill(double value)
+  {
+    size_t bin = 0;
+    if (value >= 1.) bin = std::min<size_t>(kBins - 1, std::ilogb(value) + 1);
+    fBins[bin].fetch_add(1, std::memory_order_relaxed);
+    fCount.fetch_add(1, std::memory_order_relaxed);
+    fSum.fetch_add(value, std::memory_order_relaxed);
+    double max = fMax.load(std::memory_order_relaxed);
+    while (value > max && !fMax.compare_exchange_weak(max, value, std::memory_order_relaxed)) {}
+  }
+
+  // Approximate quantile.
+
+  double DBMetrics::Histogram::Quantile(double q) const
+  {
+    std::uint64_t count = Count();
+    if (count == 0) return 0.;
+    std::uint64_t target = std::max<std::uint64_t>(1, std::ceil(q * count));
+    std::uint64_t sum = 0;
+    for (size_t bin = 0; bin < kBins; ++bin) {
+      sum += BinCount(bin);
+      if (sum >= target) return std::min(Max(), std::ldexp(1., bin));
+    }
+    return Max();
+  }
+
+  // Reset histogram.
+
+  void DBMetrics::Histogram::Reset()
+  {
+    for (auto& bin : fBins)
+      bin = 0;
+    fCount = 0;
+    fSum = 0.;
+    fMax = 0.;
+  }
+
+  // Process-wide registry.
+
+  DBMetrics& DBMetrics::Instance()
+  {
+    static DBMetrics metrics;
+    return metrics;
+  }
+
+  // Get counter.
+
+  DBMetrics::Counter& DBMetrics::GetCounter(const std::string& folder, const std::string& name)
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    auto& counter = fCounters[Key(folder, name)];
+    if (!counter) counter = std::make_unique<Counter>();
+    return *counter;
+  }
+
+  // Get histogram.
+
+  DBMetrics::Histogram& DBMetrics::GetHistogram(const std::string& folder,
+                                                const std::string& name)
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    auto& histogram = fHistograms[Key(folder, name)];
+    if (!histogram) histogram = std::make_unique<Histogram>();
+    return *histogram;
+  }
+
+  // Query counters.
+
+  std::map<std::string, std::uint64_t> DBMetrics::Counters() const
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    std::map<std::string, std::uint64_t> result;
+    for (const auto& [key, counter] : fCounters)
+      result[key] = counter->Value();
+    return result;
+  }
+
+  // Query histograms.
+
+  std::map<std::string, const DBMetrics::Histogram*> DBMetrics::Histograms() const
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    std::map<std::string, const Histogram*> result;
+    for (const auto& [key, histogram] : fHistograms)
+      result[key] = histogram.get();
+    return result;
+  }
+
+  // Print metrics.
+
+  void DBMetrics::Print(std::ostream& out, const std::string& folder) const
+  {
+    std::string prefix = folder.empty() ? "" : folder + "/";
+    auto selected = [&prefix](const std::string& key) {
+      return key.compare(0, prefix.size(), prefix) == 0;
+    };
+    for (const auto& [key, value] : Counters()) {
+      if (selected(key) && value > 0) out << std::setw(48) << std::left << key << value << "\n";
+    }
+    for (const auto& [key, histogram] : Histograms()) {
+      if (!selected(key) || histogram->Count() == 0) continue;
+      out << std::setw(48) << std::left << key << "n=" << histogram->Count()
+          << " mean=" << histogram->Mean() << " p50<=" << histogram->Quantile(0.5)
+          << " p99<=" << histogram->Quantile(0.99) << " max=" << histogram->Max() << "\n";
+    }
+  }
+
+  // Reset all metrics.
+
+  void DBMetrics::Reset()
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    for (auto& [key, counter] : fCounters)
+      counter->Reset();
+    for (auto& [key, histogram] : fHistograms)
+      histogram->Reset();
+  }
+}
@@ -0,0 +1,145 @@
+#ifndef DBMETRICS_H
+#define DBMETRICS_H
+//=================================================================================
+//
+// Name: DBMetrics.h
+//
+// Purpose: Header for class DBMetrics.
+//          This class is a process-wide registry of conditions access metrics.
+//
+//          Metrics are identified by a folder name and a metric name.  There are
+//          two kinds of metrics:
+//
+//          Counter   - Monotonic 64-bit count (e.g. cache hits, rows, bytes).
+//          Histogram - Distribution of values (e.g. latencies in microseconds),
+//                      with logarithmic (power of two) bins, plus count, sum,
+//                      and maximum.
+//
+//          Metrics are created on first use and live until the end of the job,
+//          so references to them can be kept and updated without lookups.
+//          Updates are lock-free.
+//
+//          Metrics can be queried programmatically (Counters, Histograms), and
+//          printed (Print), e.g. at the end of the job.
+//
+// Created: 18-Oct-2026
+//
+//=================================================================================
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+namespace lariov {
+
+  class DBMetrics {
+
+  public:
+    // Counter.
+
+    class Counter {
+    public:
+      void Add(std::uint64_t n = 1) { fValue.fetch_add(n, std::memory_order_relaxed); }
+      std::uint64_t Value() const { return fValue.load(std::memory_order_relaxed); }
+      void Reset() { fValue = 0; }
+
+    private:
+      std::atomic<std::uint64_t> fValue{0};
+    };
+
+    // Histogram with power of two bins.
+    // Bin 0 holds values < 1, bin i holds values in [2^(i-1), 2^i).
+    // The last bin also holds all larger values.
+
+    class Histogram {
+    public:
+      static constexpr size_t kBins = 40;
+
+      void Fill(double value);
+      std::uint64_t Count() const { return fCount.load(std::memory_order_relaxed); }
+      double Sum() const { return fSum.load(std::memory_order_relaxed); }
+      double Max() const { return fMax.load(std::memory_order_relaxed); }
+      double Mean() const { return Count() > 0 ? Sum() / Count() : 0.; }
+      std::uint64_t BinCount(size_t bin) const
+      {
+        return fBins[bin].load(std::memory_order_relaxed);
+      }
+
+      // Approximate quantile (upper edge of the bin containing the quantile).
+
+      double Quantile(double q) const;
+
+      void Reset();
+
+    private:
+      std::array<std::atomic<std::uint64_t>, kBins> fBins{};
+      std::atomic<std::uint64_t> fCount{0};
+      std::atomic<double> fSum{0.};
+      std::atomic<double> fMax{0.};
+    };
+
+    // Fill histogram with elapsed time (microseconds) when going out of scope.
+
+    class ScopedTimer {
+    public:
+      explicit ScopedTimer(Histogram& histogram)
+        : fHistogram(histogram), fStart(std::chrono::steady_clock::now())
+      {}
+      ~ScopedTimer() { fHistogram.Fill(Microseconds()); }
+      double Microseconds() const
+      {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() -
+                                                         fStart)
+          .count();
+      }
+
+    private:
+      Histogram& fHistogram;
+      std::chrono::steady_clock::time_point fStart;
+    };
+
+    // Process-wide registry.
+
+    static DBMetrics& Instance();
+
+    // Get (create if necessary) metrics.
+
+    Counter& GetCounter(const std::string& folder, const std::string& name);
+    Histogram& GetHistogram(const std::string& folder, const std::string& name);
+
+    // Query all metrics, keyed by "<folder>/<name>".
+
+    std::map<std::string, std::uint64_t> Counters() const;
+    std::map<std::string, const Histogram*> Histograms() const;
+
+    // Print metrics of one folder (or all folders if empty).
+
+    void Print(std::ostream& out, const std::string& folder = "") const;
+
+    // Reset all metrics to zero.
+
+    void Reset();
+
+  private:
+    DBMetrics() = default;
+
+    static std::string Key(const std::string& folder, const std::string& name)
+    {
+      return folder + "/" + name;
+    }
+
+    // Data members.
+
+    mutable std::mutex fMutex;
+    std::map<std::string, std::unique_ptr<Counter>> fCounters;
+    std::map<std::string, std::unique_ptr<Histogram>> fHistograms;
+  };
+}
+
+#endif
@@ -0,0 +1,270 @@
+//=================================================================================
+//
+// Name: DBSharedCache.cxx
+//
+// Purpose: Implementation for class DBSharedCache.
+//
+// Created: 18-Oct-2026
+//
+//=================================================================================
+
+#include "DBSharedCache.h"
+#include "DBDatasetImage.h"
+#include "cetlib_except/exception.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <filesystem>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <tuple>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+  // Segment header.  The dataset image follows at offset kHeaderSize.
+
+  struct SegmentHeader {
+    std::uint32_t ready;  // Set to kReady (atomically) after the image is complete.
+    std::uint32_t unused; // Padding.
+    std::uint64_t size;   // Image size.
+  };
+
+  constexpr size_t kHeaderSize = 64;
+  constexpr std::uint32_t kReady = 0x52454459; // "REDY"
+  static_assert(sizeof(SegmentHeader) <= kHeaderSize);
+
+  // Segments that are still empty after this many seconds are assumed to be
+  // left over by crashed creators.
+
+  constexpr time_t kStaleEmptyAge = 60;
+
+  // Where Linux keeps POSIX shared memory.
+
+  const std::string kShmDir = "/dev/shm";
+
+  // 64-bit FNV-1a hash.  Used to generate stable segment names.
+
+  std::uint64_t fnv1a(const std::string& s, std::uint64_t h = 14695981039346656037ULL)
+  {
+    for (unsigned char c : s) {
+      h ^= c;
+      h *= 1099511628211ULL;
+    }
+    return h;
+  }
+
+  std::uint32_t loadReady(const SegmentHeader* header)
+  {
+    // The ready flag is only written through a writable mapping by the creator.
+    // Atomic loads don't write, so they are safe on a read-only mapping.
+
+    return std::atomic_ref<std::uint32_t>(const_cast<SegmentHeader*>(header)->ready)
+      .load(std::memory_order_acquire);
+  }
+
+  // Check whether a segment that is not ready was abandoned by its creator.
+  // The creator holds an exclusive flock until the segment is ready, so a
+  // segment that can be locked is not being written.  A segment that has no
+  // size yet may not be locked by its creator yet, so it must also be old.
+
+  bool isStale(int fd, const struct stat& st)
+  {
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0) return false;
+    bool stale = true;
+    if (size_t(st.st_size) < kHeaderSize)
+      stale = time(nullptr) - st.st_mtime > kStaleEmptyAge;
+    else {
+      // The creator may have finished since the ready flag was checked.
+      SegmentHeader header;
+      if (pread(fd, &header, sizeof(header), 0) == sizeof(header) && header.ready == kReady)
+        stale = false;
+    }
+    flock(fd, LOCK_UN);
+    return stale;
+  }
+}
+
+namespace lariov {
+
+  // Constructor.
+
+  DBSharedCache::DBSharedCache(const std::string& url,
+                               const std::string& folder,
+                               const std::string& tag,
+                               std::uint64_t max_bytes,
+                               const std::string& segment_prefix)
+    : fSegmentPrefix(segment_prefix), fMaxBytes(max_bytes)
+  {
+    std::ostringstream prefix;
+    prefix << "/" << fSegmentPrefix << std::hex << std::setw(16) << std::setfill('0')
+           << fnv1a(url + '\n' + folder + '\n' + tag) << "-";
+    fPrefix = prefix.str();
+  }
+
+  // Segment name for IOV.
+
+  std::string DBSharedCache::SegmentName(const IOVTimeStamp& begin_time) const
+  {
+    return fPrefix + begin_time.DBStamp();
+  }
+
+  // Look up payload.
+
+  bool DBSharedCache::Find(const IOVTimeStamp& begin_time, DBDataset& data) const
+  {
+    std::string name = SegmentName(begin_time);
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      close(fd);
+      return false;
+    }
+    size_t total = st.st_size;
+    void* addr = MAP_FAILED;
+    if (total >= kHeaderSize) addr = mmap(nullptr, total, PROT_READ, MAP_SHARED, fd, 0);
+    const auto* header = static_cast<const SegmentHeader*>(addr);
+
+    // Segment is still being written, or was abandoned.
+
+    if (addr == MAP_FAILED || loadReady(header) != kReady) {
+      if (addr != MAP_FAILED) munmap(addr, total);
+      if (isStale(fd, st)) {
+        mf::LogWarning("DBSharedCache") << "Removing stale shared memory segment " << name << "\n";
+        shm_unlink(name.c_str());
+      }
+      close(fd);
+      return false;
+    }
+
+    // Refresh modification time for LRU bookkeeping.
+
+    futimens(fd, nullptr);
+    close(fd);
+
+    // View dataset in place.  The mapping is released when the last dataset
+    // (or copy thereof) referring to it is destroyed.
+
+    std::shared_ptr<const void> keepalive(
+      addr, [total](const void* p) { munmap(const_cast<void*>(p), total); });
+    try {
+      if (header->size > total - kHeaderSize)
+        throw cet::exception("DBSharedCache") << "Segment too small.\n";
+      DBDataset result = ViewDatasetImage(
+        static_cast<const char*>(addr) + kHeaderSize, header->size, std::move(keepalive));
+      if (result.beginTime() != begin_time)
+        throw cet::exception("DBSharedCache") << "IOV mismatch.\n";
+      data = std::move(result);
+    }
+    catch (cet::exception& e) {
+      mf::LogWarning("DBSharedCache")
+        << "Ignoring corrupt shared memory segment " << name << ": " << e.what();
+      return false;
+    }
+    return true;
+  }
+
+  // Store payload.
+
+  void DBSharedCache::Store(const DBDataset& data) const
+  {
+    if (data.endTime() == IOVTimeStamp::MaxTimeStamp()) return;
+
+    size_t image_size = DatasetImageSize(data);
+    size_t total = kHeaderSize + image_size;
+    if (total > fMaxBytes) return;
+    Evict(total);
+
+    // Create segment exclusively.  If it already exists, another process
+    // has stored (or is storing) this IOV.  Lock it until it is ready.
+
+    std::string name = SegmentName(data.beginTime());
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+      if (errno != EEXIST) {
+        mf::LogWarning("DBSharedCache") << "Unable to create shared memory segment " << name
+                                        << ": " << std::strerror(errno) << "\n";
+      }
+      return;
+    }
+    flock(fd, LOCK_EX);
+
+    // Allocate the memory up front, so that a full /dev/shm is reported here
+    // rather than by a bus error while writing.
+
+    void* addr = MAP_FAILED;
+    int err = posix_fallocate(fd, 0, total);
+    if (err == 0)
+      addr = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    else
+      errno = err;
+    if (addr == MAP_FAILED) {
+      mf::LogWarning("DBSharedCache") << "Unable to map shared memory segment " << name << ": "
+                                      << std::strerror(errno) << "\n";
+      shm_unlink(name.c_str());
+      close(fd);
+      return;
+    }
+
+    auto* header = static_cast<SegmentHeader*>(addr);
+    header->size = image_size;
+    try {
+      WriteDatasetImage(data, static_cast<char*>(addr) + kHeaderSize, image_size);
+    }
+    catch (cet::exception& e) {
+      mf::LogWarning("DBSharedCache")
+        << "Unable to write shared memory segment " << name << ": " << e.what();
+      shm_unlink(name.c_str());
+      munmap(addr, total);
+      close(fd);
+      return;
+    }
+    std::atomic_ref<std::uint32_t>(header->ready).store(kReady, std::memory_order_release);
+    munmap(addr, total);
+    close(fd); // Releases the lock.
+  }
+
+  // Remove least recently used segments.
+
+  void DBSharedCache::Evict(std::uint64_t needed) const
+  {
+    namespace fs = std::filesystem;
+
+    // Collect all segments of all folders (with the same segment prefix).
+
+    std::vector<std::tuple<fs::file_time_type, std::uint64_t, std::string>> segments;
+    std::uint64_t total = 0;
+    std::error_code ec;
+    for (fs::directory_iterator it(kShmDir, ec), end; !ec && it != end; it.increment(ec)) {
+      std::string name = it->path().filename().string();
+      if (name.compare(0, fSegmentPrefix.size(), fSegmentPrefix) != 0) continue;
+      std::error_code fec;
+      auto mtime = it->last_write_time(fec);
+      std::uint64_t size = fec ? 0 : it->file_size(fec);
+      if (fec) continue;
+      segments.emplace_back(mtime, size, "/" + name);
+      total += size;
+    }
+    if (total + needed <= fMaxBytes) return;
+
+    // Remove oldest segments first.
+
+    std::sort(segments.begin(), segments.end());
+    for (const auto& [mtime, size, name] : segments) {
+      if (total + needed <= fMaxBytes) break;
+      if (shm_unlink(name.c_str()) == 0) total -= size;
+    }
+  }
+}
@@ -0,0 +1,97 @@
+#ifndef DBSHAREDCACHE_H
+#define DBSHAREDCACHE_H
+//=================================================================================
+//
+// Name: DBSharedCache.h
+//
+// Purpose: Header for class DBSharedCache.
+//          This class implements a node-wide cache of DBDataset payloads in POSIX
+//          shared memory, so that many art processes running on the same node
+//          hold a single copy of each IOV in memory, and fetch it only once.
+//
+//          Each IOV is stored in its own shared memory segment, which contains
+//          a small header followed by a DBDataset image (see DBDatasetImage.h).
+//          Segments are named after a hash of (url, folder, tag) and the IOV
+//          begin time:
+//
+//          /lariov-<hash of url, folder and tag>-<begin time>
+//
+//          The "lariov-" prefix can be changed (e.g. to isolate tests); segments
+//          with the same prefix share the size limit.
+//
+//          The first process that needs an IOV creates the segment (exclusively),
+//          writes the image, and then marks the segment ready.  Other processes
+//          map ready segments read-only, and view the dataset in place, without
+//          copying or parsing column data.  The creator holds an exclusive flock
+//          on the segment until it is ready, and the kernel releases the lock if
+//          the creator dies, so a segment that is neither ready nor locked was
+//          abandoned, and is removed.  A segment whose image could not be
+//          written is removed by its creator at once.
+//
+//          Since segments are looked up by IOV begin time, the IOV containing a
+//          requested time must be known before the cache can be consulted, which
+//          requires an IOV index (see DBFolder::LoadIOVIndex).
+//
+//          Open-ended IOVs (end time = infinity) are never cached, because the
+//          validity range of such payloads changes when new IOVs are added.
+//
+//          Segments persist after all processes exit, so that later jobs on the
+//          same node can use them.  The total size of the segments of all folders
+//          is bounded: every cache hit refreshes the modification time of the
+//          segment, and the least recently used segments are removed whenever a
+//          store would exceed the limit.  Processes that have a removed segment
+//          mapped keep using it.  Segments are enumerated in /dev/shm, where
+//          Linux keeps POSIX shared memory.
+//
+// Created: 18-Oct-2026
+//
+//=================================================================================
+
+#include "larevt/CalibrationDBI/IOVData/IOVTimeStamp.h"
+#include "larevt/CalibrationDBI/Providers/DBDataset.h"
+#include <cstdint>
+#include <string>
+
+namespace lariov {
+  class DBSharedCache {
+
+  public:
+    // Constructor.
+
+    DBSharedCache(const std::string& url,    // Database url.
+                  const std::string& folder, // Folder name.
+                  const std::string& tag,    // Folder tag.
+                  std::uint64_t max_bytes,   // Maximum total size of all segments.
+                  const std::string& segment_prefix = "lariov-"); // Name prefix of all segments.
+
+    // Accessors.
+
+    const std::string& Prefix() const { return fPrefix; }
+    std::uint64_t MaxBytes() const { return fMaxBytes; }
+    std::string SegmentName(const IOVTimeStamp& begin_time) const;
+
+    // Look up the payload of the IOV beginning at the specified time.
+    // Return true and fill data (which then refers to the shared segment) if found.
+
+    bool Find(const IOVTimeStamp& begin_time, DBDataset& data) const;
+
+    // Store payload (does nothing for open-ended IOVs, or if another process
+    // has already created the segment).
+
+    void Store(const DBDataset& data) const;
+
+  private:
+    // Remove least recently used segments (of all folders) until there is
+    // enough room for a new segment of the specified size.
+
+    void Evict(std::uint64_t needed) const;
+
+    // Data members.
+
+    std::string fSegmentPrefix; // Name prefix of all segments (evicted together).
+    std::string fPrefix;        // Segment name prefix for this (url, folder, tag).
+    std::uint64_t fMaxBytes;
+  };
+}
+
+#endif
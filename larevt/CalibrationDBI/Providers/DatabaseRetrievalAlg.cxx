@@ -1,8 +1,11 @@
 #include "fhiclcpp/ParameterSet.h"
 #include "larevt/CalibrationDBI/Providers/DBFolder.h"
+#include "larevt/CalibrationDBI/Providers/DBFolderRegistry.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
 
 #include "DatabaseRetrievalAlg.h"
 
+#include <sstream>
 #include <string>
 
 namespace lariov {
@@ -10,6 +13,8 @@ namespace lariov {
   /// Configure using fhicl::ParameterSet
   void DatabaseRetrievalAlg::Reconfigure(fhicl::ParameterSet const& p)
   {
+    if (fWarmUpRegistered) DBFolderRegistry::Instance().Unregister(fFolder.get());
+    fWarmUpRegistered = false;
 
     std::string foldername = p.get<std::string>("DBFolderName");
     std::string url = p.get<std::string>("DBUrl");
@@ -18,5 +23,68 @@ namespace lariov {
     bool usesqlite = p.get<bool>("UseSQLite", false);
     bool testmode = p.get<bool>("TestMode", false);
     fFolder.reset(new DBFolder(foldername, url, url2, tag, usesqlite, testmode));
+    fFolder->SetCompareTolerance(p.get<double>("TestModeTolerance", 1.e-9));
+
+    std::string cachedir = p.get<std::string>("DiskCacheDir", "");
+    unsigned long cachesize = p.get<unsigned long>("DiskCacheMaxSize", 1024); // MB
+    fFolder->SetDiskCache(cachedir, cachesize * 1024 * 1024);
+    fFolder->SetIOVCacheSize(p.get<unsigned int>("IOVCacheSize", 0));
+    fFolder->SetPrefetch(p.get<unsigned int>("PrefetchMaxInFlight", 0));
+    fFolder->SetRetries(p.get<unsigned int>("Retries", 0), p.get<double>("RetryBackoff", 1.));
+    fFolder->SetHedging(p.get<double>("HedgePercentile", 0.),
+                        p.get<double>("HedgeInitialDelay", 1.));
+    if (p.get<bool>("LoadIOVIndex", false)) fFolder->LoadIOVIndex();
+    unsigned long shmsize = p.get<unsigned long>("SharedMemoryCacheMaxSize", 1024); // MB
+    fFolder->SetSharedMemoryCache(p.get<bool>("SharedMemoryCache", false), shmsize * 1024 * 1024);
+    fConcurrentWarmUp = p.get<bool>("ConcurrentWarmUp", false);
+    fPrintMetrics = p.get<bool>("PrintMetrics", false);
+    this->ResolveMetrics();
+  }
+
+  /// Look up metrics of this folder
+  void DatabaseRetrievalAlg::ResolveMetrics()
+  {
+    DBMetrics& metrics = DBMetrics::Instance();
+    fUpdateMetrics.rebuild_time = &metrics.GetHistogram(FolderName(), "rebuild_time");
+    fUpdateMetrics.lock_wait = &metrics.GetHistogram(FolderName(), "lock_wait");
+    fUpdateMetrics.rows_touched = &metrics.GetCounter(FolderName(), "rows_touched");
+  }
+
+  /// Destructor
+  DatabaseRetrievalAlg::~DatabaseRetrievalAlg()
+  {
+    if (fWarmUpRegistered) DBFolderRegistry::Instance().Unregister(fFolder.get());
+    if (fPrintMetrics && fFolder) {
+      std::ostringstream out;
+      DBMetrics::Instance().Print(out, FolderName());
+      mf::LogInfo("DatabaseRetrievalAlg")
+        << "Conditions access metrics for folder " << FolderName() << ":\n"
+        << out.str();
+    }
+  }
+
+  /// Register folder for concurrent warm-up
+  void DatabaseRetrievalAlg::RegisterWarmUp()
+  {
+    if (!fConcurrentWarmUp || fWarmUpRegistered) return;
+    DBFolderRegistry::Instance().Register(fFolder.get(), &fUpdateMutex);
+    fWarmUpRegistered = true;
+  }
+
+  /// Lock for provider data refresh
+  std::unique_lock<std::mutex> DatabaseRetrievalAlg::LockForUpdate() const
+  {
+    std::unique_lock<std::mutex> lock(fUpdateMutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+      DBMetrics::ScopedTimer timer(*fUpdateMetrics.lock_wait);
+      lock.lock();
+    }
+    return lock;
+  }
+
+  /// Update all registered folders
+  void DatabaseRetrievalAlg::WarmUp(DBTimeStamp_t ts)
+  {
+    if (fWarmUpRegistered) DBFolderRegistry::Instance().WarmUp(ts);
   }
 }
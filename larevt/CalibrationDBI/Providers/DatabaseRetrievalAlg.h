@@ -15,7 +15,13 @@
 #define DATABASERETRIEVALALG_H
 
 #include "DBFolder.h"
+#include "DBMetrics.h"
+#include "larevt/CalibrationDBI/IOVData/Snapshot.h"
+#include "larevt/CalibrationDBI/IOVData/TimeStampDecoder.h"
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace fhicl {
   class ParameterSet;
@@ -29,6 +35,51 @@ namespace lariov {
      \class DatabaseRetrievalAlg
      User defined class DatabaseRetrievalAlg ... these comments are used to generate
      doxygen documentation!
+
+     Configuration parameters
+     =========================
+
+     - *DBFolderName* (string, mandatory): name of the database folder
+     - *DBUrl* (string, mandatory): url of the conditions database server
+     - *DBUrl2* (string, default: ""): url of a secondary server
+     - *DBTag* (string, default: ""): folder tag
+     - *UseSQLite* (boolean, default: false): read from <DBFolderName>.db
+       found in FW_SEARCH_PATH instead of the server
+     - *TestMode* (boolean, default: false): compare data from all sources
+     - *TestModeTolerance* (real, default: 1e-9): relative tolerance used to
+       compare real values in test mode
+     - *DiskCacheDir* (string, default: ""): node-local directory used to
+       cache payloads downloaded from the server; see lariov::DBDiskCache
+     - *DiskCacheMaxSize* (integer, default: 1024): maximum size of the
+       payload cache directory, in MB
+     - *IOVCacheSize* (integer, default: 0): number of recently used IOVs kept
+       in memory in addition to the current one
+     - *PrefetchMaxInFlight* (integer, default: 0): if nonzero, the IOV
+       following the current one is requested in the background, with at most
+       this many outstanding requests
+     - *LoadIOVIndex* (boolean, default: false): load the list of all IOVs of
+       the folder and tag at configuration time, and resolve event times to
+       IOVs locally
+     - *SharedMemoryCache* (boolean, default: false): share datasets with
+       other processes on the same node via POSIX shared memory (implies
+       LoadIOVIndex); see lariov::DBSharedCache
+     - *SharedMemoryCacheMaxSize* (integer, default: 1024): maximum total size
+       of the shared memory segments of all folders, in MB
+     - *Retries* (integer, default: 0): number of times a failed http request
+       is retried, with exponential backoff and jitter
+     - *RetryBackoff* (real, default: 1.0): delay before the first retry, in
+       seconds (doubled for each following retry)
+     - *HedgePercentile* (real, default: 0): if nonzero, a request that the
+       primary server has not answered within this percentile (e.g. 0.95) of
+       recent response times, or that failed, is also sent to DBUrl2, and the
+       first answer is used
+     - *HedgeInitialDelay* (real, default: 1.0): hedging delay in seconds,
+       used until enough response times have been measured
+     - *ConcurrentWarmUp* (boolean, default: false): update this folder
+       together with all other folders configured the same way, concurrently,
+       when a new event time is set; see lariov::DBFolderRegistry
+     - *PrintMetrics* (boolean, default: false): print the conditions access
+       metrics of this folder at the end of the job; see lariov::DBMetrics
   */
   class DatabaseRetrievalAlg {
 
@@ -41,12 +92,14 @@ namespace lariov {
                          bool usesqlite = false,
                          bool testmode = false)
       : fFolder(new DBFolder(foldername, url, url2, tag, usesqlite, testmode))
-    {}
+    {
+      this->ResolveMetrics();
+    }
 
     DatabaseRetrievalAlg(fhicl::ParameterSet const& p) { this->Reconfigure(p); }
 
-    /// Default destructor
-    virtual ~DatabaseRetrievalAlg() {}
+    /// Destructor (unregisters folder from concurrent warm-up)
+    virtual ~DatabaseRetrievalAlg();
 
     /// Configure using fhicl::ParameterSet
     virtual void Reconfigure(fhicl::ParameterSet const& p);
@@ -63,9 +116,219 @@ namespace lariov {
     const IOVTimeStamp& Begin() const { return fFolder->CachedStart(); }
     const IOVTimeStamp& End() const { return fFolder->CachedEnd(); }
 
+    /// Get content fingerprint of cached data (see DBDataset::fingerprint)
+    std::uint64_t Fingerprint() const { return fFolder->CachedFingerprint(); }
+
+    /// Get number of updates of cached data (see DBFolder::Generation)
+    unsigned long Generation() const { return fFolder->Generation(); }
+
+    /// Update all folders registered for concurrent warm-up (if this one is)
+    void WarmUp(DBTimeStamp_t ts);
+
   protected:
+    /// Register folder for concurrent warm-up, if enabled by ConcurrentWarmUp.
+    /// Called by providers that read from the database.
+    void RegisterWarmUp();
+
+    /// Lock held by the thread refreshing provider data in DBUpdate.  Time spent
+    /// waiting for it is recorded (only if contended).
+    std::unique_lock<std::mutex> LockForUpdate() const;
+
+    /// Number of recently published snapshots kept by providers, so that events
+    /// of different IOVs processed concurrently share them instead of rebuilding
+    static constexpr size_t kRecentSnapshots = 16;
+
+    /// Provider data built from the folder (see below)
+    template <class T, class Data = Snapshot<T>>
+    class PublishedSnapshots;
+
+    /// Metrics recorded by providers in DBUpdate (see DBMetrics)
+    struct UpdateMetrics {
+      DBMetrics::Histogram* rebuild_time = nullptr; ///< Snapshot rebuild time (us)
+      DBMetrics::Histogram* lock_wait = nullptr;    ///< Contended update mutex wait (us)
+      DBMetrics::Counter* rows_touched = nullptr;   ///< Snapshot rows (re)built
+    };
+
     std::unique_ptr<DBFolder> fFolder;
+    bool fConcurrentWarmUp = false; // Warm-up enabled by configuration.
+    bool fWarmUpRegistered = false; // Folder is registered.
+    bool fPrintMetrics = false;     // Print metrics in destructor.
+    UpdateMetrics fUpdateMetrics;
+
+  private:
+    void ResolveMetrics();
+
+    mutable std::mutex fUpdateMutex; // See LockForUpdate.
+  };
+
+  /**
+     \class DatabaseRetrievalAlg::PublishedSnapshots
+     Data of a provider (a Snapshot<T>, or a class derived from it), built from
+     the folder dataset of the provider.
+
+     The current data are published for the legacy accessors, together with the
+     time stamp they are current for.  Readers do not lock unless the time stamp
+     changed, and then only one thread updates the data while the others wait.
+
+     Published data are never modified: when the folder moves to another IOV,
+     new data are built aside.  If the payload did not change (same fingerprint),
+     only the validity range is updated; if the folder lists the rows that changed
+     since the data were built (see DBFolder::ChangedRows), only those are patched
+     in a copy; otherwise the data are rebuilt in one pass.  The data of the most
+     recent IOVs are kept alive (see kRecentSnapshots), so that references
+     obtained from them remain valid, and so that events of their IOVs share them.
+
+     Rows are made by the row maker, which is called with the folder once per
+     rebuild to bind its columns, and returns the function that makes the row of
+     one dataset row number.  If Data has members Rebuilt() and RowChanged(row),
+     they are called after a rebuild and for each patched row, so that contents
+     derived from the rows can be kept in sync.
+  */
+  template <class T, class Data>
+  class DatabaseRetrievalAlg::PublishedSnapshots {
+
+  public:
+    using DataPtr = std::shared_ptr<const Data>;
+
+    explicit PublishedSnapshots(DatabaseRetrievalAlg& alg) : fAlg(alg) {}
+
+    /// Start over from configured data, which are updated from the folder if use_folder
+    void Reset(DataPtr data, bool use_folder);
+
+    /// Data up to date for time stamp ts, published for the legacy accessors.
+    /// Sets updated (if not null) to whether the published data changed.
+    template <class RowMaker>
+    DataPtr Current(DBTimeStamp_t ts, RowMaker&& rowMaker, bool* updated = nullptr);
+
+    /// Data valid at time stamp ts (current, recent, or loaded); the published
+    /// data are not changed.
+    template <class RowMaker>
+    DataPtr For(DBTimeStamp_t ts, RowMaker&& rowMaker);
+
+    /// Number of rows built or patched so far
+    unsigned long RowsTouched() const { return fRowsTouched; }
+
+  private:
+    // Published data and the time stamp they are current for, swapped as a
+    // whole so that lock-free readers never pair a time stamp with other data.
+    struct Published {
+      DBTimeStamp_t ts;
+      DataPtr data;
+    };
+
+    /// Update the folder and return the data of its dataset (update lock held)
+    template <class RowMaker>
+    DataPtr Load(DBTimeStamp_t ts, RowMaker& rowMaker);
+
+    DatabaseRetrievalAlg& fAlg;
+    bool fUseFolder = false;
+    std::atomic<std::shared_ptr<const Published>> fPublished;
+    DataPtr fLastData;                 // Built from the folder dataset.
+    std::vector<DataPtr> fRecentData;  // Newest last.
+    std::uint64_t fFingerprint = 0;    // Fingerprint of fLastData.
+    unsigned long fGeneration = 0;     // Folder generation of fLastData.
+    unsigned long fRowsTouched = 0;
   };
+
+  template <class T, class Data>
+  void DatabaseRetrievalAlg::PublishedSnapshots<T, Data>::Reset(DataPtr data, bool use_folder)
+  {
+    fUseFolder = use_folder;
+    fFingerprint = 0;
+    fGeneration = 0;
+    fRecentData.clear();
+    fLastData = data;
+    fPublished.store(std::make_shared<const Published>(Published{0, std::move(data)}));
+  }
+
+  template <class T, class Data>
+  template <class RowMaker>
+  auto DatabaseRetrievalAlg::PublishedSnapshots<T, Data>::Current(DBTimeStamp_t ts,
+                                                                  RowMaker&& rowMaker,
+                                                                  bool* updated) -> DataPtr
+  {
+    std::shared_ptr<const Published> published = fPublished.load();
+    if (!fUseFolder || ts == published->ts) return published->data;
+
+    auto lock = fAlg.LockForUpdate();
+    published = fPublished.load();
+    if (ts == published->ts) return published->data;
+    DataPtr data = Load(ts, rowMaker);
+    if (updated) *updated = (data != published->data);
+    fPublished.store(std::make_shared<const Published>(Published{ts, data}));
+    return data;
+  }
+
+  template <class T, class Data>
+  template <class RowMaker>
+  auto DatabaseRetrievalAlg::PublishedSnapshots<T, Data>::For(DBTimeStamp_t ts,
+                                                              RowMaker&& rowMaker) -> DataPtr
+  {
+    DataPtr data = fPublished.load()->data;
+    if (!fUseFolder) return data;
+
+    IOVTimeStamp const iov_ts = TimeStampDecoder::DecodeTimeStamp(ts);
+    if (data && data->IsValid(iov_ts)) return data;
+
+    auto lock = fAlg.LockForUpdate();
+    for (auto it = fRecentData.rbegin(); it != fRecentData.rend(); ++it)
+      if ((*it)->IsValid(iov_ts)) return *it;
+    return Load(ts, rowMaker);
+  }
+
+  template <class T, class Data>
+  template <class RowMaker>
+  auto DatabaseRetrievalAlg::PublishedSnapshots<T, Data>::Load(DBTimeStamp_t ts,
+                                                               RowMaker& rowMaker) -> DataPtr
+  {
+    // The folder may also have been updated by a concurrent warm-up (see
+    // DBFolderRegistry), so look for any update since the data were built.
+
+    fAlg.UpdateFolder(ts);
+    if (fAlg.Generation() == fGeneration) return fLastData;
+    fGeneration = fAlg.Generation();
+
+    std::shared_ptr<Data> data;
+    const DBFolder& folder = *fAlg.fFolder;
+    if (fAlg.Fingerprint() == fFingerprint) {
+      // Same payload, only the validity range changed.
+      data = std::make_shared<Data>(*fLastData);
+    }
+    else {
+      DBMetrics::ScopedTimer timer(*fAlg.fUpdateMetrics.rebuild_time);
+      auto makeRow = rowMaker(folder);
+      size_t touched = 0;
+      if (folder.HasChangedRows() && folder.PreviousFingerprint() == fFingerprint) {
+        // The data hold the previous dataset, so only patch the rows that changed.
+        data = std::make_shared<Data>(*fLastData);
+        for (size_t i : folder.ChangedRows()) {
+          T const row = makeRow(i);
+          data->AddOrReplaceRow(row);
+          if constexpr (requires { data->RowChanged(row); }) data->RowChanged(row);
+        }
+        data->UpdateIndex(); // Before the data are shared.
+        touched = folder.ChangedRows().size();
+      }
+      else {
+        data = std::make_shared<Data>();
+        typename Snapshot<T>::Builder builder;
+        touched = folder.Channels().size();
+        builder.Reserve(touched);
+        for (size_t i = 0; i < touched; ++i)
+          builder.Append(makeRow(i));
+        builder.Finalize(*data);
+        if constexpr (requires { data->Rebuilt(); }) data->Rebuilt();
+      }
+      fRowsTouched += touched;
+      fAlg.fUpdateMetrics.rows_touched->Add(touched);
+      fFingerprint = fAlg.Fingerprint();
+    }
+    data->SetIoV(fAlg.Begin(), fAlg.End());
+    fLastData = std::move(data);
+    fRecentData.push_back(fLastData);
+    if (fRecentData.size() > kRecentSnapshots) fRecentData.erase(fRecentData.begin());
+    return fLastData;
+  }
 }
 
 #endif
@@ -10,6 +10,7 @@
 #include "larcoreobj/SimpleTypesAndConstants/geo_types.h" // for kCollection
 #include "larevt/CalibrationDBI/IOVData/IOVDataError.h"   // for IOVDataE...
 #include "larevt/CalibrationDBI/IOVData/IOVTimeStamp.h"   // for IOVTimeS...
+#include "larevt/CalibrationDBI/IOVData/TimeStampDecoder.h"
 #include "larevt/CalibrationDBI/Providers/DBFolder.h"     // for DBFolder
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
@@ -24,17 +25,19 @@ namespace lariov {
                                                    const std::string& tag /*=""*/)
     : DatabaseRetrievalAlg(foldername, url, tag)
     , fEventTimeStamp(0)
-    , fCurrentTimeStamp(0)
     , fDataSource(DataSource::Database)
   {
-    fData.Clear();
+    auto data = std::make_shared<PedestalData>();
+    data->Clear();
     IOVTimeStamp tmp = IOVTimeStamp::MaxTimeStamp();
     tmp.SetStamp(tmp.Stamp() - 1, tmp.SubStamp());
-    fData.SetIoV(tmp, IOVTimeStamp::MaxTimeStamp());
+    data->SetIoV(tmp, IOVTimeStamp::MaxTimeStamp());
+    fData.Reset(std::move(data), true);
   }
 
   DetPedestalRetrievalAlg::DetPedestalRetrievalAlg(fhicl::ParameterSet const& p)
     : DatabaseRetrievalAlg(p.get<fhicl::ParameterSet>("DatabaseRetrievalAlg"))
+    , fEventTimeStamp(0)
   {
     this->Reconfigure(p);
   }
@@ -42,10 +45,11 @@ namespace lariov {
   void DetPedestalRetrievalAlg::Reconfigure(fhicl::ParameterSet const& p)
   {
     this->DatabaseRetrievalAlg::Reconfigure(p.get<fhicl::ParameterSet>("DatabaseRetrievalAlg"));
-    fData.Clear();
+    auto data = std::make_shared<PedestalData>();
+    data->Clear();
     IOVTimeStamp tmp = IOVTimeStamp::MaxTimeStamp();
     tmp.SetStamp(tmp.Stamp() - 1, tmp.SubStamp());
-    fData.SetIoV(tmp, IOVTimeStamp::MaxTimeStamp());
+    data->SetIoV(tmp, IOVTimeStamp::MaxTimeStamp());
 
     bool UseDB = p.get<bool>("UseDB", false);
     bool UseFile = p.get<bool>("UseFile", false);
@@ -59,6 +63,7 @@ namespace lariov {
       fDataSource = DataSource::File;
     else
       fDataSource = DataSource::Default;
+    if (fDataSource == DataSource::Database) this->RegisterWarmUp();
 
     if (fDataSource == DataSource::Default) {
       std::cout << "Using default pedestal values\n";
@@ -83,20 +88,22 @@ namespace lariov {
       DefaultInd.SetPedRmsErr(default_rms_err);
 
       auto const& wireReadoutGeom = art::ServiceHandle<geo::WireReadout>()->Get();
+      Snapshot<DetPedestal>::Builder builder;
       for (auto const& wid : wireReadoutGeom.Iterate<geo::WireID>()) {
         DBChannelID_t ch = wireReadoutGeom.PlaneWireToChannel(wid);
 
         if (wireReadoutGeom.SignalType(ch) == geo::kCollection) {
           DefaultColl.SetChannel(ch);
-          fData.AddOrReplaceRow(DefaultColl);
+          builder.Append(DefaultColl);
         }
         else if (wireReadoutGeom.SignalType(ch) == geo::kInduction) {
           DefaultInd.SetChannel(ch);
-          fData.AddOrReplaceRow(DefaultInd);
+          builder.Append(DefaultInd);
         }
         else
           throw IOVDataError("Wire type is not collection or induction!");
       }
+      builder.Finalize(*data);
     }
     else if (fDataSource == DataSource::File) {
       cet::search_path sp("FW_SEARCH_PATH");
@@ -109,6 +116,7 @@ namespace lariov {
 
       std::string line;
       DetPedestal dp(0);
+      Snapshot<DetPedestal>::Builder builder;
       while (std::getline(file, line)) {
         size_t current_comma = line.find(',');
         DBChannelID_t ch = (DBChannelID_t)std::stoi(line.substr(0, current_comma));
@@ -131,12 +139,15 @@ namespace lariov {
         dp.SetPedMeanErr(ped_err);
         dp.SetPedRms(rms);
         dp.SetPedRmsErr(rms_err);
-        fData.AddOrReplaceRow(dp);
+        builder.Append(dp);
       }
+      builder.Finalize(*data);
     } // if source from file
     else {
       std::cout << "Using pedestals from conditions database\n";
     }
+    data->Rebuilt();
+    fData.Reset(std::move(data), fDataSource == DataSource::Database);
   }
 
   // This method saves the time stamp of the latest event.
@@ -145,6 +156,7 @@ namespace lariov {
   {
     mf::LogInfo("DetPedestalRetrievalAlg") << "DetPedestalRetrievalAlg::UpdateTimeStamp called.";
     fEventTimeStamp = ts;
+    this->WarmUp(ts);
   }
 
   // Maybe update method cached data (public non-const version).
@@ -162,59 +174,91 @@ namespace lariov {
     return DBUpdate(fEventTimeStamp);
   }
 
-  // Maybe update method cached data (private const version).
-  // This is the function that does the actual work of updating data from database.
+  // Bind column handles (channel order) and make rows of the folder dataset.
 
-  bool DetPedestalRetrievalAlg::DBUpdate(DBTimeStamp_t ts) const
+  auto DetPedestalRetrievalAlg::RowMaker(const DBFolder& folder) const
   {
-    // A static mutex that is shared across all invocations of the function.
-    static std::mutex mutex;
-    std::lock_guard<std::mutex> lock(mutex);
-
-    bool result = false;
-    if (fDataSource == DataSource::Database && ts != fCurrentTimeStamp) {
+    mf::LogInfo("DetPedestalRetrievalAlg")
+      << "DetPedestalRetrievalAlg::DBUpdate called with new timestamp.";
+
+    const std::vector<DBChannelID_t>& channels = folder.Channels();
+    const auto& mean = folder.ResolveColumn(fMeanColumn);
+    const auto& mean_err = folder.ResolveColumn(fMeanErrColumn);
+    const auto& rms = folder.ResolveColumn(fRmsColumn);
+    const auto& rms_err = folder.ResolveColumn(fRmsErrColumn);
+    return [&channels, &mean, &mean_err, &rms, &rms_err](size_t i) {
+      DetPedestal pd(channels[i]);
+      pd.SetPedMean((float)mean[i]);
+      pd.SetPedMeanErr((float)mean_err[i]);
+      pd.SetPedRms((float)rms[i]);
+      pd.SetPedRmsErr((float)rms_err[i]);
+      return pd;
+    };
+  }
 
-      mf::LogInfo("DetPedestalRetrievalAlg")
-        << "DetPedestalRetrievalAlg::DBUpdate called with new timestamp.";
-      fCurrentTimeStamp = ts;
+  // Maybe update method cached data (private const version).
+  // Returns whether the data changed (see CurrentData).
 
-      // Call non-const base class method.
+  bool DetPedestalRetrievalAlg::DBUpdate(DBTimeStamp_t ts) const
+  {
+    bool updated = false;
+    fData.Current(ts, [this](const DBFolder& folder) { return RowMaker(folder); }, &updated);
+    return updated;
+  }
 
-      result = const_cast<DetPedestalRetrievalAlg*>(this)->UpdateFolder(ts);
-      if (result) {
+  // Fill the pedestal table from scratch from the snapshot.
 
-        //DBFolder was updated, so now update the Snapshot
-        fData.Clear();
-        fData.SetIoV(this->Begin(), this->End());
+  void DetPedestalRetrievalAlg::PedestalData::Rebuilt()
+  {
+    size_t const size = NChannels() == 0 ? 0 : Data().back().Channel() + 1;
+    table.mean.assign(size, 0.);
+    table.rms.assign(size, 0.);
+    table.mean_err.assign(size, 0.);
+    table.rms_err.assign(size, 0.);
+    for (const DetPedestal& pd : Data())
+      RowChanged(pd);
+  }
 
-        std::vector<DBChannelID_t> channels;
-        fFolder->GetChannelList(channels);
-        for (auto it = channels.begin(); it != channels.end(); ++it) {
+  void DetPedestalRetrievalAlg::PedestalData::RowChanged(const DetPedestal& pd)
+  {
+    size_t const ch = pd.Channel();
+    if (ch >= table.mean.size()) {
+      table.mean.resize(ch + 1, 0.);
+      table.rms.resize(ch + 1, 0.);
+      table.mean_err.resize(ch + 1, 0.);
+      table.rms_err.resize(ch + 1, 0.);
+    }
+    table.mean[ch] = pd.PedMean();
+    table.rms[ch] = pd.PedRms();
+    table.mean_err[ch] = pd.PedMeanErr();
+    table.rms_err[ch] = pd.PedRmsErr();
+  }
 
-          double mean, mean_err, rms, rms_err;
-          fFolder->GetNamedChannelData(*it, "mean", mean);
-          fFolder->GetNamedChannelData(*it, "mean_err", mean_err);
-          fFolder->GetNamedChannelData(*it, "rms", rms);
-          fFolder->GetNamedChannelData(*it, "rms_err", rms_err);
+  std::shared_ptr<const DetPedestalRetrievalAlg::PedestalData>
+  DetPedestalRetrievalAlg::CurrentData() const
+  {
+    return fData.Current(fEventTimeStamp,
+                         [this](const DBFolder& folder) { return RowMaker(folder); });
+  }
 
-          DetPedestal pd(*it);
-          pd.SetPedMean((float)mean);
-          pd.SetPedMeanErr((float)mean_err);
-          pd.SetPedRms((float)rms);
-          pd.SetPedRmsErr((float)rms_err);
+  // Data for one event time.  Events of the IOV of the current data, or of a
+  // recently published one, share it; otherwise the data are refreshed.
 
-          fData.AddOrReplaceRow(pd);
-        }
-      }
-    }
+  std::shared_ptr<const DetPedestalRetrievalAlg::PedestalData> DetPedestalRetrievalAlg::DataFor(
+    DBTimeStamp_t ts) const
+  {
+    return fData.For(ts, [this](const DBFolder& folder) { return RowMaker(folder); });
+  }
 
-    return result;
+  std::shared_ptr<const DetPedestalRetrievalAlg::Handle> DetPedestalRetrievalAlg::HandleFor(
+    DBTimeStamp_t ts) const
+  {
+    return std::make_shared<const Handle>(DataFor(ts));
   }
 
   const DetPedestal& DetPedestalRetrievalAlg::Pedestal(DBChannelID_t ch) const
   {
-    DBUpdate();
-    return fData.GetRow(ch);
+    return CurrentData()->GetRow(ch);
   }
 
   float DetPedestalRetrievalAlg::PedMean(DBChannelID_t ch) const
@@ -237,4 +281,24 @@ namespace lariov {
     return this->Pedestal(ch).PedRmsErr();
   }
 
+  std::span<const float> DetPedestalRetrievalAlg::PedMeans() const
+  {
+    return CurrentData()->table.mean;
+  }
+
+  std::span<const float> DetPedestalRetrievalAlg::PedRmss() const
+  {
+    return CurrentData()->table.rms;
+  }
+
+  std::span<const float> DetPedestalRetrievalAlg::PedMeanErrs() const
+  {
+    return CurrentData()->table.mean_err;
+  }
+
+  std::span<const float> DetPedestalRetrievalAlg::PedRmsErrs() const
+  {
+    return CurrentData()->table.rms_err;
+  }
+
 } //end namespace lariov
@@ -15,7 +15,11 @@
 #define WEBDBI_DETPEDESTALRETRIEVALALG_H
 
 // C/C++ standard libraries
+#include <atomic>
+#include <memory>
+#include <span>
 #include <string>
+#include <vector>
 
 // LArSoft libraries
 #include "larevt/CalibrationDBI/IOVData/DetPedestal.h"
@@ -54,6 +58,18 @@ namespace lariov {
    *   for all channels returned when /UseDB/ and /UseFile/ parameters are false
    * - *DefaultRmsErr* (real, default: 0.0): error on the RMS value
    *   for all channels returned when /UseDB/ and /UseFile/ parameters are false
+   *
+   * Pedestals are published as immutable data, replaced as a whole when the
+   * IOV changes.  Accessors do not lock unless the event time changed, and
+   * then only one thread refreshes the data while the others wait for it.
+   * References and spans returned by the accessors remain valid while the
+   * data are among the most recently published ones (see kRecentSnapshots).
+   *
+   * The accessors of this class use the time of the most recent event (see
+   * UpdateTimeStamp).  When events of different times are processed
+   * concurrently (e.g. by several art schedules), each event should instead
+   * use its own handle, from HandleFor(event time): handles of events in the
+   * same IOV share the same data, which stay alive as long as a handle does.
    */
   class DetPedestalRetrievalAlg : public DatabaseRetrievalAlg, public DetPedestalProvider {
 
@@ -81,6 +97,12 @@ namespace lariov {
     float PedMeanErr(DBChannelID_t ch) const override;
     float PedRmsErr(DBChannelID_t ch) const override;
 
+    /// Retrieve pedestal information of all channels (arrays indexed by channel)
+    std::span<const float> PedMeans() const override;
+    std::span<const float> PedRmss() const override;
+    std::span<const float> PedMeanErrs() const override;
+    std::span<const float> PedRmsErrs() const override;
+
     //hardcoded information about database folder - useful for debugging cross checks
     static constexpr unsigned int NCOLUMNS = 5;
     static constexpr const char* FIELD_NAMES[NCOLUMNS] = {"channel",
@@ -94,19 +116,97 @@ namespace lariov {
                                                           "float",
                                                           "float"};
 
+    /// Pedestals valid at one event time
+    class Handle;
+
+    /// Pedestals valid at the specified event time (safe with concurrent events)
+    std::shared_ptr<const Handle> HandleFor(DBTimeStamp_t ts) const;
+
+    /// Number of snapshot rows built or patched by database updates so far
+    unsigned long RowsTouched() const { return fData.RowsTouched(); }
+
   private:
     /// Do actual database updates.
 
     bool DBUpdate() const; // Uses current event time.
     bool DBUpdate(DBTimeStamp_t ts) const;
 
+    // Contents of a snapshot as arrays indexed by channel (structure of arrays).
+
+    struct PedestalTable {
+      std::vector<float> mean;
+      std::vector<float> rms;
+      std::vector<float> mean_err;
+      std::vector<float> rms_err;
+    };
+
+    // Pedestal data: snapshot rows, and the table kept in sync with them.
+
+    struct PedestalData : Snapshot<DetPedestal> {
+      PedestalTable table;
+
+      /// Fill the table from scratch from the rows.
+      void Rebuilt();
+
+      /// Update the table row of one channel.
+      void RowChanged(const DetPedestal& pd);
+    };
+
+    /// Row maker of the folder dataset (see PublishedSnapshots).
+    auto RowMaker(const DBFolder& folder) const;
+
+    /// Current data, after a possible update.
+    std::shared_ptr<const PedestalData> CurrentData() const;
+
+    /// Data valid at the specified time (current or recent, or refreshed).
+    std::shared_ptr<const PedestalData> DataFor(DBTimeStamp_t ts) const;
+
     // Time stamps.
 
-    DBTimeStamp_t fEventTimeStamp;           // Most recently seen time stamp.
-    mutable DBTimeStamp_t fCurrentTimeStamp; // Time stamp of cached data.
+    std::atomic<DBTimeStamp_t> fEventTimeStamp; // Most recently seen time stamp.
 
     DataSource::ds fDataSource;
-    mutable Snapshot<DetPedestal> fData;
+
+    mutable PublishedSnapshots<DetPedestal, PedestalData> fData{*this};
+
+    // Database columns (resolved once per folder schema).
+
+    mutable DBFolder::ColumnHandle<double> fMeanColumn{"mean"};
+    mutable DBFolder::ColumnHandle<double> fMeanErrColumn{"mean_err"};
+    mutable DBFolder::ColumnHandle<double> fRmsColumn{"rms"};
+    mutable DBFolder::ColumnHandle<double> fRmsErrColumn{"rms_err"};
+  };
+
+  /**
+   * @brief Pedestals valid at one event time
+   *
+   * Holds the (shared, immutable) pedestal data of the IOV of the event, so
+   * accessors neither lock nor depend on other events.
+   */
+  class DetPedestalRetrievalAlg::Handle : public DetPedestalProvider {
+
+  public:
+    explicit Handle(std::shared_ptr<const PedestalData> data) : fData(std::move(data)) {}
+
+    /// Retrieve pedestal information
+    const DetPedestal& Pedestal(DBChannelID_t ch) const { return fData->GetRow(ch); }
+    float PedMean(DBChannelID_t ch) const override { return Pedestal(ch).PedMean(); }
+    float PedRms(DBChannelID_t ch) const override { return Pedestal(ch).PedRms(); }
+    float PedMeanErr(DBChannelID_t ch) const override { return Pedestal(ch).PedMeanErr(); }
+    float PedRmsErr(DBChannelID_t ch) const override { return Pedestal(ch).PedRmsErr(); }
+
+    /// Retrieve pedestal information of all channels (arrays indexed by channel)
+    std::span<const float> PedMeans() const override { return fData->table.mean; }
+    std::span<const float> PedRmss() const override { return fData->table.rms; }
+    std::span<const float> PedMeanErrs() const override { return fData->table.mean_err; }
+    std::span<const float> PedRmsErrs() const override { return fData->table.rms_err; }
+
+    /// Interval of validity
+    const IOVTimeStamp& Start() const { return fData->Start(); }
+    const IOVTimeStamp& End() const { return fData->End(); }
+
+  private:
+    std::shared_ptr<const PedestalData> fData;
   };
 } //end namespace lariov
 
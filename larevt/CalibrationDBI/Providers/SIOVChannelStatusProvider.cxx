@@ -14,6 +14,7 @@
 #include "fhiclcpp/ParameterSet.h"
 #include "larcore/Geometry/WireReadout.h"
 #include "larevt/CalibrationDBI/IOVData/IOVDataConstants.h"
+#include "larevt/CalibrationDBI/IOVData/TimeStampDecoder.h"
 #include "larevt/CalibrationDBI/Providers/DBFolder.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
@@ -26,7 +27,6 @@ namespace lariov {
   SIOVChannelStatusProvider::SIOVChannelStatusProvider(fhicl::ParameterSet const& pset)
     : DatabaseRetrievalAlg(pset.get<fhicl::ParameterSet>("DatabaseRetrievalAlg"))
     , fEventTimeStamp(0)
-    , fCurrentTimeStamp(0)
     , fDefault(0)
   {
 
@@ -42,10 +42,12 @@ namespace lariov {
       fDataSource = DataSource::File;
     else
       fDataSource = DataSource::Default;
+    if (fDataSource == DataSource::Database) this->RegisterWarmUp();
 
     if (fDataSource == DataSource::Default) {
       mf::LogInfo("SIOVChannelStatusProvider") << "Using default channel status value: " << kGOOD;
       fDefault.SetStatus(kGOOD);
+      fData.Reset(std::make_shared<Snapshot<ChannelStatus>>(), false);
     }
     else if (fDataSource == DataSource::File) {
       cet::search_path sp("FW_SEARCH_PATH");
@@ -59,17 +61,22 @@ namespace lariov {
 
       std::string line;
       ChannelStatus cs(0);
+      auto data = std::make_shared<Snapshot<ChannelStatus>>();
+      Snapshot<ChannelStatus>::Builder builder;
       while (std::getline(file, line)) {
         DBChannelID_t ch = (DBChannelID_t)std::stoi(line.substr(0, line.find(',')));
         int status = std::stoi(line.substr(line.find(',') + 1));
 
         cs.SetChannel(ch);
         cs.SetStatus(ChannelStatus::GetStatusFromInt(status));
-        fData.AddOrReplaceRow(cs);
+        builder.Append(cs);
       }
+      builder.Finalize(*data);
+      fData.Reset(std::move(data), false);
     } // if source from file
     else {
       mf::LogInfo("SIOVChannelStatusProvider") << "Using channel statuses from conditions database";
+      fData.Reset(std::make_shared<Snapshot<ChannelStatus>>(), true);
     }
   }
 
@@ -79,8 +86,10 @@ namespace lariov {
   {
     MF_LOG_DEBUG("SIOVChannelStatusProvider")
       << "SIOVChannelStatusProvider::UpdateTimeStamp called.";
-    fNewNoisy.Clear();
+
+    ClearNoisyChannels();
     fEventTimeStamp = ts;
+    this->WarmUp(ts);
   }
 
   // Maybe update method cached data (public non-const version).
@@ -89,7 +98,7 @@ namespace lariov {
   {
 
     fEventTimeStamp = ts;
-    fNewNoisy.Clear();
+    ClearNoisyChannels();
     return DBUpdate(ts);
   }
 
@@ -100,58 +109,65 @@ namespace lariov {
     return DBUpdate(fEventTimeStamp);
   }
 
-  // Maybe update method cached data (private const version).
-  // This is the function that does the actual work of updating data from database.
+  // Bind column handles (channel order) and make rows of the folder dataset.
 
-  bool SIOVChannelStatusProvider::DBUpdate(DBTimeStamp_t ts) const
+  auto SIOVChannelStatusProvider::RowMaker(const DBFolder& folder) const
   {
+    MF_LOG_DEBUG("SIOVChannelStatusProvider")
+      << "SIOVChannelStatusProvider::DBUpdate called with new timestamp.";
+
+    const std::vector<DBChannelID_t>& channels = folder.Channels();
+    const auto& status = folder.ResolveColumn(fStatusColumn);
+    return [&channels, &status](size_t i) {
+      ChannelStatus cs(channels[i]);
+      cs.SetStatus(ChannelStatus::GetStatusFromInt((int)status[i]));
+      return cs;
+    };
+  }
 
-    // A static mutex that is shared across all invocations of the function.
-    static std::mutex mutex;
-    std::lock_guard<std::mutex> lock(mutex);
-
-    bool result = false;
-    if (fDataSource == DataSource::Database && ts != fCurrentTimeStamp) {
-
-      MF_LOG_DEBUG("SIOVChannelStatusProvider")
-        << "SIOVChannelStatusProvider::DBUpdate called with new timestamp.";
-
-      fCurrentTimeStamp = ts;
-
-      // Call non-const base class method.
+  // Maybe update method cached data (private const version).
+  // Returns whether the data changed (see CurrentData).
 
-      result = const_cast<SIOVChannelStatusProvider*>(this)->UpdateFolder(ts);
-      if (result) {
-        //DBFolder was updated, so now update the Snapshot
-        fData.Clear();
-        fData.SetIoV(this->Begin(), this->End());
+  bool SIOVChannelStatusProvider::DBUpdate(DBTimeStamp_t ts) const
+  {
+    bool updated = false;
+    fData.Current(ts, [this](const DBFolder& folder) { return RowMaker(folder); }, &updated);
+    return updated;
+  }
 
-        std::vector<DBChannelID_t> channels;
-        fFolder->GetChannelList(channels);
-        for (auto it = channels.begin(); it != channels.end(); ++it) {
+  std::shared_ptr<const Snapshot<ChannelStatus>> SIOVChannelStatusProvider::CurrentData() const
+  {
+    return fData.Current(fEventTimeStamp,
+                         [this](const DBFolder& folder) { return RowMaker(folder); });
+  }
 
-          long status;
-          fFolder->GetNamedChannelData(*it, "status", status);
+  // Data for one event time.  Events of the IOV of the current data, or of a
+  // recently published one, share it; otherwise the data are refreshed.
 
-          ChannelStatus cs(*it);
-          cs.SetStatus(ChannelStatus::GetStatusFromInt((int)status));
+  std::shared_ptr<const Snapshot<ChannelStatus>> SIOVChannelStatusProvider::DataFor(
+    DBTimeStamp_t ts) const
+  {
+    return fData.For(ts, [this](const DBFolder& folder) { return RowMaker(folder); });
+  }
 
-          fData.AddOrReplaceRow(cs);
-        }
-      }
-    }
-    return result;
+  //----------------------------------------------------------------------------
+  std::shared_ptr<SIOVChannelStatusProvider::Handle> SIOVChannelStatusProvider::HandleFor(
+    DBTimeStamp_t ts) const
+  {
+    return std::make_shared<Handle>(*this, DataFor(ts));
   }
 
   //----------------------------------------------------------------------------
   const ChannelStatus& SIOVChannelStatusProvider::GetChannelStatus(raw::ChannelID_t ch) const
   {
     if (fDataSource == DataSource::Default) { return fDefault; }
-    DBUpdate();
-    if (fNewNoisy.HasChannel(rawToDBChannel(ch))) { return fNewNoisy.GetRow(rawToDBChannel(ch)); }
-    else {
-      return fData.GetRow(rawToDBChannel(ch));
+    std::shared_ptr<const Snapshot<ChannelStatus>> data = CurrentData();
+    {
+      std::shared_lock<std::shared_mutex> lock(fNoisyMutex);
+      auto noisy = fNewNoisy.find(rawToDBChannel(ch));
+      if (noisy != fNewNoisy.end()) return noisy->second;
     }
+    return data->GetRow(rawToDBChannel(ch));
   }
 
   //----------------------------------------------------------------------------
@@ -208,6 +224,71 @@ namespace lariov {
 
     // for c2: ISO C++17 does not allow 'register' storage class specifier
     //register DBChannelID_t const dbch = rawToDBChannel(ch);
+    DBChannelID_t const dbch = rawToDBChannel(ch);
+    if (!this->IsBad(dbch) && this->IsPresent(dbch)) {
+      ChannelStatus cs(dbch);
+      cs.SetStatus(kNOISY);
+      std::unique_lock<std::shared_mutex> lock(fNoisyMutex);
+      fNewNoisy.insert_or_assign(dbch, cs);
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  void SIOVChannelStatusProvider::ClearNoisyChannels()
+  {
+    std::unique_lock<std::shared_mutex> lock(fNoisyMutex);
+    if (fNewNoisy.empty() && fOldNoisy.empty()) return;
+    fOldNoisy = std::move(fNewNoisy);
+    fNewNoisy.clear();
+  }
+
+  //----------------------------------------------------------------------------
+  const ChannelStatus& SIOVChannelStatusProvider::Handle::GetChannelStatus(
+    raw::ChannelID_t ch) const
+  {
+    if (fProvider.fDataSource == DataSource::Default) { return fProvider.fDefault; }
+    if (fNewNoisy.HasChannel(rawToDBChannel(ch))) { return fNewNoisy.GetRow(rawToDBChannel(ch)); }
+    else {
+      return fData->GetRow(rawToDBChannel(ch));
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  SIOVChannelStatusProvider::ChannelSet_t SIOVChannelStatusProvider::Handle::GetChannelsWithStatus(
+    chStatus status) const
+  {
+    ChannelSet_t retSet;
+    DBChannelID_t maxChannel = art::ServiceHandle<geo::WireReadout const>()->Get().Nchannels() - 1;
+    for (DBChannelID_t ch = 0; ch != maxChannel; ++ch) {
+      if (this->GetChannelStatus(ch).Status() == status) retSet.insert(retSet.end(), ch);
+    }
+    return retSet;
+  }
+
+  //----------------------------------------------------------------------------
+  SIOVChannelStatusProvider::ChannelSet_t SIOVChannelStatusProvider::Handle::GoodChannels() const
+  {
+    return GetChannelsWithStatus(kGOOD);
+  }
+
+  //----------------------------------------------------------------------------
+  SIOVChannelStatusProvider::ChannelSet_t SIOVChannelStatusProvider::Handle::BadChannels() const
+  {
+    ChannelSet_t dead = GetChannelsWithStatus(kDEAD);
+    ChannelSet_t ln = GetChannelsWithStatus(kLOWNOISE);
+    dead.insert(ln.begin(), ln.end());
+    return dead;
+  }
+
+  //----------------------------------------------------------------------------
+  SIOVChannelStatusProvider::ChannelSet_t SIOVChannelStatusProvider::Handle::NoisyChannels() const
+  {
+    return GetChannelsWithStatus(kNOISY);
+  }
+
+  //----------------------------------------------------------------------------
+  void SIOVChannelStatusProvider::Handle::AddNoisyChannel(raw::ChannelID_t ch)
+  {
     DBChannelID_t const dbch = rawToDBChannel(ch);
     if (!this->IsBad(dbch) && this->IsPresent(dbch)) {
       ChannelStatus cs(dbch);
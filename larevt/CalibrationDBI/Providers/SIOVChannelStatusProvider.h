@@ -18,6 +18,12 @@
 #include "larevt/CalibrationDBI/Interface/ChannelStatusProvider.h"
 #include "larevt/CalibrationDBI/Providers/DatabaseRetrievalAlg.h"
 
+// C/C++ standard libraries
+#include <atomic>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+
 // Utility libraries
 namespace fhicl {
   class ParameterSet;
@@ -33,6 +39,11 @@ namespace lariov {
    *
    * LArSoft interface to this class is through the service
    * SIOVChannelStatusService.
+   *
+   * The accessors of this class use the time of the most recent event (see
+   * UpdateTimeStamp).  When events of different times are processed
+   * concurrently, each event should instead use its own handle, from
+   * HandleFor(event time); see DetPedestalRetrievalAlg.
    */
   class SIOVChannelStatusProvider : public DatabaseRetrievalAlg, public ChannelStatusProvider {
 
@@ -114,26 +125,123 @@ namespace lariov {
     /// Converts LArSoft channel ID in the one proper for the DB
     static DBChannelID_t rawToDBChannel(raw::ChannelID_t channel) { return DBChannelID_t(channel); }
 
+    /// Channel statuses valid at one event time
+    class Handle;
+
+    /// Channel statuses valid at the specified event time (safe with concurrent events)
+    std::shared_ptr<Handle> HandleFor(DBTimeStamp_t ts) const;
+
+    /// Number of snapshot rows built or patched by database updates so far
+    unsigned long RowsTouched() const { return fData.RowsTouched(); }
+
   private:
     /// Do actual database updates.
 
     bool DBUpdate() const; // Uses current event time.
     bool DBUpdate(DBTimeStamp_t ts) const;
 
+    /// Row maker of the folder dataset (see PublishedSnapshots).
+    auto RowMaker(const DBFolder& folder) const;
+
+    /// Current snapshot, after a possible update.
+    std::shared_ptr<const Snapshot<ChannelStatus>> CurrentData() const;
+
+    /// Snapshot valid at the specified time (current or recent, or refreshed).
+    std::shared_ptr<const Snapshot<ChannelStatus>> DataFor(DBTimeStamp_t ts) const;
+
     // Time stamps.
 
-    DBTimeStamp_t fEventTimeStamp;           // Most recently seen time stamp.
-    mutable DBTimeStamp_t fCurrentTimeStamp; // Time stamp of cached data.
+    std::atomic<DBTimeStamp_t> fEventTimeStamp; // Most recently seen time stamp.
 
     DataSource::ds fDataSource;
-    mutable Snapshot<ChannelStatus> fData; // Lazily updated once per IOV.
-    Snapshot<ChannelStatus> fNewNoisy;     // Updated once per event.
+
+    mutable PublishedSnapshots<ChannelStatus> fData{*this};
     ChannelStatus fDefault;
 
+    // Noisy channels added for the current event.  Other schedules may read
+    // them while they are changed, so they are guarded; map nodes keep their
+    // address, and the set of the previous event is kept, so that references
+    // obtained from it remain valid until the event after next.
+
+    mutable std::shared_mutex fNoisyMutex;
+    std::map<DBChannelID_t, ChannelStatus> fNewNoisy;
+    std::map<DBChannelID_t, ChannelStatus> fOldNoisy;
+
+    void ClearNoisyChannels();
+
+    // Database columns (resolved once per folder schema).
+
+    mutable DBFolder::ColumnHandle<long> fStatusColumn{"status"};
+
     ChannelSet_t GetChannelsWithStatus(chStatus status) const;
 
   }; // class SIOVChannelStatusProvider
 
+  /** **************************************************************************
+   * @brief Channel statuses valid at one event time
+   *
+   * Holds the (shared, immutable) channel statuses of the IOV of the event,
+   * and the channels found noisy in this event only.
+   */
+  class SIOVChannelStatusProvider::Handle : public ChannelStatusProvider {
+
+  public:
+    Handle(const SIOVChannelStatusProvider& provider,
+           std::shared_ptr<const Snapshot<ChannelStatus>> data)
+      : fProvider(provider), fData(std::move(data))
+    {}
+
+    /// Returns Channel Status
+    const ChannelStatus& GetChannelStatus(raw::ChannelID_t channel) const;
+
+    /// @name Single channel queries
+    /// @{
+    bool IsPresent(raw::ChannelID_t channel) const override
+    {
+      return GetChannelStatus(channel).IsPresent();
+    }
+
+    bool IsBad(raw::ChannelID_t channel) const override
+    {
+      return GetChannelStatus(channel).IsDead() || GetChannelStatus(channel).IsLowNoise() ||
+             !IsPresent(channel);
+    }
+
+    bool IsNoisy(raw::ChannelID_t channel) const override
+    {
+      return GetChannelStatus(channel).IsNoisy();
+    }
+
+    bool IsGood(raw::ChannelID_t channel) const override
+    {
+      return GetChannelStatus(channel).IsGood();
+    }
+    /// @}
+
+    Status_t Status(raw::ChannelID_t channel) const override
+    {
+      return (Status_t)this->GetChannelStatus(channel).Status();
+    }
+
+    /// @name Global channel queries
+    /// @{
+    ChannelSet_t GoodChannels() const override;
+    ChannelSet_t BadChannels() const override;
+    ChannelSet_t NoisyChannels() const override;
+    /// @}
+
+    /// Adds to the list of noisy channels of this event
+    void AddNoisyChannel(raw::ChannelID_t ch);
+
+  private:
+    const SIOVChannelStatusProvider& fProvider; // Default status.
+    std::shared_ptr<const Snapshot<ChannelStatus>> fData;
+    Snapshot<ChannelStatus> fNewNoisy;
+
+    ChannelSet_t GetChannelsWithStatus(chStatus status) const;
+
+  }; // class SIOVChannelStatusProvider::Handle
+
 } // namespace lariov
 
 #endif // SIOVCHANNELSTATUSPROVIDER_H
@@ -4,6 +4,7 @@
 #include "art/Framework/Services/Registry/ServiceHandle.h"
 #include "cetlib_except/exception.h"
 #include "larcore/Geometry/WireReadout.h"
+#include "larevt/CalibrationDBI/IOVData/TimeStampDecoder.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
 #include <fstream>
@@ -14,7 +15,6 @@ namespace lariov {
   SIOVElectronicsCalibProvider::SIOVElectronicsCalibProvider(fhicl::ParameterSet const& p)
     : DatabaseRetrievalAlg(p.get<fhicl::ParameterSet>("DatabaseRetrievalAlg"))
     , fEventTimeStamp(0)
-    , fCurrentTimeStamp(0)
   {
     this->Reconfigure(p);
   }
@@ -23,10 +23,11 @@ namespace lariov {
   {
 
     this->DatabaseRetrievalAlg::Reconfigure(p.get<fhicl::ParameterSet>("DatabaseRetrievalAlg"));
-    fData.Clear();
+    auto data = std::make_shared<Snapshot<ElectronicsCalib>>();
+    data->Clear();
     IOVTimeStamp tmp = IOVTimeStamp::MaxTimeStamp();
     tmp.SetStamp(tmp.Stamp() - 1, tmp.SubStamp());
-    fData.SetIoV(tmp, IOVTimeStamp::MaxTimeStamp());
+    data->SetIoV(tmp, IOVTimeStamp::MaxTimeStamp());
 
     bool UseDB = p.get<bool>("UseDB", false);
     bool UseFile = p.get<bool>("UseFile", false);
@@ -40,6 +41,7 @@ namespace lariov {
       fDataSource = DataSource::File;
     else
       fDataSource = DataSource::Default;
+    if (fDataSource == DataSource::Database) this->RegisterWarmUp();
 
     if (fDataSource == DataSource::Default) {
       float default_gain = p.get<float>("DefaultGain");
@@ -56,11 +58,13 @@ namespace lariov {
       defaultCalib.SetExtraInfo(CalibrationExtraInfo("ElectronicsCalib"));
 
       auto const& wireReadoutGeom = art::ServiceHandle<geo::WireReadout const>()->Get();
+      Snapshot<ElectronicsCalib>::Builder builder;
       for (auto const& wid : wireReadoutGeom.Iterate<geo::WireID>()) {
         DBChannelID_t ch = wireReadoutGeom.PlaneWireToChannel(wid);
         defaultCalib.SetChannel(ch);
-        fData.AddOrReplaceRow(defaultCalib);
+        builder.Append(defaultCalib);
       }
+      builder.Finalize(*data);
     }
     else if (fDataSource == DataSource::File) {
       cet::search_path sp("FW_SEARCH_PATH");
@@ -74,6 +78,7 @@ namespace lariov {
 
       std::string line;
       ElectronicsCalib dp(0);
+      Snapshot<ElectronicsCalib>::Builder builder;
       while (std::getline(file, line)) {
         size_t current_comma = line.find(',');
         DBChannelID_t ch = (DBChannelID_t)std::stoi(line.substr(0, current_comma));
@@ -100,12 +105,14 @@ namespace lariov {
         dp.SetShapingTimeErr(shaping_time_err);
         dp.SetExtraInfo(info);
 
-        fData.AddOrReplaceRow(dp);
+        builder.Append(dp);
       }
+      builder.Finalize(*data);
     }
     else {
       std::cout << "Using electronics calibrations from conditions database" << std::endl;
     }
+    fData.Reset(std::move(data), fDataSource == DataSource::Database);
   }
 
   // This method saves the time stamp of the latest event.
@@ -115,6 +122,7 @@ namespace lariov {
     mf::LogInfo("SIOVElectronicsCalibProvider")
       << "SIOVElectronicsCalibProvider::UpdateTimeStamp called.";
     fEventTimeStamp = ts;
+    this->WarmUp(ts);
   }
 
   // Maybe update method cached data (public non-const version).
@@ -133,58 +141,65 @@ namespace lariov {
     return DBUpdate(fEventTimeStamp);
   }
 
-  // Maybe update method cached data (private const version).
-  // This is the function that does the actual work of updating data from database.
+  // Bind column handles (channel order) and make rows of the folder dataset.
 
-  bool SIOVElectronicsCalibProvider::DBUpdate(DBTimeStamp_t ts) const
+  auto SIOVElectronicsCalibProvider::RowMaker(const DBFolder& folder) const
   {
+    mf::LogInfo("SIOVElectronicsCalibProvider")
+      << "SIOVElectronicsCalibProvider::DBUpdate called with new timestamp.";
+
+    const std::vector<DBChannelID_t>& channels = folder.Channels();
+    const auto& gain = folder.ResolveColumn(fGainColumn);
+    const auto& gain_err = folder.ResolveColumn(fGainErrColumn);
+    const auto& shaping_time = folder.ResolveColumn(fShapingTimeColumn);
+    const auto& shaping_time_err = folder.ResolveColumn(fShapingTimeErrColumn);
+    return [&channels, &gain, &gain_err, &shaping_time, &shaping_time_err](size_t i) {
+      ElectronicsCalib pg(channels[i]);
+      pg.SetGain((float)gain[i]);
+      pg.SetGainErr((float)gain_err[i]);
+      pg.SetShapingTime((float)shaping_time[i]);
+      pg.SetShapingTimeErr((float)shaping_time_err[i]);
+      pg.SetExtraInfo(CalibrationExtraInfo("ElectronicsCalib"));
+      return pg;
+    };
+  }
 
-    bool result = false;
-    if (fDataSource == DataSource::Database && ts != fCurrentTimeStamp) {
-
-      mf::LogInfo("SIOVElectronicsCalibProvider")
-        << "SIOVElectronicsCalibProvider::DBUpdate called with new timestamp.";
-
-      fCurrentTimeStamp = ts;
-
-      // Call non-const base class method.
-
-      result = const_cast<SIOVElectronicsCalibProvider*>(this)->UpdateFolder(ts);
-      if (result) {
-        //DBFolder was updated, so now update the Snapshot
-        fData.Clear();
-        fData.SetIoV(this->Begin(), this->End());
+  // Maybe update method cached data (private const version).
+  // Returns whether the data changed (see CurrentData).
 
-        std::vector<DBChannelID_t> channels;
-        fFolder->GetChannelList(channels);
-        for (auto it = channels.begin(); it != channels.end(); ++it) {
+  bool SIOVElectronicsCalibProvider::DBUpdate(DBTimeStamp_t ts) const
+  {
+    bool updated = false;
+    fData.Current(ts, [this](const DBFolder& folder) { return RowMaker(folder); }, &updated);
+    return updated;
+  }
 
-          double gain, gain_err, shaping_time, shaping_time_err;
-          fFolder->GetNamedChannelData(*it, "gain", gain);
-          fFolder->GetNamedChannelData(*it, "gain_err", gain_err);
-          fFolder->GetNamedChannelData(*it, "shaping_time", shaping_time);
-          fFolder->GetNamedChannelData(*it, "shaping_time_err", shaping_time_err);
+  std::shared_ptr<const Snapshot<ElectronicsCalib>>
+  SIOVElectronicsCalibProvider::CurrentData() const
+  {
+    return fData.Current(fEventTimeStamp,
+                         [this](const DBFolder& folder) { return RowMaker(folder); });
+  }
 
-          ElectronicsCalib pg(*it);
-          pg.SetGain((float)gain);
-          pg.SetGainErr((float)gain_err);
-          pg.SetShapingTime((float)shaping_time);
-          pg.SetShapingTimeErr((float)shaping_time_err);
-          pg.SetExtraInfo(CalibrationExtraInfo("ElectronicsCalib"));
+  // Data for one event time.  Events of the IOV of the current data, or of a
+  // recently published one, share it; otherwise the data are refreshed.
 
-          fData.AddOrReplaceRow(pg);
-        }
-      }
-    }
+  std::shared_ptr<const Snapshot<ElectronicsCalib>> SIOVElectronicsCalibProvider::DataFor(
+    DBTimeStamp_t ts) const
+  {
+    return fData.For(ts, [this](const DBFolder& folder) { return RowMaker(folder); });
+  }
 
-    return result;
+  std::shared_ptr<const SIOVElectronicsCalibProvider::Handle>
+  SIOVElectronicsCalibProvider::HandleFor(DBTimeStamp_t ts) const
+  {
+    return std::make_shared<const Handle>(DataFor(ts));
   }
 
   const ElectronicsCalib& SIOVElectronicsCalibProvider::ElectronicsCalibObject(
     DBChannelID_t ch) const
   {
-    DBUpdate();
-    return fData.GetRow(ch);
+    return CurrentData()->GetRow(ch);
   }
 
   float SIOVElectronicsCalibProvider::Gain(DBChannelID_t ch) const
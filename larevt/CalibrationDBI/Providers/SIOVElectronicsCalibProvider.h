@@ -17,6 +17,9 @@
 #include "larevt/CalibrationDBI/IOVData/Snapshot.h"
 #include "larevt/CalibrationDBI/Interface/ElectronicsCalibProvider.h"
 
+#include <atomic>
+#include <memory>
+
 namespace lariov {
 
   /**
@@ -63,20 +66,77 @@ namespace lariov {
     float ShapingTimeErr(DBChannelID_t ch) const override;
     CalibrationExtraInfo const& ExtraInfo(DBChannelID_t ch) const override;
 
+    /// Electronics calibrations valid at one event time (see DetPedestalRetrievalAlg::Handle)
+    class Handle;
+
+    /// Electronics calibrations valid at the specified event time (safe with concurrent events)
+    std::shared_ptr<const Handle> HandleFor(DBTimeStamp_t ts) const;
+
+    /// Number of snapshot rows built or patched by database updates so far
+    unsigned long RowsTouched() const { return fData.RowsTouched(); }
+
   private:
     /// Do actual database updates.
 
     bool DBUpdate() const; // Uses current event time.
     bool DBUpdate(DBTimeStamp_t ts) const;
 
+    /// Row maker of the folder dataset (see PublishedSnapshots).
+    auto RowMaker(const DBFolder& folder) const;
+
+    /// Current snapshot, after a possible update.
+    std::shared_ptr<const Snapshot<ElectronicsCalib>> CurrentData() const;
+
+    /// Snapshot valid at the specified time (current or recent, or refreshed).
+    std::shared_ptr<const Snapshot<ElectronicsCalib>> DataFor(DBTimeStamp_t ts) const;
+
     // Time stamps.
 
-    DBTimeStamp_t fEventTimeStamp;           // Most recently seen time stamp.
-    mutable DBTimeStamp_t fCurrentTimeStamp; // Time stamp of cached data.
+    std::atomic<DBTimeStamp_t> fEventTimeStamp; // Most recently seen time stamp.
 
     DataSource::ds fDataSource;
 
-    mutable Snapshot<ElectronicsCalib> fData;
+    mutable PublishedSnapshots<ElectronicsCalib> fData{*this};
+
+    // Database columns (resolved once per folder schema).
+
+    mutable DBFolder::ColumnHandle<double> fGainColumn{"gain"};
+    mutable DBFolder::ColumnHandle<double> fGainErrColumn{"gain_err"};
+    mutable DBFolder::ColumnHandle<double> fShapingTimeColumn{"shaping_time"};
+    mutable DBFolder::ColumnHandle<double> fShapingTimeErrColumn{"shaping_time_err"};
+  };
+
+  /// Electronics calibrations valid at one event time, holding the (shared,
+  /// immutable) snapshot of its IOV
+  class SIOVElectronicsCalibProvider::Handle : public ElectronicsCalibProvider {
+
+  public:
+    explicit Handle(std::shared_ptr<const Snapshot<ElectronicsCalib>> data)
+      : fData(std::move(data))
+    {}
+
+    /// Retrieve electronics calibration information
+    const ElectronicsCalib& ElectronicsCalibObject(DBChannelID_t ch) const
+    {
+      return fData->GetRow(ch);
+    }
+    float Gain(DBChannelID_t ch) const override { return ElectronicsCalibObject(ch).Gain(); }
+    float GainErr(DBChannelID_t ch) const override { return ElectronicsCalibObject(ch).GainErr(); }
+    float ShapingTime(DBChannelID_t ch) const override
+    {
+      return ElectronicsCalibObject(ch).ShapingTime();
+    }
+    float ShapingTimeErr(DBChannelID_t ch) const override
+    {
+      return ElectronicsCalibObject(ch).ShapingTimeErr();
+    }
+    CalibrationExtraInfo const& ExtraInfo(DBChannelID_t ch) const override
+    {
+      return ElectronicsCalibObject(ch).ExtraInfo();
+    }
+
+  private:
+    std::shared_ptr<const Snapshot<ElectronicsCalib>> fData;
   };
 } //end namespace lariov
 
@@ -5,6 +5,7 @@
 #include "cetlib_except/exception.h"
 #include "larcore/Geometry/Geometry.h"
 #include "larcore/Geometry/WireReadout.h"
+#include "larevt/CalibrationDBI/IOVData/TimeStampDecoder.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
 #include <fstream>
@@ -15,7 +16,6 @@ namespace lariov {
   SIOVPmtGainProvider::SIOVPmtGainProvider(fhicl::ParameterSet const& p)
     : DatabaseRetrievalAlg(p.get<fhicl::ParameterSet>("DatabaseRetrievalAlg"))
     , fEventTimeStamp(0)
-    , fCurrentTimeStamp(0)
   {
     this->Reconfigure(p);
   }
@@ -24,10 +24,11 @@ namespace lariov {
   {
 
     this->DatabaseRetrievalAlg::Reconfigure(p.get<fhicl::ParameterSet>("DatabaseRetrievalAlg"));
-    fData.Clear();
+    auto data = std::make_shared<Snapshot<PmtGain>>();
+    data->Clear();
     IOVTimeStamp tmp = IOVTimeStamp::MaxTimeStamp();
     tmp.SetStamp(tmp.Stamp() - 1, tmp.SubStamp());
-    fData.SetIoV(tmp, IOVTimeStamp::MaxTimeStamp());
+    data->SetIoV(tmp, IOVTimeStamp::MaxTimeStamp());
 
     bool UseDB = p.get<bool>("UseDB", false);
     bool UseFile = p.get<bool>("UseFile", false);
@@ -41,6 +42,7 @@ namespace lariov {
       fDataSource = DataSource::File;
     else
       fDataSource = DataSource::Default;
+    if (fDataSource == DataSource::Database) this->RegisterWarmUp();
 
     if (fDataSource == DataSource::Default) {
       float default_gain = p.get<float>("DefaultGain");
@@ -54,12 +56,14 @@ namespace lariov {
 
       art::ServiceHandle<geo::Geometry const> geo;
       auto const& wireReadoutGeom = art::ServiceHandle<geo::WireReadout const>()->Get();
+      Snapshot<PmtGain>::Builder builder;
       for (unsigned int od = 0; od != geo->NOpDets(); ++od) {
         if (wireReadoutGeom.IsValidOpChannel(od)) {
           defaultGain.SetChannel(od);
-          fData.AddOrReplaceRow(defaultGain);
+          builder.Append(defaultGain);
         }
       }
+      builder.Finalize(*data);
     }
     else if (fDataSource == DataSource::File) {
       cet::search_path sp("FW_SEARCH_PATH");
@@ -72,6 +76,7 @@ namespace lariov {
 
       std::string line;
       PmtGain dp(0);
+      Snapshot<PmtGain>::Builder builder;
       while (std::getline(file, line)) {
         if (line[0] == '#') continue;
         size_t current_comma = line.find(',');
@@ -89,12 +94,14 @@ namespace lariov {
         dp.SetGainErr(gain_err);
         dp.SetExtraInfo(info);
 
-        fData.AddOrReplaceRow(dp);
+        builder.Append(dp);
       }
+      builder.Finalize(*data);
     }
     else {
       std::cout << "Using pmt gains from conditions database" << std::endl;
     }
+    fData.Reset(std::move(data), fDataSource == DataSource::Database);
   }
 
   // This method saves the time stamp of the latest event.
@@ -103,6 +110,7 @@ namespace lariov {
   {
     mf::LogInfo("SIOVPmtGainProvider") << "SIOVPmtGainProvider::UpdateTimeStamp called.";
     fEventTimeStamp = ts;
+    this->WarmUp(ts);
   }
 
   // Maybe update method cached data (public non-const version).
@@ -121,53 +129,58 @@ namespace lariov {
     return DBUpdate(fEventTimeStamp);
   }
 
-  // Maybe update method cached data (private const version).
-  // This is the function that does the actual work of updating data from database.
+  // Bind column handles (channel order) and make rows of the folder dataset.
 
-  bool SIOVPmtGainProvider::DBUpdate(DBTimeStamp_t ts) const
+  auto SIOVPmtGainProvider::RowMaker(const DBFolder& folder) const
   {
+    mf::LogInfo("SIOVPmtGainProvider")
+      << "SIOVPmtGainProvider::DBUpdate called with new timestamp.";
+
+    const std::vector<DBChannelID_t>& channels = folder.Channels();
+    const auto& gain = folder.ResolveColumn(fGainColumn);
+    const auto& gain_err = folder.ResolveColumn(fGainErrColumn);
+    return [&channels, &gain, &gain_err](size_t i) {
+      PmtGain pg(channels[i]);
+      pg.SetGain((float)gain[i]);
+      pg.SetGainErr((float)gain_err[i]);
+      pg.SetExtraInfo(CalibrationExtraInfo("PmtGain"));
+      return pg;
+    };
+  }
 
-    bool result = false;
-    if (fDataSource == DataSource::Database && ts != fCurrentTimeStamp) {
-
-      mf::LogInfo("SIOVPmtGainProvider")
-        << "SIOVPmtGainProvider::DBUpdate called with new timestamp.";
-
-      fCurrentTimeStamp = ts;
-
-      // Call non-const base class method.
-
-      result = const_cast<SIOVPmtGainProvider*>(this)->UpdateFolder(ts);
-      if (result) {
-        //DBFolder was updated, so now update the Snapshot
-        fData.Clear();
-        fData.SetIoV(this->Begin(), this->End());
+  // Maybe update method cached data (private const version).
+  // Returns whether the data changed (see CurrentData).
 
-        std::vector<DBChannelID_t> channels;
-        fFolder->GetChannelList(channels);
-        for (auto it = channels.begin(); it != channels.end(); ++it) {
+  bool SIOVPmtGainProvider::DBUpdate(DBTimeStamp_t ts) const
+  {
+    bool updated = false;
+    fData.Current(ts, [this](const DBFolder& folder) { return RowMaker(folder); }, &updated);
+    return updated;
+  }
 
-          double gain, gain_err;
-          fFolder->GetNamedChannelData(*it, "gain", gain);
-          fFolder->GetNamedChannelData(*it, "gain_sigma", gain_err);
+  std::shared_ptr<const Snapshot<PmtGain>> SIOVPmtGainProvider::CurrentData() const
+  {
+    return fData.Current(fEventTimeStamp,
+                         [this](const DBFolder& folder) { return RowMaker(folder); });
+  }
 
-          PmtGain pg(*it);
-          pg.SetGain((float)gain);
-          pg.SetGainErr((float)gain_err);
-          pg.SetExtraInfo(CalibrationExtraInfo("PmtGain"));
+  // Data for one event time.  Events of the IOV of the current data, or of a
+  // recently published one, share it; otherwise the data are refreshed.
 
-          fData.AddOrReplaceRow(pg);
-        }
-      }
-    }
+  std::shared_ptr<const Snapshot<PmtGain>> SIOVPmtGainProvider::DataFor(DBTimeStamp_t ts) const
+  {
+    return fData.For(ts, [this](const DBFolder& folder) { return RowMaker(folder); });
+  }
 
-    return result;
+  std::shared_ptr<const SIOVPmtGainProvider::Handle> SIOVPmtGainProvider::HandleFor(
+    DBTimeStamp_t ts) const
+  {
+    return std::make_shared<const Handle>(DataFor(ts));
   }
 
   const PmtGain& SIOVPmtGainProvider::PmtGainObject(DBChannelID_t ch) const
   {
-    DBUpdate();
-    return fData.GetRow(ch);
+    return CurrentData()->GetRow(ch);
   }
 
   float SIOVPmtGainProvider::Gain(DBChannelID_t ch) const
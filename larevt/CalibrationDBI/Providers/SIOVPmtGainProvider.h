@@ -17,6 +17,9 @@
 #include "larevt/CalibrationDBI/IOVData/Snapshot.h"
 #include "larevt/CalibrationDBI/Interface/PmtGainProvider.h"
 
+#include <atomic>
+#include <memory>
+
 namespace lariov {
 
   /**
@@ -56,20 +59,61 @@ namespace lariov {
     float GainErr(DBChannelID_t ch) const override;
     CalibrationExtraInfo const& ExtraInfo(DBChannelID_t ch) const override;
 
+    /// Pmt gains valid at one event time (see DetPedestalRetrievalAlg::Handle)
+    class Handle;
+
+    /// Pmt gains valid at the specified event time (safe with concurrent events)
+    std::shared_ptr<const Handle> HandleFor(DBTimeStamp_t ts) const;
+
+    /// Number of snapshot rows built or patched by database updates so far
+    unsigned long RowsTouched() const { return fData.RowsTouched(); }
+
   private:
     /// Do actual database updates.
 
     bool DBUpdate() const; // Uses current event time.
     bool DBUpdate(DBTimeStamp_t ts) const;
 
+    /// Row maker of the folder dataset (see PublishedSnapshots).
+    auto RowMaker(const DBFolder& folder) const;
+
+    /// Current snapshot, after a possible update.
+    std::shared_ptr<const Snapshot<PmtGain>> CurrentData() const;
+
+    /// Snapshot valid at the specified time (current or recent, or refreshed).
+    std::shared_ptr<const Snapshot<PmtGain>> DataFor(DBTimeStamp_t ts) const;
+
     // Time stamps.
 
-    DBTimeStamp_t fEventTimeStamp;           // Most recently seen time stamp.
-    mutable DBTimeStamp_t fCurrentTimeStamp; // Time stamp of cached data.
+    std::atomic<DBTimeStamp_t> fEventTimeStamp; // Most recently seen time stamp.
 
     DataSource::ds fDataSource;
 
-    mutable Snapshot<PmtGain> fData;
+    mutable PublishedSnapshots<PmtGain> fData{*this};
+
+    // Database columns (resolved once per folder schema).
+
+    mutable DBFolder::ColumnHandle<double> fGainColumn{"gain"};
+    mutable DBFolder::ColumnHandle<double> fGainErrColumn{"gain_sigma"};
+  };
+
+  /// Pmt gains valid at one event time, holding the (shared, immutable) snapshot of its IOV
+  class SIOVPmtGainProvider::Handle : public PmtGainProvider {
+
+  public:
+    explicit Handle(std::shared_ptr<const Snapshot<PmtGain>> data) : fData(std::move(data)) {}
+
+    /// Retrieve gain information
+    const PmtGain& PmtGainObject(DBChannelID_t ch) const { return fData->GetRow(ch); }
+    float Gain(DBChannelID_t ch) const override { return PmtGainObject(ch).Gain(); }
+    float GainErr(DBChannelID_t ch) const override { return PmtGainObject(ch).GainErr(); }
+    CalibrationExtraInfo const& ExtraInfo(DBChannelID_t ch) const override
+    {
+      return PmtGainObject(ch).ExtraInfo();
+    }
+
+  private:
+    std::shared_ptr<const Snapshot<PmtGain>> fData;
   };
 } //end namespace lariov
 
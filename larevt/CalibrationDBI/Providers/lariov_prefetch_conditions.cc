@@ -0,0 +1,333 @@
+//=================================================================================
+//
+// Name: lariov_prefetch_conditions.cc
+//
+// Purpose: Offline conditions prefetch tool.
+//
+//          Downloads every IOV of the specified folders and tag that overlaps a
+//          time (or run) range from the http conditions database server, and
+//          writes one self-contained sqlite database per folder, <folder>.db,
+//          in the layout read by DBFolder with UseSQLite (tables <folder>_iovs,
+//          <folder>_tag_iovs, and <folder>_data).  Placing the output directory
+//          in FW_SEARCH_PATH lets jobs run without network access.  The begin
+//          time of the IOV following the last downloaded one is written as an
+//          IOV without data rows, so that the last IOV keeps its end time.
+//
+//          Optionally, closed IOVs are also written as binary snapshot files
+//          into a payload cache directory (see DBDiskCache), which can be used
+//          with the DiskCacheDir parameter.
+//
+//          IOVs are downloaded in parallel.
+//
+// Usage: lariov_prefetch_conditions --url <url> [options] <folder> [<folder> ...]
+//
+// Options:
+//
+// --url <url>          Database url (mandatory).
+// --tag <tag>          Folder tag (default: none).
+// --begin <time>       Begin of range (seconds since epoch, or run number) (default: 0).
+// --end <time>         End of range (exclusive) (default: infinity).
+// --jobs <n>           Number of parallel downloads (default: 8).
+// --output-dir <dir>   Output directory for sqlite files (default: .).
+// --cache-dir <dir>    Also write binary snapshots into this payload cache directory.
+//
+// Created: 18-Oct-2026
+//
+//=================================================================================
+
+#include "larevt/CalibrationDBI/IOVData/IOVTimeStamp.h"
+#include "larevt/CalibrationDBI/Providers/DBDataset.h"
+#include "larevt/CalibrationDBI/Providers/DBDiskCache.h"
+#include "larevt/CalibrationDBI/Providers/DBFolder.h"
+
+#include "cetlib_except/exception.h"
+#include "sqlite3.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  // Command line options.
+
+  struct Options {
+    std::string url;
+    std::string tag;
+    lariov::IOVTimeStamp begin = lariov::IOVTimeStamp::MinTimeStamp();
+    lariov::IOVTimeStamp end = lariov::IOVTimeStamp::MaxTimeStamp();
+    unsigned int jobs = 8;
+    std::string output_dir = ".";
+    std::string cache_dir;
+    std::vector<std::string> folders;
+  };
+
+  void usage()
+  {
+    std::cerr << "Usage: lariov_prefetch_conditions --url <url> [--tag <tag>] [--begin <time>]"
+                 " [--end <time>]\n"
+                 "                                  [--jobs <n>] [--output-dir <dir>]"
+                 " [--cache-dir <dir>]\n"
+                 "                                  <folder> [<folder> ...]\n";
+  }
+
+  // Parse command line.  Return false if invalid.
+
+  bool parseOptions(int argc, char** argv, Options& opts)
+  {
+    for (int i = 1; i < argc; ++i) {
+      std::string arg = argv[i];
+      bool has_value = i + 1 < argc;
+      if (arg == "--url" && has_value)
+        opts.url = argv[++i];
+      else if (arg == "--tag" && has_value)
+        opts.tag = argv[++i];
+      else if (arg == "--begin" && has_value)
+        opts.begin = lariov::IOVTimeStamp::GetFromString(argv[++i]);
+      else if (arg == "--end" && has_value)
+        opts.end = lariov::IOVTimeStamp::GetFromString(argv[++i]);
+      else if (arg == "--jobs" && has_value)
+        opts.jobs = std::max(1, std::stoi(argv[++i]));
+      else if (arg == "--output-dir" && has_value)
+        opts.output_dir = argv[++i];
+      else if (arg == "--cache-dir" && has_value)
+        opts.cache_dir = argv[++i];
+      else if (!arg.empty() && arg[0] != '-')
+        opts.folders.push_back(arg);
+      else
+        return false;
+    }
+    return !opts.url.empty() && !opts.folders.empty() && opts.begin < opts.end;
+  }
+
+  // Download datasets of the specified IOVs in parallel.
+
+  std::vector<lariov::DBDataset> download(const lariov::DBFolder& folder,
+                                          const std::vector<lariov::IOVTimeStamp>& iovs,
+                                          unsigned int jobs)
+  {
+    std::vector<lariov::DBDataset> result(iovs.size());
+    std::vector<std::exception_ptr> errors(iovs.size());
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+      for (size_t i = next++; i < iovs.size(); i = next++) {
+        try {
+          result[i] = folder.GetIOVData(iovs[i]);
+        }
+        catch (...) {
+          errors[i] = std::current_exception();
+        }
+      }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned int n = 0; n < std::min<size_t>(jobs, iovs.size()); ++n)
+      threads.emplace_back(worker);
+    for (auto& thread : threads)
+      thread.join();
+    for (const auto& error : errors)
+      if (error) std::rethrow_exception(error);
+    return result;
+  }
+
+  // Sqlite helpers.
+
+  void check(sqlite3* db, int rc, const std::string& what)
+  {
+    if (rc != SQLITE_OK && rc != SQLITE_DONE && rc != SQLITE_ROW)
+      throw cet::exception("lariov_prefetch_conditions")
+        << what << " failed: " << sqlite3_errmsg(db) << "\n";
+  }
+
+  void exec(sqlite3* db, const std::string& sql)
+  {
+    check(db, sqlite3_exec(db, sql.c_str(), nullptr, nullptr, nullptr), sql);
+  }
+
+  std::string quote(const std::string& name)
+  {
+    std::string result = "\"";
+    for (char c : name)
+      result += (c == '"') ? std::string("\"\"") : std::string(1, c);
+    return result + "\"";
+  }
+
+  std::string sqliteType(const std::string& type)
+  {
+    switch (lariov::DBDataset::GetColumnKind(type)) {
+    case lariov::DBDataset::kDOUBLE: return "REAL";
+    case lariov::DBDataset::kSTRING: return "TEXT";
+    default: return "INTEGER"; // Integers and booleans.
+    }
+  }
+
+  // Write sqlite database in the layout read by DBFolder.
+  // The database is written to a temporary file and renamed into place.
+
+  void writeSQLite(const std::string& path,
+                   const std::string& folder,
+                   const std::string& tag,
+                   const std::vector<lariov::DBDataset>& datasets,
+                   const lariov::IOVTimeStamp& end_time) // Next IOV begin time, or max.
+  {
+    std::string temp = path + ".tmp";
+    std::filesystem::remove(temp);
+    sqlite3* db = nullptr;
+    if (sqlite3_open(temp.c_str(), &db) != SQLITE_OK) {
+      sqlite3_close(db);
+      throw cet::exception("lariov_prefetch_conditions")
+        << "Unable to create sqlite database " << temp << "\n";
+    }
+    sqlite3_stmt* stmt = nullptr;
+    try {
+      // Schema.  Data columns are taken from the first dataset.
+
+      const auto& first = datasets.front();
+      std::string table_iovs = quote(folder + "_iovs");
+      std::string table_tag_iovs = quote(folder + "_tag_iovs");
+      std::string table_data = quote(folder + "_data");
+      exec(db, "PRAGMA journal_mode=OFF");
+      exec(db, "PRAGMA synchronous=OFF");
+      exec(db, "BEGIN");
+      exec(db, "CREATE TABLE " + table_iovs + "(iov_id INTEGER PRIMARY KEY, begin_time INTEGER)");
+      exec(db, "CREATE TABLE " + table_tag_iovs + "(tag TEXT, iov_id INTEGER)");
+      std::ostringstream create;
+      std::ostringstream insert;
+      create << "CREATE TABLE " << table_data << "(__iov_id INTEGER";
+      insert << "INSERT INTO " << table_data << " VALUES(?1";
+      for (size_t col = 0; col < first.ncols(); ++col) {
+        create << ", " << quote(first.colNames()[col]) << " " << sqliteType(first.colTypes()[col]);
+        insert << ", ?" << col + 2;
+      }
+      create << ")";
+      insert << ")";
+      exec(db, create.str());
+
+      // IOVs, followed by a terminating IOV without data (unless open-ended).
+
+      std::vector<unsigned long> begin_times;
+      for (const auto& data : datasets)
+        begin_times.push_back(data.beginTime().Stamp());
+      if (end_time != lariov::IOVTimeStamp::MaxTimeStamp()) begin_times.push_back(end_time.Stamp());
+      for (size_t iov = 0; iov < begin_times.size(); ++iov) {
+        std::ostringstream sql;
+        sql << "INSERT INTO " << table_iovs << " VALUES(" << iov + 1 << ", " << begin_times[iov]
+            << ")";
+        exec(db, sql.str());
+        sql.str("");
+        sql << "INSERT INTO " << table_tag_iovs << " VALUES(?1, " << iov + 1 << ")";
+        check(db, sqlite3_prepare_v2(db, sql.str().c_str(), -1, &stmt, nullptr), sql.str());
+        sqlite3_bind_text(stmt, 1, tag.c_str(), -1, SQLITE_TRANSIENT);
+        check(db, sqlite3_step(stmt), sql.str());
+        sqlite3_finalize(stmt);
+        stmt = nullptr;
+      }
+
+      // Data.
+
+      check(db, sqlite3_prepare_v2(db, insert.str().c_str(), -1, &stmt, nullptr), insert.str());
+      for (size_t iov = 0; iov < datasets.size(); ++iov) {
+        const auto& data = datasets[iov];
+        if (data.colNames() != first.colNames() || data.colTypes() != first.colTypes()) {
+          throw cet::exception("lariov_prefetch_conditions")
+            << "Schema of folder " << folder << " changes at IOV " << data.beginTime().DBStamp()
+            << ", which can't be represented in one sqlite table.\n";
+        }
+        for (size_t row = 0; row < data.nrows(); ++row) {
+          sqlite3_bind_int64(stmt, 1, iov + 1);
+          for (size_t col = 0; col < data.ncols(); ++col) {
+            const auto& column = data.getColumn(col);
+            int param = col + 2;
+            if (column.kind() == lariov::DBDataset::kDOUBLE)
+              sqlite3_bind_double(stmt, param, column.getDouble(row));
+            else if (column.kind() == lariov::DBDataset::kSTRING) {
+              auto value = column.getString(row);
+              sqlite3_bind_text(stmt, param, value.data(), value.size(), SQLITE_STATIC);
+            }
+            else
+              sqlite3_bind_int64(stmt, param, column.getLong(row));
+          }
+          check(db, sqlite3_step(stmt), insert.str());
+          sqlite3_reset(stmt);
+        }
+      }
+      sqlite3_finalize(stmt);
+      stmt = nullptr;
+      exec(db, "COMMIT");
+    }
+    catch (...) {
+      sqlite3_finalize(stmt);
+      sqlite3_close(db);
+      std::filesystem::remove(temp);
+      throw;
+    }
+    sqlite3_close(db);
+    std::filesystem::rename(temp, path);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  Options opts;
+  try {
+    if (!parseOptions(argc, argv, opts)) {
+      usage();
+      return 2;
+    }
+  }
+  catch (std::exception&) {
+    usage();
+    return 2;
+  }
+
+  try {
+    std::filesystem::create_directories(opts.output_dir);
+    for (const auto& name : opts.folders) {
+
+      // Find IOVs overlapping the requested range.
+
+      lariov::DBFolder folder(name, opts.url, "", opts.tag);
+      if (!folder.LoadIOVIndex()) {
+        std::cerr << "Unable to load the list of IOVs of folder " << name << ".\n";
+        return 1;
+      }
+      std::vector<lariov::IOVTimeStamp> iovs = folder.IOVsInRange(opts.begin, opts.end);
+      if (iovs.empty()) {
+        std::cerr << "No IOVs of folder " << name << " in the requested range.\n";
+        return 1;
+      }
+      std::cout << "Folder " << name << ": downloading " << iovs.size() << " IOVs.\n";
+
+      // Download and write output.
+
+      std::vector<lariov::DBDataset> datasets = download(folder, iovs, opts.jobs);
+      lariov::IOVTimeStamp last_begin(0, 0);
+      lariov::IOVTimeStamp end_time = lariov::IOVTimeStamp::MaxTimeStamp();
+      folder.FindIOV(iovs.back(), last_begin, end_time);
+      std::string path = (std::filesystem::path(opts.output_dir) / (name + ".db")).string();
+      writeSQLite(path, name, opts.tag, datasets, end_time);
+      std::cout << "Folder " << name << ": wrote " << path << "\n";
+
+      if (!opts.cache_dir.empty()) {
+        lariov::DBDiskCache cache(
+          opts.cache_dir, opts.url, name, opts.tag, std::numeric_limits<std::uint64_t>::max());
+        for (const auto& data : datasets)
+          cache.Store(data);
+        std::cout << "Folder " << name << ": wrote binary snapshots to " << cache.Directory()
+                  << "\n";
+      }
+    }
+  }
+  catch (std::exception& e) {
+    std::cerr << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
@@ -13,10 +13,14 @@ namespace lariov {
      \class SIOVChannelStatusService
      art service implementation of ChannelStatusService.  Implements
      a channel status retrieval service for database scheme in which
-     all elements in a database folder share a common interval of validity
+     all elements in a database folder share a common interval of validity.
+
+     The accessors of the provider follow the latest event, so the service
+     requires a single schedule, unless ConcurrentSchedules is set to true
+     for jobs in which all clients get the provider of each event from
+     ProviderFor(evt.time().value()).
   */
-  class SIOVChannelStatusService : public ChannelStatusService,
-                                   private lar::EnsureOnlyOneSchedule<SIOVChannelStatusService> {
+  class SIOVChannelStatusService : public ChannelStatusService {
 
   public:
     SIOVChannelStatusService(fhicl::ParameterSet const& pset, art::ActivityRegistry& reg);
@@ -28,6 +32,11 @@ namespace lariov {
 
     const ChannelStatusProvider* DoGetProviderPtr() const override { return &fProvider; }
 
+    std::shared_ptr<const ChannelStatusProvider> DoGetProviderFor(DBTimeStamp_t ts) const override
+    {
+      return fProvider.HandleFor(ts);
+    }
+
     SIOVChannelStatusProvider fProvider;
   };
 } //end namespace lariov
@@ -42,6 +51,9 @@ namespace lariov {
                                                      art::ActivityRegistry& reg)
     : fProvider(pset.get<fhicl::ParameterSet>("ChannelStatusProvider"))
   {
+    if (!pset.get<bool>("ConcurrentSchedules", false)) {
+      lar::EnsureOnlyOneSchedule<SIOVChannelStatusService> const check;
+    }
 
     //register callback to update local database cache before each event is processed
     reg.sPreProcessEvent.watch(this, &SIOVChannelStatusService::PreProcessEvent);
@@ -13,10 +13,14 @@ namespace lariov {
      \class SIOVDetPedestalService
      art service implementation of DetPedestalService.  Implements
      a detector pedestal retrieval service for database scheme in which
-     all elements in a database folder share a common interval of validity
+     all elements in a database folder share a common interval of validity.
+
+     The accessors of the provider follow the latest event, so the service
+     requires a single schedule, unless ConcurrentSchedules is set to true
+     for jobs in which all clients get the provider of each event from
+     ProviderFor(evt.time().value()).
   */
-  class SIOVDetPedestalService : public DetPedestalService,
-                                 private lar::EnsureOnlyOneSchedule<SIOVDetPedestalService> {
+  class SIOVDetPedestalService : public DetPedestalService {
 
   public:
     SIOVDetPedestalService(fhicl::ParameterSet const& pset, art::ActivityRegistry& reg);
@@ -30,6 +34,12 @@ namespace lariov {
   private:
     const DetPedestalProvider& DoGetPedestalProvider() const override { return fProvider; }
 
+    std::shared_ptr<const DetPedestalProvider> DoGetPedestalProviderFor(
+      DBTimeStamp_t ts) const override
+    {
+      return fProvider.HandleFor(ts);
+    }
+
     DetPedestalRetrievalAlg fProvider;
   };
 } //end namespace lariov
@@ -44,6 +54,9 @@ namespace lariov {
                                                  art::ActivityRegistry& reg)
     : fProvider(pset.get<fhicl::ParameterSet>("DetPedestalRetrievalAlg"))
   {
+    if (!pset.get<bool>("ConcurrentSchedules", false)) {
+      lar::EnsureOnlyOneSchedule<SIOVDetPedestalService> const check;
+    }
     //register callback to update local database cache before each event is processed
     //reg.sPreProcessEvent.watch(&SIOVDetPedestalService::PreProcessEvent, *this);
     reg.sPreProcessEvent.watch(this, &SIOVDetPedestalService::PreProcessEvent);
@@ -12,7 +12,9 @@ namespace lariov {
      \class SIOVElectronicsCalibService
      art service implementation of ElectronicsCalibService.  Implements
      an electronics calibration retrieval service for database scheme in which
-     all elements in a database folder share a common interval of validity
+     all elements in a database folder share a common interval of validity.
+     ProviderFor(evt.time().value()) gives the provider of one event, which
+     does not follow later events.
   */
   class SIOVElectronicsCalibService : public ElectronicsCalibService {
 
@@ -30,6 +32,12 @@ namespace lariov {
 
     ElectronicsCalibProvider const* DoGetProviderPtr() const override { return &fProvider; }
 
+    std::shared_ptr<const ElectronicsCalibProvider> DoGetProviderFor(
+      DBTimeStamp_t ts) const override
+    {
+      return fProvider.HandleFor(ts);
+    }
+
     SIOVElectronicsCalibProvider fProvider;
   };
 } //end namespace lariov
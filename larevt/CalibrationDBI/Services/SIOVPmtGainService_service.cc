@@ -12,7 +12,9 @@ namespace lariov {
      \class SIOVPmtGainService
      art service implementation of PmtGainService.  Implements
      a pmt gain retrieval service for database scheme in which
-     all elements in a database folder share a common interval of validity
+     all elements in a database folder share a common interval of validity.
+     ProviderFor(evt.time().value()) gives the provider of one event, which
+     does not follow later events.
   */
   class SIOVPmtGainService : public PmtGainService {
 
@@ -30,6 +32,11 @@ namespace lariov {
 
     PmtGainProvider const* DoGetProviderPtr() const override { return &fProvider; }
 
+    std::shared_ptr<const PmtGainProvider> DoGetProviderFor(DBTimeStamp_t ts) const override
+    {
+      return fProvider.HandleFor(ts);
+    }
+
     SIOVPmtGainProvider fProvider;
   };
 } //end namespace lariov
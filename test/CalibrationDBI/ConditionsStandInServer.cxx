@@ -0,0 +1,452 @@
+/**
+ * @file   ConditionsStandInServer.cxx
+ * @brief  Localhost stand-in for the http conditions database server
+ * @date   October 18th, 2026
+ * @see    ConditionsStandInServer.h
+ */
+
+#include "ConditionsStandInServer.h"
+
+// framework libraries
+#include "cetlib_except/exception.h"
+
+// C/C++ standard library
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <sstream>
+
+// system libraries
+#include "sqlite3.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+  // Value of a query parameter (%-escapes decoded), or empty if absent.
+
+  std::string queryParameter(const std::string& query, const std::string& name)
+  {
+    std::istringstream in(query);
+    std::string item;
+    while (std::getline(in, item, '&')) {
+      if (item.compare(0, name.size() + 1, name + "=") != 0) continue;
+      std::string value;
+      for (size_t i = name.size() + 1; i < item.size(); ++i) {
+        if (item[i] == '%' && i + 2 < item.size()) {
+          value += char(std::strtol(item.substr(i + 1, 2).c_str(), nullptr, 16));
+          i += 2;
+        }
+        else
+          value += (item[i] == '+') ? ' ' : item[i];
+      }
+      return value;
+    }
+    return "";
+  }
+
+  // Write one comma separated field, quoted if necessary.
+
+  void writeField(std::ostream& out, std::string_view value)
+  {
+    if (value.find_first_of(",\"\n") == std::string_view::npos) {
+      out << value;
+      return;
+    }
+    out << '"';
+    for (char c : value)
+      out << ((c == '"') ? "\"\"" : std::string(1, c));
+    out << '"';
+  }
+
+  // Write the whole buffer to a socket.
+
+  void sendAll(int fd, const std::string& data)
+  {
+    size_t sent = 0;
+    while (sent < data.size()) {
+      ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+      if (n <= 0) return;
+      sent += n;
+    }
+  }
+
+  // Deterministic pseudo-random number in [0, 1) for a channel and IOV.
+
+  double channelHash(size_t channel, size_t iov)
+  {
+    std::uint64_t h = (channel + 1) * 0x9E3779B97F4A7C15ULL ^ (iov + 1) * 0xC2B2AE3D27D4EB4FULL;
+    h ^= h >> 31;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 29;
+    return (h >> 11) * 0x1.0p-53;
+  }
+}
+
+namespace lariov::test {
+
+  ConditionsStandInServer::ConditionsStandInServer()
+  {
+    fListenFD = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fListenFD < 0)
+      throw cet::exception("ConditionsStandInServer") << "Unable to create socket.\n";
+    int one = 1;
+    ::setsockopt(fListenFD, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0; // Any free port.
+    socklen_t len = sizeof(addr);
+    if (::bind(fListenFD, (sockaddr*)&addr, sizeof(addr)) != 0 ||
+        ::listen(fListenFD, SOMAXCONN) != 0 ||
+        ::getsockname(fListenFD, (sockaddr*)&addr, &len) != 0) {
+      ::close(fListenFD);
+      throw cet::exception("ConditionsStandInServer")
+        << "Unable to listen on a loopback port: " << std::strerror(errno) << "\n";
+    }
+    fPort = ntohs(addr.sin_port);
+    fListener = std::thread(&ConditionsStandInServer::Listen, this);
+  }
+
+  ConditionsStandInServer::~ConditionsStandInServer()
+  {
+    fStop = true;
+    fListener.join();
+    ::close(fListenFD);
+    std::list<Connection> connections;
+    {
+      std::lock_guard<std::mutex> lock(fMutex);
+      connections.swap(fConnections);
+    }
+    for (auto& connection : connections)
+      connection.thread.join();
+  }
+
+  std::string ConditionsStandInServer::URL() const
+  {
+    return "http://127.0.0.1:" + std::to_string(fPort);
+  }
+
+  void ConditionsStandInServer::AddFolder(const std::string& folder,
+                                          std::vector<IOVTimeStamp> begin_times,
+                                          std::vector<std::string> names,
+                                          std::vector<std::string> types,
+                                          RowWriter rows)
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    fFolders[folder] =
+      Folder{std::move(begin_times), std::move(names), std::move(types), std::move(rows)};
+  }
+
+  void ConditionsStandInServer::AddSyntheticFolder(const std::string& folder,
+                                                   size_t nchannels,
+                                                   size_t niovs,
+                                                   unsigned long first_time,
+                                                   unsigned long iov_length,
+                                                   double changed_fraction)
+  {
+    std::vector<IOVTimeStamp> begin_times;
+    for (size_t iov = 0; iov < niovs; ++iov)
+      begin_times.emplace_back(first_time + iov * iov_length, 0);
+
+    // The values of a channel in an IOV are those of the last IOV in which
+    // the channel changed (all channels are set in the first IOV).
+
+    auto rows = [nchannels, changed_fraction](size_t iov, std::ostream& out) {
+      out << std::fixed << std::setprecision(4);
+      for (size_t ch = 0; ch < nchannels; ++ch) {
+        size_t last = iov;
+        while (last > 0 && channelHash(ch, last) >= changed_fraction)
+          --last;
+        double base = 400. + 0.001 * (ch % 997) + 0.1 * last;
+        out << ch << ',' << base << ',' << 0.01 * (ch % 13) << ',' << 2.5 + 0.0001 * (ch % 89)
+            << ',' << 0.001 * (last % 7) << '\n';
+      }
+    };
+    AddFolder(folder,
+              std::move(begin_times),
+              {"channel", "mean", "mean_err", "rms", "rms_err"},
+              {"integer", "real", "real", "real", "real"},
+              rows);
+  }
+
+  void ConditionsStandInServer::AddSQLiteFolder(const std::string& path,
+                                                const std::string& folder,
+                                                const std::string& tag)
+  {
+    sqlite3* raw = nullptr;
+    if (sqlite3_open_v2(path.c_str(), &raw, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+      sqlite3_close(raw);
+      throw cet::exception("ConditionsStandInServer")
+        << "Unable to open sqlite database " << path << "\n";
+    }
+    auto db = std::shared_ptr<sqlite3>(raw, sqlite3_close);
+    auto db_mutex = std::make_shared<std::mutex>();
+    auto prepare = [db](const std::string& sql) {
+      sqlite3_stmt* stmt = nullptr;
+      if (sqlite3_prepare_v2(db.get(), sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        std::string msg = sqlite3_errmsg(db.get());
+        sqlite3_finalize(stmt);
+        throw cet::exception("ConditionsStandInServer") << "sqlite error: " << msg << "\n";
+      }
+      return std::unique_ptr<sqlite3_stmt, int (*)(sqlite3_stmt*)>(stmt, sqlite3_finalize);
+    };
+
+    // IOVs of the tag.
+
+    std::string table_iovs = folder + "_iovs";
+    std::string table_tag_iovs = folder + "_tag_iovs";
+    std::string table_data = folder + "_data";
+    auto iovs = prepare("SELECT DISTINCT " + table_iovs + ".begin_time FROM " + table_tag_iovs +
+                        "," + table_iovs + " WHERE " + table_tag_iovs + ".tag=?1 AND " +
+                        table_tag_iovs + ".iov_id=" + table_iovs + ".iov_id ORDER BY " +
+                        table_iovs + ".begin_time");
+    sqlite3_bind_text(iovs.get(), 1, tag.c_str(), -1, SQLITE_TRANSIENT);
+    std::vector<IOVTimeStamp> begin_times;
+    while (sqlite3_step(iovs.get()) == SQLITE_ROW)
+      begin_times.emplace_back(sqlite3_column_int64(iovs.get(), 0), 0);
+    if (begin_times.empty())
+      throw cet::exception("ConditionsStandInServer")
+        << "No IOVs of folder " << folder << " in " << path << "\n";
+
+    // Payload query (latest row of each channel), as used by DBFolder.
+    // Columns beginning with "_" are not served.
+
+    std::string data_sql = "SELECT " + table_data + ".*,MAX(begin_time) FROM " + table_data +
+                           "," + table_iovs + "," + table_tag_iovs + " WHERE " +
+                           table_tag_iovs + ".tag=?1 AND " + table_iovs +
+                           ".iov_id=" + table_tag_iovs + ".iov_id AND " + table_data +
+                           ".__iov_id=" + table_tag_iovs + ".iov_id AND " + table_iovs +
+                           ".begin_time <= ?2 GROUP BY channel ORDER BY channel";
+    auto stmt = prepare(data_sql);
+    std::vector<int> served;
+    std::vector<std::string> names;
+    std::vector<std::string> types;
+    for (int col = 0; col < sqlite3_column_count(stmt.get()) - 1; ++col) {
+      const char* name = sqlite3_column_name(stmt.get(), col);
+      if (name[0] == '_') continue;
+      served.push_back(col);
+      names.push_back(name);
+    }
+
+    // Column types are taken from the values of the first row.
+
+    sqlite3_bind_text(stmt.get(), 1, tag.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int64(stmt.get(), 2, begin_times.front().Stamp());
+    bool have_row = sqlite3_step(stmt.get()) == SQLITE_ROW;
+    for (int col : served) {
+      int dtype = have_row ? sqlite3_column_type(stmt.get(), col) : SQLITE_TEXT;
+      types.push_back(dtype == SQLITE_INTEGER ? "integer" :
+                      dtype == SQLITE_FLOAT   ? "real" :
+                                                "text");
+    }
+
+    auto rows = [=](size_t iov, std::ostream& out) {
+      std::lock_guard<std::mutex> lock(*db_mutex);
+      auto query = prepare(data_sql);
+      sqlite3_bind_text(query.get(), 1, tag.c_str(), -1, SQLITE_TRANSIENT);
+      sqlite3_bind_int64(query.get(), 2, begin_times[iov].Stamp());
+      out << std::setprecision(17);
+      while (sqlite3_step(query.get()) == SQLITE_ROW) {
+        for (size_t i = 0; i < served.size(); ++i) {
+          if (i > 0) out << ',';
+          int col = served[i];
+          switch (sqlite3_column_type(query.get(), col)) {
+          case SQLITE_INTEGER: out << sqlite3_column_int64(query.get(), col); break;
+          case SQLITE_FLOAT: out << sqlite3_column_double(query.get(), col); break;
+          case SQLITE_NULL: break;
+          default: writeField(out, (const char*)sqlite3_column_text(query.get(), col));
+          }
+        }
+        out << '\n';
+      }
+    };
+    AddFolder(folder, begin_times, std::move(names), std::move(types), rows);
+  }
+
+  void ConditionsStandInServer::SetLatency(double latency, double jitter)
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    fLatency = latency;
+    fJitter = jitter;
+  }
+
+  void ConditionsStandInServer::SetErrorRate(double probability)
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    fErrorRate = probability;
+  }
+
+  void ConditionsStandInServer::FailNext(unsigned int n)
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    fFailNext = n;
+  }
+
+  // Accept connections until stopped.
+  // Threads of finished connections are joined as new connections arrive.
+
+  void ConditionsStandInServer::Listen()
+  {
+    while (!fStop) {
+      pollfd pfd{fListenFD, POLLIN, 0};
+      if (::poll(&pfd, 1, 100) <= 0) continue;
+      int fd = ::accept(fListenFD, nullptr, nullptr);
+      if (fd < 0) continue;
+      std::lock_guard<std::mutex> lock(fMutex);
+      for (auto it = fConnections.begin(); it != fConnections.end();) {
+        if (*it->done) {
+          it->thread.join();
+          it = fConnections.erase(it);
+        }
+        else
+          ++it;
+      }
+      auto done = std::make_shared<std::atomic<bool>>(false);
+      fConnections.push_back({std::thread(&ConditionsStandInServer::Serve, this, fd, done), done});
+    }
+  }
+
+  // Answer one request and close the connection.
+
+  void ConditionsStandInServer::Serve(int fd, std::shared_ptr<std::atomic<bool>> done)
+  {
+    std::string request;
+    char buf[4096];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 65536) {
+      ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+      if (n <= 0) break;
+      request.append(buf, n);
+    }
+
+    // Request line: GET <target> HTTP/1.x
+
+    std::istringstream line(request.substr(0, request.find("\r\n")));
+    std::string method, target;
+    line >> method >> target;
+    ++fRequests;
+
+    double delay = 0.;
+    {
+      thread_local std::mt19937 engine{std::random_device{}()};
+      std::lock_guard<std::mutex> lock(fMutex);
+      delay = fLatency + fJitter * std::uniform_real_distribution<double>(0., 1.)(engine);
+    }
+    if (delay > 0.) std::this_thread::sleep_for(std::chrono::duration<double>(delay));
+
+    std::string body;
+    int status = 500;
+    if (method != "GET")
+      body = "Unsupported method";
+    else if (InjectError())
+      body = "Injected error";
+    else
+      status = Answer(target, body);
+    if (status != 200) ++fErrors;
+
+    std::ostringstream response;
+    response << "HTTP/1.1 " << status << (status == 200 ? " OK" : " Error") << "\r\n"
+             << "Content-Type: text/plain\r\n"
+             << "Content-Length: " << body.size() << "\r\n"
+             << "Connection: close\r\n\r\n";
+    sendAll(fd, response.str());
+    sendAll(fd, body);
+    ::shutdown(fd, SHUT_WR);
+    ::close(fd);
+    *done = true;
+  }
+
+  // Decide whether to fail this request.
+
+  bool ConditionsStandInServer::InjectError()
+  {
+    thread_local std::mt19937 engine{std::random_device{}()};
+    std::lock_guard<std::mutex> lock(fMutex);
+    if (fFailNext > 0) {
+      --fFailNext;
+      return true;
+    }
+    return fErrorRate > 0. && std::uniform_real_distribution<double>(0., 1.)(engine) < fErrorRate;
+  }
+
+  const ConditionsStandInServer::Folder* ConditionsStandInServer::FindFolder(
+    const std::string& name) const
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    auto it = fFolders.find(name);
+    return it == fFolders.end() ? nullptr : &it->second;
+  }
+
+  // Build the answer to a request.  Returns the http status.
+
+  int ConditionsStandInServer::Answer(const std::string& target, std::string& body) const
+  {
+    size_t qmark = target.find('?');
+    std::string path = target.substr(0, qmark);
+    std::string query = (qmark == std::string::npos) ? "" : target.substr(qmark + 1);
+    path = path.substr(path.find_last_of('/') + 1);
+
+    const Folder* folder = FindFolder(queryParameter(query, "f"));
+    if (folder == nullptr) {
+      body = "Unknown folder";
+      return 404;
+    }
+    std::ostringstream out;
+
+    if (path == "iovs") {
+      for (const auto& begin_time : folder->begin_times)
+        out << begin_time.DBStamp() << '\n';
+      body = out.str();
+      return 200;
+    }
+    if (path != "data") {
+      body = "Unknown query";
+      return 404;
+    }
+
+    // Find the IOV containing the requested time.
+
+    IOVTimeStamp time(0, 0);
+    try {
+      time = IOVTimeStamp::GetFromString(queryParameter(query, "t"));
+    }
+    catch (std::exception&) {
+      body = "Bad time";
+      return 400;
+    }
+    auto it = std::upper_bound(folder->begin_times.begin(), folder->begin_times.end(), time);
+    if (it == folder->begin_times.begin()) {
+      body = "No IOV";
+      return 404;
+    }
+    size_t iov = (it - folder->begin_times.begin()) - 1;
+
+    // Header rows, then data rows.
+
+    out << folder->begin_times[iov].DBStamp() << '\n';
+    out << (iov + 1 < folder->begin_times.size() ? folder->begin_times[iov + 1].DBStamp() : "-")
+        << '\n';
+    for (size_t i = 0; i < folder->names.size(); ++i) {
+      if (i > 0) out << ',';
+      writeField(out, folder->names[i]);
+    }
+    out << '\n';
+    for (size_t i = 0; i < folder->types.size(); ++i)
+      out << (i > 0 ? "," : "") << folder->types[i];
+    out << '\n';
+    folder->rows(iov, out);
+    body = out.str();
+    return 200;
+  }
+
+} // namespace lariov::test
@@ -0,0 +1,147 @@
+/**
+ * @file   ConditionsStandInServer.h
+ * @brief  Localhost stand-in for the http conditions database server
+ * @date   October 18th, 2026
+ *
+ * `ConditionsStandInServer` listens on a loopback port and answers the two
+ * queries issued by `lariov::DBFolder`:
+ *
+ * * `/data?f=<folder>&t=<time>[&tag=<tag>]`: payload of the IOV containing
+ *   `t`, as comma separated text in the layout returned by the production
+ *   server and read by `DBDataset(void*)`: IOV begin time, IOV end time
+ *   (`-` for the last IOV), column names, and column types (one row each),
+ *   followed by one row per channel;
+ * * `/iovs?f=<folder>[&tag=<tag>]`: begin times of all IOVs, one per row.
+ *
+ * Folders are either synthetic (pedestal-like tables generated on request,
+ * so that large channel counts and many IOVs cost no memory), or read on
+ * request from a sqlite database in the layout used by `DBFolder` with
+ * `UseSQLite` (tables `<folder>_iovs`, `<folder>_tag_iovs`, `<folder>_data`).
+ *
+ * Latency and errors can be injected to exercise retries, hedging and
+ * timeouts: every request is delayed by a configurable latency (plus
+ * uniform jitter), and fails with http status 500 with a configurable
+ * probability, or unconditionally for a number of following requests.
+ *
+ * Each connection is served by its own thread, and closed after one answer.
+ */
+
+#ifndef LAREVT_TEST_CALIBRATIONDBI_CONDITIONSSTANDINSERVER_H
+#define LAREVT_TEST_CALIBRATIONDBI_CONDITIONSSTANDINSERVER_H
+
+// LArSoft libraries
+#include "larevt/CalibrationDBI/IOVData/IOVTimeStamp.h"
+
+// C/C++ standard library
+#include <atomic>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace lariov::test {
+
+  class ConditionsStandInServer {
+  public:
+    /// Writes the data rows of one IOV (comma separated, one line per row).
+    using RowWriter = std::function<void(size_t iov, std::ostream& out)>;
+
+    /// Starts listening on a free loopback port.
+    ConditionsStandInServer();
+
+    /// Stops the server, waiting for connections in progress.
+    ~ConditionsStandInServer();
+
+    ConditionsStandInServer(const ConditionsStandInServer&) = delete;
+    ConditionsStandInServer& operator=(const ConditionsStandInServer&) = delete;
+
+    /// Url to use as `DBUrl` (`http://127.0.0.1:<port>`).
+    std::string URL() const;
+
+    /// Serves a folder with the specified IOV begin times (sorted) and schema.
+    void AddFolder(const std::string& folder,
+                   std::vector<IOVTimeStamp> begin_times,
+                   std::vector<std::string> names,
+                   std::vector<std::string> types,
+                   RowWriter rows);
+
+    /**
+     * @brief Serves a synthetic pedestal-like folder.
+     * @param folder name of the folder
+     * @param nchannels number of channels (numbered from 0)
+     * @param niovs number of IOVs
+     * @param first_time begin time of the first IOV (seconds since epoch)
+     * @param iov_length length of each IOV (seconds)
+     * @param changed_fraction fraction of channels whose values change at each new IOV
+     *
+     * Columns are `channel`, `mean`, `mean_err`, `rms` and `rms_err`.
+     */
+    void AddSyntheticFolder(const std::string& folder,
+                            size_t nchannels,
+                            size_t niovs,
+                            unsigned long first_time,
+                            unsigned long iov_length,
+                            double changed_fraction = 1.);
+
+    /// Serves a folder from a sqlite database (tag selects the IOVs served).
+    void AddSQLiteFolder(const std::string& path,
+                         const std::string& folder,
+                         const std::string& tag = "");
+
+    /// Delays every answer by latency plus a uniform random jitter (seconds).
+    void SetLatency(double latency, double jitter = 0.);
+
+    /// Fails requests with http status 500 with the specified probability.
+    void SetErrorRate(double probability);
+
+    /// Fails the next n requests with http status 500.
+    void FailNext(unsigned int n);
+
+    /// Number of requests received, and of requests answered with an error.
+    unsigned long Requests() const { return fRequests; }
+    unsigned long Errors() const { return fErrors; }
+
+  private:
+    struct Folder {
+      std::vector<IOVTimeStamp> begin_times;
+      std::vector<std::string> names;
+      std::vector<std::string> types;
+      RowWriter rows;
+    };
+
+    struct Connection {
+      std::thread thread;
+      std::shared_ptr<std::atomic<bool>> done;
+    };
+
+    void Listen();
+    void Serve(int fd, std::shared_ptr<std::atomic<bool>> done);
+    int Answer(const std::string& target, std::string& body) const;
+    const Folder* FindFolder(const std::string& name) const;
+    bool InjectError();
+
+    int fListenFD = -1;
+    unsigned short fPort = 0;
+    std::atomic<bool> fStop{false};
+    std::thread fListener;
+
+    mutable std::mutex fMutex; // Protects members below.
+    std::map<std::string, Folder> fFolders;
+    std::list<Connection> fConnections;
+    double fLatency = 0.;
+    double fJitter = 0.;
+    double fErrorRate = 0.;
+    unsigned int fFailNext = 0;
+
+    std::atomic<unsigned long> fRequests{0};
+    std::atomic<unsigned long> fErrors{0};
+  };
+
+} // namespace lariov::test
+
+#endif // LAREVT_TEST_CALIBRATIONDBI_CONDITIONSSTANDINSERVER_H
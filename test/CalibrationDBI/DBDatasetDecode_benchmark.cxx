@@ -0,0 +1,93 @@
+/**
+ * @file   DBDatasetDecode_benchmark.cxx
+ * @brief  Throughput benchmark of the DBDataset text decoders
+ * @date   October 18th, 2026
+ *
+ * A synthetic dataset with 100k channels is rendered as database text values,
+ * the same form in which libwda hands them to the `DBDataset` constructor.
+ * The values are then decoded column by column with
+ * `DBDataset::Column::appendText()`, and the throughput is reported in rows
+ * per second.
+ *
+ * Usage: DBDatasetDecode_benchmark [nchannels] [repetitions]
+ */
+
+// LArSoft libraries
+#include "larevt/CalibrationDBI/Providers/DBDataset.h"
+
+// C/C++ standard library
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+  size_t const nchannels = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 100000;
+  unsigned int const repetitions = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 10;
+
+  // Typical pedestal/status-like table layout.
+
+  std::vector<std::string> const names{"channel", "mean", "mean_err", "rms", "status", "label"};
+  std::vector<std::string> const types{"integer", "real", "real", "real", "boolean", "text"};
+  size_t const ncols = names.size();
+
+  // Render synthetic values row by row.
+
+  std::vector<std::string> cells;
+  cells.reserve(nchannels * ncols);
+  for (size_t ch = 0; ch < nchannels; ++ch) {
+    cells.push_back(std::to_string(ch));
+    cells.push_back(std::to_string(400. + 0.001 * (ch % 997)));
+    cells.push_back(std::to_string(0.01 * (ch % 13)));
+    cells.push_back(std::to_string(2.5 + 0.0001 * (ch % 89)));
+    cells.push_back((ch % 7) ? "true" : "false");
+    cells.push_back("plane" + std::to_string(ch % 3));
+  }
+
+  // Decode.
+
+  double total_seconds = 0.;
+  for (unsigned int rep = 0; rep < repetitions; ++rep) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<lariov::DBDataset::Column> columns;
+    columns.reserve(ncols);
+    for (auto const& type : types) {
+      columns.emplace_back(lariov::DBDataset::GetColumnKind(type));
+      columns.back().reserve(nchannels);
+    }
+    for (size_t row = 0; row < nchannels; ++row) {
+      for (size_t col = 0; col < ncols; ++col)
+        columns[col].appendText(cells[row * ncols + col]);
+    }
+    auto channel_column = columns[0].longs();
+    std::vector<lariov::DBChannelID_t> channels(channel_column.begin(), channel_column.end());
+    lariov::DBDataset data(lariov::IOVTimeStamp(1, 0),
+                           lariov::IOVTimeStamp::MaxTimeStamp(),
+                           std::vector<std::string>(names),
+                           std::vector<std::string>(types),
+                           std::move(channels),
+                           std::move(columns));
+
+    auto stop = std::chrono::steady_clock::now();
+    total_seconds += std::chrono::duration<double>(stop - start).count();
+
+    // Sanity check of the decoded content.
+
+    size_t const last = nchannels - 1;
+    if (data.nrows() != nchannels || data.getRowNumber(last) != (int)last ||
+        data.getRow(last).getBoolData(4) != bool(last % 7) ||
+        data.getRow(last).getStringView(5) != "plane" + std::to_string(last % 3)) {
+      std::cerr << "Decoded dataset does not match the input.\n";
+      return 1;
+    }
+  }
+
+  double const rows_per_second = nchannels * repetitions / total_seconds;
+  std::cout << "Decoded " << nchannels << " rows x " << ncols << " columns, " << repetitions
+            << " times: " << rows_per_second << " rows/s ("
+            << 1e3 * total_seconds / repetitions << " ms per dataset)\n";
+  return 0;
+}
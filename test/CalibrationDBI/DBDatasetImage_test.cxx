@@ -0,0 +1,197 @@
+/**
+ * @file   DBDatasetImage_test.cxx
+ * @brief  Test of lariov::DBDataset binary images and files
+ * @date   October 18th, 2026
+ */
+
+// Boost libraries
+#define BOOST_TEST_MODULE (dbdatasetimage_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "larevt/CalibrationDBI/Providers/DBDatasetImage.h"
+
+// framework libraries
+#include "cetlib_except/exception.h"
+
+// C/C++ standard library
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+  using lariov::DBDataset;
+
+  // Dataset with one column of each kind.
+
+  DBDataset makeDataset()
+  {
+    std::vector<DBDataset::Column> columns;
+    columns.emplace_back(std::vector<std::int64_t>{1, 2, 7});
+    columns.emplace_back(std::vector<double>{0.5, -1.25, 3.});
+    columns.emplace_back(DBDataset::kBOOL);
+    columns.back().pushBool(true);
+    columns.back().pushBool(false);
+    columns.back().pushBool(true);
+    columns.emplace_back(DBDataset::kSTRING);
+    columns.back().pushString("a");
+    columns.back().pushString("");
+    columns.back().pushString("xyz");
+    return DBDataset(lariov::IOVTimeStamp(100, 2),
+                     lariov::IOVTimeStamp(200, 0),
+                     {"channel", "gain", "ok", "name"},
+                     {"integer", "real", "boolean", "text"},
+                     {1, 2, 7},
+                     std::move(columns));
+  }
+
+  // Image of a dataset, in 8-byte aligned memory.
+
+  struct Image {
+    std::vector<std::uint64_t> words;
+    size_t size;
+
+    explicit Image(DBDataset const& data) : size(lariov::DatasetImageSize(data))
+    {
+      words.resize((size + 7) / 8);
+      lariov::WriteDatasetImage(data, bytes(), size);
+    }
+    char* bytes() { return reinterpret_cast<char*>(words.data()); }
+    DBDataset view(size_t n) { return lariov::ViewDatasetImage(bytes(), n, nullptr); }
+    DBDataset view() { return view(size); }
+  };
+
+  void checkSame(DBDataset const& a, DBDataset const& b)
+  {
+    BOOST_TEST((a.beginTime() == b.beginTime()));
+    BOOST_TEST((a.endTime() == b.endTime()));
+    BOOST_TEST(a.colNames() == b.colNames(), boost::test_tools::per_element());
+    BOOST_TEST(a.colTypes() == b.colTypes(), boost::test_tools::per_element());
+    BOOST_TEST(a.channels() == b.channels(), boost::test_tools::per_element());
+    BOOST_TEST(a.fingerprint() == b.fingerprint());
+    for (size_t row = 0; row < a.nrows(); ++row) {
+      BOOST_TEST(a.getRow(row).getLongData(0) == b.getRow(row).getLongData(0));
+      BOOST_TEST(a.getRow(row).getDoubleData(1) == b.getRow(row).getDoubleData(1));
+      BOOST_TEST(a.getRow(row).getBoolData(2) == b.getRow(row).getBoolData(2));
+      BOOST_TEST(a.getRow(row).getStringView(3) == b.getRow(row).getStringView(3));
+    }
+  }
+
+  // Scratch directory, removed at the end of the test.
+
+  struct ScratchDir {
+    std::filesystem::path path = std::filesystem::temp_directory_path() /
+                                 ("DBDatasetImage_test." + std::to_string(getpid()));
+    ScratchDir() { std::filesystem::create_directories(path); }
+    ~ScratchDir() { std::filesystem::remove_all(path); }
+  };
+
+} // local namespace
+
+BOOST_AUTO_TEST_CASE(memory_round_trip)
+{
+  DBDataset const data = makeDataset();
+  Image image(data);
+  BOOST_TEST(image.size % 8 == 0U);
+  DBDataset const view = image.view();
+  checkSame(data, view);
+  BOOST_TEST(view.getColumn(1).borrowed());
+}
+
+BOOST_AUTO_TEST_CASE(file_round_trip)
+{
+  ScratchDir dir;
+  std::string const path = (dir.path / "data.img").string();
+  DBDataset const data = makeDataset();
+  lariov::WriteDatasetFile(data, path);
+
+  // Only the final file is left (no temporary files).
+
+  size_t nfiles = 0;
+  for (auto const& entry : std::filesystem::directory_iterator(dir.path)) {
+    BOOST_TEST(entry.path().filename() == "data.img");
+    ++nfiles;
+  }
+  BOOST_TEST(nfiles == 1U);
+  checkSame(data, lariov::ReadDatasetFile(path));
+}
+
+BOOST_AUTO_TEST_CASE(empty_dataset)
+{
+  DBDataset const data(lariov::IOVTimeStamp(1, 0), lariov::IOVTimeStamp(2, 0), {}, {}, {}, {});
+  Image image(data);
+  DBDataset const view = image.view();
+  BOOST_TEST(view.ncols() == 0U);
+  BOOST_TEST((view.beginTime() == data.beginTime()));
+}
+
+BOOST_AUTO_TEST_CASE(truncated_image)
+{
+  Image image(makeDataset());
+  for (size_t n : {size_t(0), size_t(4), size_t(40), image.size / 2, image.size - 8})
+    BOOST_CHECK_THROW(image.view(n), cet::exception);
+}
+
+BOOST_AUTO_TEST_CASE(truncated_file)
+{
+  ScratchDir dir;
+  std::string const path = (dir.path / "data.img").string();
+  lariov::WriteDatasetFile(makeDataset(), path);
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 16);
+  BOOST_CHECK_THROW(lariov::ReadDatasetFile(path), cet::exception);
+
+  std::ofstream(dir.path / "empty.img");
+  BOOST_CHECK_THROW(lariov::ReadDatasetFile((dir.path / "empty.img").string()), cet::exception);
+  BOOST_CHECK_THROW(lariov::ReadDatasetFile((dir.path / "none.img").string()), cet::exception);
+}
+
+BOOST_AUTO_TEST_CASE(bad_magic)
+{
+  Image image(makeDataset());
+  image.bytes()[0] = 'X';
+  BOOST_CHECK_THROW(image.view(), cet::exception);
+}
+
+BOOST_AUTO_TEST_CASE(wrong_version)
+{
+  Image image(makeDataset());
+  std::uint32_t version = 0;
+  std::memcpy(&version, image.bytes() + 8, sizeof(version));
+  ++version;
+  std::memcpy(image.bytes() + 8, &version, sizeof(version));
+  BOOST_CHECK_THROW(image.view(), cet::exception);
+}
+
+BOOST_AUTO_TEST_CASE(fingerprint_mismatch)
+{
+  // Change one value of the real column, leaving the image well formed.
+
+  DBDataset const data = makeDataset();
+  Image image(data);
+  double const value = -1.25;
+  char* pos = static_cast<char*>(memmem(image.bytes(), image.size, &value, sizeof(value)));
+  BOOST_TEST_REQUIRE(pos != nullptr);
+  double const changed = -1.5;
+  std::memcpy(pos, &changed, sizeof(changed));
+  BOOST_CHECK_THROW(image.view(), cet::exception);
+
+  // Change the recorded fingerprint instead.
+
+  Image image2(data);
+  image2.words[3] ^= 1; // Header: magic, version and columns, rows, fingerprint.
+  BOOST_CHECK_THROW(image2.view(), cet::exception);
+}
+
+BOOST_AUTO_TEST_CASE(misaligned_image)
+{
+  Image image(makeDataset());
+  std::vector<std::uint64_t> copy(image.words.size() + 1);
+  char* misaligned = reinterpret_cast<char*>(copy.data()) + 4;
+  std::memcpy(misaligned, image.bytes(), image.size);
+  BOOST_CHECK_THROW(lariov::ViewDatasetImage(misaligned, image.size, nullptr), cet::exception);
+}
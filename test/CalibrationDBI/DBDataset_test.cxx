@@ -0,0 +1,190 @@
+/**
+ * @file   DBDataset_test.cxx
+ * @brief  Test of lariov::DBDataset column decoding and typed access
+ * @date   October 18th, 2026
+ */
+
+// Boost libraries
+#define BOOST_TEST_MODULE (dbdataset_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "larevt/CalibrationDBI/Providers/DBDataset.h"
+
+// framework libraries
+#include "cetlib_except/exception.h"
+
+// C/C++ standard library
+#include <string>
+#include <vector>
+
+namespace {
+
+  using lariov::DBDataset;
+  using Column = DBDataset::Column;
+
+  // Column of the specified kind decoded from database text values.
+
+  Column decode(DBDataset::ColumnKind kind, std::vector<std::string> const& texts)
+  {
+    Column column(kind);
+    column.reserve(texts.size());
+    for (auto const& text : texts)
+      column.appendText(text);
+    return column;
+  }
+
+  // Dataset with channel, long, real and text columns.
+
+  DBDataset makeDataset(lariov::IOVTimeStamp const& begin,
+                        lariov::IOVTimeStamp const& end,
+                        std::vector<std::string> const& reals)
+  {
+    std::vector<Column> columns;
+    columns.push_back(decode(DBDataset::kLONG, {"1", "2", "4"}));
+    columns.push_back(decode(DBDataset::kLONG, {"10", "20", "40"}));
+    columns.push_back(decode(DBDataset::kDOUBLE, reals));
+    columns.push_back(decode(DBDataset::kSTRING, {"a", "b", "c"}));
+    return DBDataset(begin,
+                     end,
+                     {"channel", "status", "gain", "name"},
+                     {"integer", "integer", "real", "text"},
+                     {1, 2, 4},
+                     std::move(columns));
+  }
+
+} // local namespace
+
+BOOST_AUTO_TEST_CASE(column_kinds)
+{
+  BOOST_TEST(DBDataset::GetColumnKind("integer") == DBDataset::kLONG);
+  BOOST_TEST(DBDataset::GetColumnKind("bigint") == DBDataset::kLONG);
+  BOOST_TEST(DBDataset::GetColumnKind("real") == DBDataset::kDOUBLE);
+  BOOST_TEST(DBDataset::GetColumnKind("boolean") == DBDataset::kBOOL);
+  BOOST_TEST(DBDataset::GetColumnKind("text") == DBDataset::kSTRING);
+  BOOST_CHECK_THROW(DBDataset::GetColumnKind("blob"), cet::exception);
+}
+
+BOOST_AUTO_TEST_CASE(typed_decoding)
+{
+  Column longs = decode(DBDataset::kLONG, {"42", "-7", "0"});
+  BOOST_TEST(longs.size() == 3U);
+  BOOST_TEST(longs.getLong(0) == 42);
+  BOOST_TEST(longs.getLong(1) == -7);
+
+  Column doubles = decode(DBDataset::kDOUBLE, {"2.5", "1e3", "-0.125"});
+  BOOST_TEST(doubles.getDouble(0) == 2.5);
+  BOOST_TEST(doubles.getDouble(1) == 1000.);
+  BOOST_TEST(doubles.getDouble(2) == -0.125);
+
+  std::vector<std::string> bool_texts(70, "false");
+  bool_texts[0] = "true";
+  bool_texts[65] = "TRUE";
+  bool_texts[66] = "1";
+  Column bools = decode(DBDataset::kBOOL, bool_texts);
+  BOOST_TEST(bools.size() == 70U);
+  BOOST_TEST(bools.getBool(0));
+  BOOST_TEST(!bools.getBool(1));
+  BOOST_TEST(bools.getBool(65));
+  BOOST_TEST(bools.getBool(66));
+  BOOST_TEST(!bools.getBool(69));
+  BOOST_CHECK_THROW(decode(DBDataset::kBOOL, {"maybe"}), cet::exception);
+
+  Column strings = decode(DBDataset::kSTRING, {"a\"b", "", "text"});
+  BOOST_TEST(strings.getString(0) == "a\"b");
+  BOOST_TEST(strings.getString(1) == "");
+  BOOST_TEST(strings.getString(2) == "text");
+}
+
+BOOST_AUTO_TEST_CASE(numeric_widening)
+{
+  Column longs = decode(DBDataset::kLONG, {"3", "0"});
+  BOOST_TEST(longs.getDouble(0) == 3.);
+  BOOST_TEST(longs.getBool(0));
+  BOOST_TEST(!longs.getBool(1));
+
+  Column bools = decode(DBDataset::kBOOL, {"true", "false"});
+  BOOST_TEST(bools.getLong(0) == 1);
+  BOOST_TEST(bools.getDouble(1) == 0.);
+}
+
+BOOST_AUTO_TEST_CASE(no_narrowing)
+{
+  // Doubles are not truncated to long, nor is 0.5 taken as false.
+
+  Column doubles = decode(DBDataset::kDOUBLE, {"2.75", "0.5"});
+  BOOST_CHECK_THROW(doubles.getLong(0), cet::exception);
+  BOOST_CHECK_THROW(doubles.getBool(1), cet::exception);
+
+  Column strings = decode(DBDataset::kSTRING, {"1"});
+  BOOST_CHECK_THROW(strings.getLong(0), cet::exception);
+  BOOST_CHECK_THROW(strings.getDouble(0), cet::exception);
+  BOOST_CHECK_THROW(strings.getBool(0), cet::exception);
+
+  Column longs = decode(DBDataset::kLONG, {"1"});
+  BOOST_CHECK_THROW(longs.getString(0), cet::exception);
+}
+
+BOOST_AUTO_TEST_CASE(promotion)
+{
+  // A column guessed to be integer turns out to hold reals, then text.
+
+  Column column = decode(DBDataset::kLONG, {"1", "-2"});
+  column.promote(DBDataset::kDOUBLE);
+  column.appendText("2.5");
+  BOOST_TEST(column.kind() == DBDataset::kDOUBLE);
+  BOOST_TEST(column.size() == 3U);
+  BOOST_TEST(column.getDouble(0) == 1.);
+  BOOST_TEST(column.getDouble(1) == -2.);
+  BOOST_TEST(column.getDouble(2) == 2.5);
+
+  column.promote(DBDataset::kSTRING);
+  column.appendText("n/a");
+  BOOST_TEST(column.kind() == DBDataset::kSTRING);
+  BOOST_TEST(column.size() == 4U);
+  BOOST_TEST(column.getString(0) == "1");
+  BOOST_TEST(column.getString(1) == "-2");
+  BOOST_TEST(column.getString(2) == "2.5");
+  BOOST_TEST(column.getString(3) == "n/a");
+
+  // Long straight to string, and no narrowing promotions.
+
+  Column longs = decode(DBDataset::kLONG, {"12"});
+  longs.promote(DBDataset::kSTRING);
+  BOOST_TEST(longs.getString(0) == "12");
+  BOOST_CHECK_THROW(column.promote(DBDataset::kDOUBLE), cet::exception);
+  Column doubles = decode(DBDataset::kDOUBLE, {"1.5"});
+  BOOST_CHECK_THROW(doubles.promote(DBDataset::kLONG), cet::exception);
+}
+
+BOOST_AUTO_TEST_CASE(dataset_access)
+{
+  lariov::IOVTimeStamp const begin(100, 0);
+  lariov::IOVTimeStamp const end(200, 0);
+  DBDataset data = makeDataset(begin, end, {"1.5", "2.5", "4.5"});
+  BOOST_TEST(data.nrows() == 3U);
+  BOOST_TEST(data.ncols() == 4U);
+  BOOST_TEST(data.getRowNumber(4) == 2);
+  BOOST_TEST(data.getRowNumber(3) == -1);
+  BOOST_TEST(data.getColNumber("gain") == 2);
+  BOOST_TEST(data.getRow(1).getDoubleData(2) == 2.5);
+  BOOST_TEST(data.getRow(1).getStringData(3) == "b");
+  BOOST_TEST(data.getLongColumn(1)[2] == 40);
+  BOOST_TEST(data.getDoubleColumn(2)[0] == 1.5);
+  BOOST_CHECK_THROW(data.getLongColumn(2), cet::exception);
+  BOOST_CHECK_THROW(data.getRow(0).getLongData(2), cet::exception);
+}
+
+BOOST_AUTO_TEST_CASE(fingerprint_excludes_iov)
+{
+  lariov::IOVTimeStamp const t100(100, 0);
+  lariov::IOVTimeStamp const t200(200, 0);
+  lariov::IOVTimeStamp const t300(300, 0);
+  DBDataset data1 = makeDataset(t100, t200, {"1.5", "2.5", "4.5"});
+  DBDataset data2 = makeDataset(t200, t300, {"1.5", "2.5", "4.5"});
+  DBDataset data3 = makeDataset(t200, t300, {"1.5", "2.5", "4.25"});
+  BOOST_TEST(data1.fingerprint() != 0U);
+  BOOST_TEST(data1.fingerprint() == data2.fingerprint());
+  BOOST_TEST(data1.fingerprint() != data3.fingerprint());
+  BOOST_TEST(data1.schemaID() == data3.schemaID());
+}
@@ -0,0 +1,233 @@
+/**
+ * @file   DBDiskCache_test.cxx
+ * @brief  Test of the node-local payload cache lariov::DBDiskCache
+ * @date   October 18th, 2026
+ */
+
+// Boost libraries
+#define BOOST_TEST_MODULE (dbdiskcache_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "ConditionsStandInServer.h"
+#include "larevt/CalibrationDBI/Providers/DBDatasetImage.h"
+#include "larevt/CalibrationDBI/Providers/DBDiskCache.h"
+#include "larevt/CalibrationDBI/Providers/DBFolder.h"
+
+// C/C++ standard library
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+  using lariov::DBDataset;
+  using lariov::DBDiskCache;
+  using lariov::IOVTimeStamp;
+  namespace fs = std::filesystem;
+
+  constexpr unsigned long kFirstTime = 1600000000; // Seconds since epoch.
+  constexpr unsigned long kIOVLength = 3600;       // Seconds.
+
+  // Dataset of 100 channels valid in [begin, end).
+
+  DBDataset makeDataset(unsigned long begin, IOVTimeStamp const& end)
+  {
+    std::vector<lariov::DBChannelID_t> channels;
+    std::vector<std::int64_t> channel_values;
+    std::vector<double> values;
+    for (int i = 0; i < 100; ++i) {
+      channels.push_back(i);
+      channel_values.push_back(i);
+      values.push_back(begin + 0.5 * i);
+    }
+    std::vector<DBDataset::Column> columns;
+    columns.emplace_back(std::move(channel_values));
+    columns.emplace_back(std::move(values));
+    return DBDataset(IOVTimeStamp(begin, 0),
+                     end,
+                     {"channel", "value"},
+                     {"integer", "real"},
+                     std::move(channels),
+                     std::move(columns));
+  }
+
+  // Cache files (including temporary files) under a directory.
+
+  std::vector<fs::path> listFiles(const fs::path& dir)
+  {
+    std::vector<fs::path> files;
+    for (const auto& entry : fs::recursive_directory_iterator(dir))
+      if (entry.is_regular_file()) files.push_back(entry.path());
+    return files;
+  }
+
+  // Total size of the files under a directory.
+
+  std::uint64_t totalSize(const fs::path& dir)
+  {
+    std::uint64_t total = 0;
+    for (const auto& path : listFiles(dir))
+      total += fs::file_size(path);
+    return total;
+  }
+
+  // Scratch directory, removed at the end of the test.
+
+  struct ScratchDir {
+    fs::path path =
+      fs::temp_directory_path() / ("DBDiskCache_test." + std::to_string(getpid()));
+    ScratchDir() { fs::create_directories(path); }
+    ~ScratchDir() { fs::remove_all(path); }
+  };
+
+} // local namespace
+
+BOOST_AUTO_TEST_CASE(store_find_round_trip)
+{
+  ScratchDir dir;
+  DBDiskCache cache(dir.path.string(), "http://server", "pedestals", "v1", 1 << 20);
+  DBDataset const data = makeDataset(100, IOVTimeStamp(200, 0));
+  cache.Store(data);
+
+  DBDataset found;
+  BOOST_TEST(cache.Find(IOVTimeStamp(150, 0), found));
+  BOOST_TEST((found.beginTime() == data.beginTime()));
+  BOOST_TEST((found.endTime() == data.endTime()));
+  BOOST_TEST(found.fingerprint() == data.fingerprint());
+  BOOST_TEST(found.getRow(7).getDoubleData(1) == 103.5);
+  BOOST_TEST(!cache.Find(IOVTimeStamp(200, 0), found));
+  BOOST_TEST(!cache.Contains(IOVTimeStamp(99, 0)));
+
+  // Another process (here: another instance) finds the stored payload.
+
+  DBDiskCache other(dir.path.string(), "http://server", "pedestals", "v1", 1 << 20);
+  BOOST_TEST(other.Directory() == cache.Directory());
+  BOOST_TEST(other.Contains(IOVTimeStamp(100, 0)));
+
+  // Another tag has its own directory.
+
+  DBDiskCache tag2(dir.path.string(), "http://server", "pedestals", "v2", 1 << 20);
+  BOOST_TEST(tag2.Directory() != cache.Directory());
+  BOOST_TEST(!tag2.Contains(IOVTimeStamp(150, 0)));
+
+  // Open-ended IOVs are not stored.
+
+  cache.Store(makeDataset(200, IOVTimeStamp::MaxTimeStamp()));
+  BOOST_TEST(!cache.Contains(IOVTimeStamp(250, 0)));
+  BOOST_TEST(listFiles(dir.path).size() == 1U);
+}
+
+BOOST_AUTO_TEST_CASE(lru_eviction)
+{
+  ScratchDir dir;
+  std::uint64_t const size = lariov::DatasetImageSize(makeDataset(100, IOVTimeStamp(200, 0)));
+  std::uint64_t const max_bytes = 2 * size + size / 2; // Room for two files.
+  DBDiskCache cache(dir.path.string(), "http://server", "pedestals", "v1", max_bytes);
+  cache.Store(makeDataset(100, IOVTimeStamp(200, 0)));
+  cache.Store(makeDataset(200, IOVTimeStamp(300, 0)));
+
+  // The first payload is older, but was used more recently.
+
+  auto const now = fs::file_time_type::clock::now();
+  std::vector<fs::path> files = listFiles(dir.path);
+  BOOST_TEST_REQUIRE(files.size() == 2U);
+  for (const auto& path : files) {
+    bool const first = path.filename().string().rfind(IOVTimeStamp(100, 0).DBStamp(), 0) == 0;
+    fs::last_write_time(path, now - std::chrono::hours(first ? 3 : 2));
+  }
+  DBDataset found;
+  BOOST_TEST(cache.Find(IOVTimeStamp(100, 0), found));
+
+  // Storing a third payload evicts the least recently used one.
+
+  cache.Store(makeDataset(300, IOVTimeStamp(400, 0)));
+  DBDiskCache other(dir.path.string(), "http://server", "pedestals", "v1", max_bytes);
+  BOOST_TEST(other.Contains(IOVTimeStamp(100, 0)));
+  BOOST_TEST(!other.Contains(IOVTimeStamp(200, 0)));
+  BOOST_TEST(other.Contains(IOVTimeStamp(300, 0)));
+
+  // The size limit holds over many stores, counting files of other folders.
+
+  DBDiskCache folder2(dir.path.string(), "http://server", "gains", "v1", max_bytes);
+  folder2.Store(makeDataset(100, IOVTimeStamp(200, 0)));
+  DBDiskCache cache2(dir.path.string(), "http://server", "pedestals", "v1", max_bytes);
+  for (unsigned long t = 400; t < 1400; t += 100) {
+    cache2.Store(makeDataset(t, IOVTimeStamp(t + 100, 0)));
+    BOOST_TEST(totalSize(dir.path) <= max_bytes);
+  }
+  BOOST_TEST(cache2.Contains(IOVTimeStamp(1300, 0)));
+  BOOST_TEST(cache2.Contains(IOVTimeStamp(1200, 0)));
+}
+
+BOOST_AUTO_TEST_CASE(untagged_folder_skipped)
+{
+  ScratchDir dir;
+  lariov::test::ConditionsStandInServer server;
+  server.AddSyntheticFolder("pedestals", 10, 3, kFirstTime, kIOVLength);
+  lariov::DBTimeStamp_t const raw_time = (kFirstTime + 10) * 1000000000ULL;
+
+  lariov::DBFolder untagged("pedestals", server.URL(), "");
+  untagged.SetDiskCache(dir.path.string(), 1 << 20);
+  BOOST_TEST(untagged.UpdateData(raw_time));
+  BOOST_TEST(listFiles(dir.path).empty());
+
+  lariov::DBFolder tagged("pedestals", server.URL(), "", "v1");
+  tagged.SetDiskCache(dir.path.string(), 1 << 20);
+  BOOST_TEST(tagged.UpdateData(raw_time));
+  BOOST_TEST(listFiles(dir.path).size() == 1U);
+
+  // A second job reads the payload from the cache, without an http request.
+
+  unsigned long const requests = server.Requests();
+  lariov::DBFolder tagged2("pedestals", server.URL(), "", "v1");
+  tagged2.SetDiskCache(dir.path.string(), 1 << 20);
+  BOOST_TEST(tagged2.UpdateData(raw_time));
+  BOOST_TEST(server.Requests() == requests);
+  BOOST_TEST(tagged2.CachedFingerprint() == tagged.CachedFingerprint());
+}
+
+BOOST_AUTO_TEST_CASE(interrupted_write)
+{
+  ScratchDir dir;
+  DBDiskCache cache(dir.path.string(), "http://server", "pedestals", "v1", 1 << 20);
+  DBDataset const data = makeDataset(100, IOVTimeStamp(200, 0));
+  std::string const name =
+    IOVTimeStamp(100, 0).DBStamp() + "_" + IOVTimeStamp(200, 0).DBStamp() + ".dbds";
+
+  // A writer killed before the rename leaves only a temporary file, which is
+  // not visible as a cache entry.
+
+  fs::path const final_path = fs::path(cache.Directory()) / name;
+  fs::path const temp_path = fs::path(cache.Directory()) / (".tmp." + name + ".1.0");
+  lariov::WriteDatasetFile(data, final_path.string());
+  fs::resize_file(final_path, fs::file_size(final_path) / 2);
+  fs::rename(final_path, temp_path);
+  DBDataset found;
+  BOOST_TEST(!cache.Contains(IOVTimeStamp(150, 0)));
+  BOOST_TEST(!cache.Find(IOVTimeStamp(150, 0), found));
+
+  // A truncated file under the final name (e.g. copied in by hand) is a miss,
+  // and is removed.
+
+  fs::copy_file(temp_path, final_path);
+  DBDiskCache other(dir.path.string(), "http://server", "pedestals", "v1", 1 << 20);
+  BOOST_TEST(other.Contains(IOVTimeStamp(150, 0)));
+  BOOST_TEST(!other.Find(IOVTimeStamp(150, 0), found));
+  BOOST_TEST(!fs::exists(final_path));
+
+  // Storing the payload makes it visible, and leaves no temporary file of its own.
+  // The temporary file left by the crashed writer is removed once it is stale.
+
+  fs::last_write_time(temp_path, fs::file_time_type::clock::now() - std::chrono::hours(2));
+  other.Store(data);
+  BOOST_TEST(other.Find(IOVTimeStamp(150, 0), found));
+  BOOST_TEST(found.fingerprint() == data.fingerprint());
+  std::vector<fs::path> const files = listFiles(dir.path);
+  BOOST_TEST(files.size() == 1U);
+  BOOST_TEST(files.front() == final_path);
+}
@@ -0,0 +1,221 @@
+/**
+ * @file   DBFolderCompare_test.cxx
+ * @brief  Test of the test mode dataset comparison lariov::DBFolder::CompareDataset
+ * @date   October 18th, 2026
+ */
+
+// Boost libraries
+#define BOOST_TEST_MODULE (dbfoldercompare_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "larevt/CalibrationDBI/Providers/DBFolder.h"
+
+// framework libraries
+#include "cetlib_except/exception.h"
+
+// C/C++ standard library
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+
+  using lariov::DBDataset;
+  using lariov::IOVTimeStamp;
+
+  constexpr size_t kRows = 10;
+
+  // Values of a dataset with channel, status, gain and name columns.
+
+  struct Values {
+    IOVTimeStamp begin{100, 0};
+    IOVTimeStamp end{200, 0};
+    std::vector<std::string> names{"channel", "status", "gain", "name"};
+    std::vector<std::string> types{"integer", "integer", "real", "text"};
+    std::vector<lariov::DBChannelID_t> channels;
+    std::vector<std::int64_t> status;
+    std::vector<double> gain;
+    std::vector<std::string> label;
+
+    Values()
+    {
+      for (size_t i = 0; i < kRows; ++i) {
+        channels.push_back(10 * i);
+        status.push_back(i % 3);
+        gain.push_back(1. + 0.25 * i);
+        label.push_back("ch" + std::to_string(i));
+      }
+    }
+
+    DBDataset dataset(std::uint64_t fingerprint = 0) const
+    {
+      std::vector<DBDataset::Column> columns;
+      columns.emplace_back(std::vector<std::int64_t>(channels.begin(), channels.end()));
+      columns.emplace_back(std::vector<std::int64_t>(status));
+      columns.emplace_back(std::vector<double>(gain));
+      columns.emplace_back(DBDataset::kSTRING);
+      for (auto const& text : label)
+        columns.back().pushString(text);
+      return DBDataset(begin,
+                       end,
+                       std::vector<std::string>(names),
+                       std::vector<std::string>(types),
+                       std::vector<lariov::DBChannelID_t>(channels),
+                       std::move(columns),
+                       nullptr,
+                       fingerprint);
+    }
+  };
+
+  // Message of the comparison failure (empty if the datasets compare equal).
+
+  std::string compareError(lariov::DBFolder const& folder,
+                           DBDataset const& data1,
+                           DBDataset const& data2)
+  {
+    try {
+      BOOST_TEST(folder.CompareDataset(data1, data2));
+    }
+    catch (cet::exception const& e) {
+      return e.what();
+    }
+    return "";
+  }
+
+  bool contains(std::string const& text, std::string const& part)
+  {
+    return text.find(part) != std::string::npos;
+  }
+
+  size_t count(std::string const& text, std::string const& part)
+  {
+    size_t n = 0;
+    for (size_t pos = text.find(part); pos != std::string::npos; pos = text.find(part, pos + 1))
+      ++n;
+    return n;
+  }
+
+} // local namespace
+
+BOOST_AUTO_TEST_CASE(identical_datasets)
+{
+  lariov::DBFolder const folder("pedestals", "http://server", "");
+  Values const values;
+  DBDataset const data = values.dataset();
+  BOOST_TEST(compareError(folder, data, values.dataset()) == "");
+
+  // Equal fingerprints are trusted: the values are not compared.
+
+  Values changed;
+  changed.gain[3] = 100.;
+  BOOST_TEST(compareError(folder, data, changed.dataset(data.fingerprint())) == "");
+
+  // The IOV is not part of the fingerprint, and is always compared.
+
+  changed = values;
+  changed.end = IOVTimeStamp(300, 0);
+  std::string const error = compareError(folder, data, changed.dataset());
+  BOOST_TEST(contains(error, "End time mismatch"));
+  BOOST_TEST(contains(error, "pedestals"));
+}
+
+BOOST_AUTO_TEST_CASE(real_tolerance)
+{
+  lariov::DBFolder folder("pedestals", "http://server", "");
+  Values const values;
+  DBDataset const data = values.dataset();
+
+  // Within the default relative tolerance (1e-9).
+
+  Values close = values;
+  for (double& gain : close.gain)
+    gain *= 1. + 1.e-12;
+  BOOST_TEST(compareError(folder, data, close.dataset()) == "");
+
+  // Outside the default tolerance, within a looser one.
+
+  Values off = values;
+  off.gain[2] *= 1. + 1.e-6;
+  BOOST_TEST(contains(compareError(folder, data, off.dataset()), "Column gain: 1 of 10"));
+  folder.SetCompareTolerance(1.e-5);
+  BOOST_TEST(compareError(folder, data, off.dataset()) == "");
+  off.gain[2] = values.gain[2] * (1. + 1.e-4);
+  BOOST_TEST(contains(compareError(folder, data, off.dataset()), "Column gain: 1 of 10"));
+
+  // NaN equals NaN.
+
+  Values nan1 = values;
+  nan1.gain[0] = std::nan("");
+  Values nan2 = nan1;
+  nan2.gain[1] = 3.;
+  BOOST_TEST(compareError(folder, nan1.dataset(), nan1.dataset()) == "");
+  BOOST_TEST(contains(compareError(folder, nan1.dataset(), nan2.dataset()), "1 of 10"));
+}
+
+BOOST_AUTO_TEST_CASE(schema_and_iov_mismatch)
+{
+  lariov::DBFolder const folder("pedestals", "http://server", "");
+  Values const values;
+  DBDataset const data = values.dataset();
+
+  Values other = values;
+  other.begin = IOVTimeStamp(101, 0);
+  BOOST_TEST(contains(compareError(folder, data, other.dataset()), "Begin time mismatch"));
+
+  other = values;
+  other.names[2] = "gain2";
+  BOOST_TEST(contains(compareError(folder, data, other.dataset()), "Name mismatch gain vs. gain2"));
+
+  // Integer types of different names match, real and integer don't.
+
+  other = values;
+  other.types[1] = "bigint";
+  BOOST_TEST(compareError(folder, data, other.dataset()) == "");
+  other.types[2] = "integer";
+  BOOST_TEST(contains(compareError(folder, data, other.dataset()), "Type mismatch"));
+
+  // Channels.
+
+  other = values;
+  other.channels[4] = 41;
+  BOOST_TEST(
+    contains(compareError(folder, data, other.dataset()), "Channel mismatch 40 vs. 41 in row 4"));
+  other = values;
+  other.channels.pop_back();
+  other.status.pop_back();
+  other.gain.pop_back();
+  other.label.pop_back();
+  BOOST_TEST(contains(compareError(folder, data, other.dataset()), "Number of rows mismatch"));
+}
+
+BOOST_AUTO_TEST_CASE(summary_and_examples)
+{
+  lariov::DBFolder const folder("pedestals", "http://server", "");
+  Values const values;
+  DBDataset const data = values.dataset();
+
+  // Eight gains (channels 20 to 90) and one name differ.
+
+  Values other = values;
+  for (size_t i = 2; i < kRows; ++i)
+    other.gain[i] += 0.5 * i;
+  other.label[7] = "x";
+  std::string const error = compareError(folder, data, other.dataset());
+
+  BOOST_TEST(!contains(error, "Column channel"));
+  BOOST_TEST(!contains(error, "Column status"));
+  BOOST_TEST(contains(error, "Column gain: 8 of 10 values differ (max abs. difference 4.5)"));
+  BOOST_TEST(contains(error, "Column name: 1 of 10 values differ"));
+  BOOST_TEST(contains(error, "channel 70: \"ch7\" vs. \"x\""));
+
+  // The first five mismatching gains are listed.
+
+  std::string const gain_report = error.substr(0, error.find("Column name"));
+  BOOST_TEST(count(gain_report, "\n  channel ") == 5U);
+  BOOST_TEST(contains(gain_report, "channel 20: 1.5 vs. 2.5"));
+  BOOST_TEST(contains(gain_report, "channel 60: 2.5 vs. 5.5"));
+  BOOST_TEST(!contains(gain_report, "channel 70:"));
+  BOOST_TEST(!contains(gain_report, "channel 10:"));
+}
@@ -0,0 +1,184 @@
+/**
+ * @file   DBFolderLoad_benchmark.cxx
+ * @brief  Load benchmark of DBFolder against a localhost stand-in server
+ * @date   October 18th, 2026
+ *
+ * A `lariov::test::ConditionsStandInServer` serves synthetic pedestal-like
+ * folders.  For each combination of channel count and IOV count, a job-like
+ * sequence of event times spanning all IOVs is replayed through
+ * `DBFolder::UpdateData()`, and after each update a
+ * `Snapshot<DetPedestal>` is rebuilt from the folder columns, as the
+ * providers do in `DBUpdate()`.
+ *
+ * Reported per configuration: number of IOVs loaded, mean http fetch and
+ * parse times per IOV (from `DBMetrics`), mean snapshot build time per IOV,
+ * and the overall throughput in channel rows per second.
+ *
+ * Usage: DBFolderLoad_benchmark [options]
+ *
+ * --channels <n,n,...>   Channel counts (default: 1000,10000).
+ * --iovs <n,n,...>       Number of IOVs spanned by the job (default: 1,10).
+ * --events <n>           Number of events per job (default: 100).
+ * --changed <fraction>   Fraction of channels changed at each IOV (default: 0.05).
+ * --latency <s>          Injected server latency (default: 0).
+ * --error-rate <p>       Injected server error probability (default: 0); failed
+ *                        requests are retried.
+ */
+
+// LArSoft libraries
+#include "ConditionsStandInServer.h"
+#include "larevt/CalibrationDBI/IOVData/DetPedestal.h"
+#include "larevt/CalibrationDBI/IOVData/Snapshot.h"
+#include "larevt/CalibrationDBI/Providers/DBFolder.h"
+#include "larevt/CalibrationDBI/Providers/DBMetrics.h"
+
+// C/C++ standard library
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+  constexpr unsigned long kFirstTime = 1600000000; // Seconds since epoch.
+  constexpr unsigned long kIOVLength = 3600;       // Seconds.
+
+  std::vector<size_t> parseList(const std::string& list)
+  {
+    std::vector<size_t> result;
+    std::istringstream in(list);
+    std::string item;
+    while (std::getline(in, item, ','))
+      result.push_back(std::strtoul(item.c_str(), nullptr, 10));
+    return result;
+  }
+
+  double seconds(std::chrono::steady_clock::duration d)
+  {
+    return std::chrono::duration<double>(d).count();
+  }
+
+  // Rebuild pedestal snapshot from the current folder dataset.
+
+  void buildSnapshot(lariov::DBFolder& folder, lariov::Snapshot<lariov::DetPedestal>& snapshot)
+  {
+    lariov::DBFolder::ColumnHandle<double> mean_column("mean");
+    lariov::DBFolder::ColumnHandle<double> mean_err_column("mean_err");
+    lariov::DBFolder::ColumnHandle<double> rms_column("rms");
+    lariov::DBFolder::ColumnHandle<double> rms_err_column("rms_err");
+    auto const& channels = folder.Channels();
+    auto const& mean = folder.ResolveColumn(mean_column);
+    auto const& mean_err = folder.ResolveColumn(mean_err_column);
+    auto const& rms = folder.ResolveColumn(rms_column);
+    auto const& rms_err = folder.ResolveColumn(rms_err_column);
+    lariov::Snapshot<lariov::DetPedestal>::Builder builder;
+    builder.Reserve(channels.size());
+    for (size_t i = 0; i < channels.size(); ++i) {
+      lariov::DetPedestal pd(channels[i]);
+      pd.SetPedMean((float)mean[i]);
+      pd.SetPedMeanErr((float)mean_err[i]);
+      pd.SetPedRms((float)rms[i]);
+      pd.SetPedRmsErr((float)rms_err[i]);
+      builder.Append(pd);
+    }
+    builder.Finalize(snapshot);
+    snapshot.SetIoV(folder.CachedStart(), folder.CachedEnd());
+  }
+}
+
+int main(int argc, char** argv)
+{
+  std::vector<size_t> channel_counts{1000, 10000};
+  std::vector<size_t> iov_counts{1, 10};
+  size_t nevents = 100;
+  double changed = 0.05;
+  double latency = 0.;
+  double error_rate = 0.;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string const arg = argv[i];
+    if (arg == "--channels")
+      channel_counts = parseList(argv[i + 1]);
+    else if (arg == "--iovs")
+      iov_counts = parseList(argv[i + 1]);
+    else if (arg == "--events")
+      nevents = std::strtoul(argv[i + 1], nullptr, 10);
+    else if (arg == "--changed")
+      changed = std::strtod(argv[i + 1], nullptr);
+    else if (arg == "--latency")
+      latency = std::strtod(argv[i + 1], nullptr);
+    else if (arg == "--error-rate")
+      error_rate = std::strtod(argv[i + 1], nullptr);
+    else {
+      std::cerr << "Unknown option " << arg << "\n";
+      return 2;
+    }
+  }
+  if (nevents == 0) nevents = 1;
+
+  lariov::test::ConditionsStandInServer server;
+  server.SetLatency(latency);
+  server.SetErrorRate(error_rate);
+  auto& metrics = lariov::DBMetrics::Instance();
+
+  std::cout << std::setw(9) << "channels" << std::setw(6) << "iovs" << std::setw(8) << "loaded"
+            << std::setw(12) << "http [ms]" << std::setw(12) << "parse [ms]" << std::setw(12)
+            << "build [ms]" << std::setw(14) << "rows/s" << "\n";
+  for (size_t nchannels : channel_counts) {
+    for (size_t niovs : iov_counts) {
+      std::string const name = "bench_" + std::to_string(nchannels) + "_" + std::to_string(niovs);
+      server.AddSyntheticFolder(name, nchannels, niovs, kFirstTime, kIOVLength, changed);
+
+      lariov::DBFolder folder(name, server.URL(), "");
+      folder.SetRetries(error_rate > 0. ? 10 : 0, 0.01);
+      lariov::Snapshot<lariov::DetPedestal> snapshot;
+
+      double update_seconds = 0.;
+      double build_seconds = 0.;
+      unsigned int loaded = 0;
+      unsigned int expected = 0; // Number of distinct IOVs visited.
+      size_t last_iov = niovs;
+
+      // Event times uniformly spanning all IOVs.
+
+      for (size_t event = 0; event < nevents; ++event) {
+        unsigned long const t = kFirstTime + (niovs * kIOVLength * event) / nevents;
+        size_t const iov = (t - kFirstTime) / kIOVLength;
+        if (iov != last_iov) ++expected;
+        last_iov = iov;
+        lariov::DBTimeStamp_t const raw_time = t * 1000000000ULL;
+        auto start = std::chrono::steady_clock::now();
+        bool const updated = folder.UpdateData(raw_time);
+        auto fetched = std::chrono::steady_clock::now();
+        if (updated) {
+          buildSnapshot(folder, snapshot);
+          ++loaded;
+        }
+        auto built = std::chrono::steady_clock::now();
+        update_seconds += seconds(fetched - start);
+        build_seconds += seconds(built - fetched);
+      }
+
+      if (snapshot.NChannels() != nchannels || loaded != expected) {
+        std::cerr << "Folder " << name << ": loaded " << loaded << " IOVs with "
+                  << snapshot.NChannels() << " channels, expected " << expected << " IOVs with "
+                  << nchannels << " channels.\n";
+        return 1;
+      }
+
+      auto const& http = metrics.GetHistogram(name, "http_time");
+      auto const& parse = metrics.GetHistogram(name, "http_parse_time");
+      double const rows_per_second = nchannels * loaded / (update_seconds + build_seconds);
+      std::cout << std::fixed << std::setprecision(2) << std::setw(9) << nchannels
+                << std::setw(6) << niovs << std::setw(8) << loaded << std::setw(12)
+                << http.Mean() / 1e3 << std::setw(12) << parse.Mean() / 1e3 << std::setw(12)
+                << 1e3 * build_seconds / loaded << std::setw(14) << std::setprecision(0)
+                << rows_per_second << "\n";
+    }
+  }
+  std::cout << "Server requests: " << server.Requests() << ", errors: " << server.Errors()
+            << "\n";
+  return 0;
+}
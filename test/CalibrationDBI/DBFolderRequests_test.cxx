@@ -0,0 +1,172 @@
+/**
+ * @file   DBFolderRequests_test.cxx
+ * @brief  Test of retried and hedged http requests of lariov::DBFolder
+ * @date   October 18th, 2026
+ *
+ * Requests are served by two localhost stand-ins for the conditions database
+ * server, the primary and the secondary one, which serve the same folder and
+ * can be made to fail or to answer slowly.
+ */
+
+// Boost libraries
+#define BOOST_TEST_MODULE (dbfolderrequests_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "ConditionsStandInServer.h"
+#include "larevt/CalibrationDBI/Providers/DBFolder.h"
+#include "larevt/CalibrationDBI/Providers/WebError.h"
+
+// C/C++ standard library
+#include <chrono>
+#include <cstdint>
+
+namespace {
+
+  constexpr unsigned long kFirstTime = 1600000000; // Seconds since epoch.
+  constexpr unsigned long kIOVLength = 3600;       // Seconds.
+
+  // Raw event time in the middle of an IOV.
+
+  lariov::DBTimeStamp_t eventTime(size_t iov)
+  {
+    return (kFirstTime + iov * kIOVLength + kIOVLength / 2) * 1000000000ULL;
+  }
+
+  // Primary and secondary servers.
+
+  struct Servers {
+    lariov::test::ConditionsStandInServer primary;
+    lariov::test::ConditionsStandInServer secondary;
+
+    Servers()
+    {
+      primary.AddSyntheticFolder("pedestals", 100, 3, kFirstTime, kIOVLength);
+      secondary.AddSyntheticFolder("pedestals", 100, 3, kFirstTime, kIOVLength);
+    }
+
+    // Fingerprint of the payload of an IOV.
+
+    std::uint64_t fingerprint(size_t iov) const
+    {
+      lariov::DBFolder folder("pedestals", secondary.URL(), "");
+      folder.UpdateData(eventTime(iov));
+      return folder.CachedFingerprint();
+    }
+  };
+
+  // Seconds taken by an update.
+
+  double timedUpdate(lariov::DBFolder& folder, lariov::DBTimeStamp_t time)
+  {
+    auto const start = std::chrono::steady_clock::now();
+    folder.UpdateData(time);
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+
+} // local namespace
+
+BOOST_FIXTURE_TEST_SUITE(requests, Servers)
+
+BOOST_AUTO_TEST_CASE(retry_after_failures)
+{
+  lariov::DBFolder folder("pedestals", primary.URL(), "");
+  folder.SetRetries(3, 0.05);
+  primary.FailNext(2);
+
+  // Retries wait 0.5 to 1 times 0.05 s, then 0.1 s.
+
+  double const seconds = timedUpdate(folder, eventTime(0));
+  BOOST_TEST(folder.Retries() == 2U);
+  BOOST_TEST(primary.Requests() == 3U);
+  BOOST_TEST(primary.Errors() == 2U);
+  BOOST_TEST(seconds >= 0.075);
+  BOOST_TEST(seconds < 5.);
+  BOOST_TEST(folder.CachedFingerprint() == fingerprint(0));
+}
+
+BOOST_AUTO_TEST_CASE(retries_exhausted)
+{
+  lariov::DBFolder folder("pedestals", primary.URL(), "");
+
+  // Without retries, the first failure is final.
+
+  primary.FailNext(1);
+  BOOST_CHECK_THROW(folder.UpdateData(eventTime(0)), lariov::WebError);
+  BOOST_TEST(primary.Requests() == 1U);
+  BOOST_TEST(folder.Retries() == 0U);
+
+  // With two retries, the third failure is final.
+
+  folder.SetRetries(2, 0.01);
+  primary.FailNext(3);
+  BOOST_CHECK_THROW(folder.UpdateData(eventTime(0)), lariov::WebError);
+  BOOST_TEST(primary.Requests() == 4U);
+  BOOST_TEST(folder.Retries() == 2U);
+
+  // The server is back.
+
+  BOOST_TEST(folder.UpdateData(eventTime(0)));
+  BOOST_TEST(folder.CachedFingerprint() == fingerprint(0));
+}
+
+BOOST_AUTO_TEST_CASE(hedge_slow_primary)
+{
+  lariov::DBFolder folder("pedestals", primary.URL(), secondary.URL());
+  folder.SetHedging(0.9, 0.05);
+  primary.SetLatency(1.);
+
+  // The secondary server answers first, without waiting for the primary one.
+
+  double const seconds = timedUpdate(folder, eventTime(1));
+  BOOST_TEST(folder.HedgesIssued() == 1U);
+  BOOST_TEST(folder.HedgesWon() == 1U);
+  BOOST_TEST(seconds < 0.9);
+  BOOST_TEST(secondary.Requests() == 1U);
+  BOOST_TEST(folder.CachedFingerprint() == fingerprint(1));
+}
+
+BOOST_AUTO_TEST_CASE(hedge_failed_primary)
+{
+  lariov::DBFolder folder("pedestals", primary.URL(), secondary.URL());
+  folder.SetHedging(0.9, 5.);
+  primary.FailNext(1);
+
+  // A failure of the primary server is hedged at once, not after the delay,
+  // and needs no retry.
+
+  double const seconds = timedUpdate(folder, eventTime(1));
+  BOOST_TEST(folder.HedgesIssued() == 1U);
+  BOOST_TEST(folder.HedgesWon() == 1U);
+  BOOST_TEST(folder.Retries() == 0U);
+  BOOST_TEST(seconds < 4.);
+
+  // Both servers fail: the request is retried.
+
+  folder.SetRetries(1, 0.01);
+  primary.FailNext(1);
+  secondary.FailNext(1);
+  BOOST_TEST(folder.UpdateData(eventTime(2)));
+  BOOST_TEST(folder.Retries() == 1U);
+  BOOST_TEST(folder.CachedFingerprint() == fingerprint(2));
+}
+
+BOOST_AUTO_TEST_CASE(no_hedge_fast_primary)
+{
+  lariov::DBFolder folder("pedestals", primary.URL(), secondary.URL());
+  folder.SetHedging(0.9, 2.);
+  for (size_t iov = 0; iov < 3; ++iov)
+    BOOST_TEST(folder.UpdateData(eventTime(iov)));
+  BOOST_TEST(folder.HedgesIssued() == 0U);
+  BOOST_TEST(secondary.Requests() == 0U);
+
+  // Without hedging, the secondary url is not used even if the primary is slow.
+
+  lariov::DBFolder unhedged("pedestals", primary.URL(), secondary.URL());
+  primary.SetLatency(0.2);
+  BOOST_TEST(timedUpdate(unhedged, eventTime(0)) >= 0.2);
+  BOOST_TEST(unhedged.HedgesIssued() == 0U);
+  BOOST_TEST(secondary.Requests() == 0U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,240 @@
+/**
+ * @file   DBSharedCache_test.cxx
+ * @brief  Test of the node-wide shared memory cache lariov::DBSharedCache
+ * @date   October 18th, 2026
+ *
+ * Segments are created with a name prefix unique to the test process, so that
+ * neither naming nor eviction interferes with caches of real jobs on the node.
+ */
+
+// Boost libraries
+#define BOOST_TEST_MODULE (dbsharedcache_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "larevt/CalibrationDBI/Providers/DBDatasetImage.h"
+#include "larevt/CalibrationDBI/Providers/DBSharedCache.h"
+
+// C/C++ standard library
+#include <cstdint>
+#include <fcntl.h>
+#include <filesystem>
+#include <string>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+  using lariov::DBDataset;
+  using lariov::DBSharedCache;
+  using lariov::IOVTimeStamp;
+
+  std::string const kURL = "http://server";
+
+  // Segment name prefix unique to this process.
+
+  std::string const kSegmentPrefix = "lariovtest-" + std::to_string(getpid()) + "-";
+
+  // Dataset of 100 channels valid in [begin, end).
+
+  DBDataset makeDataset(unsigned long begin, unsigned long end)
+  {
+    std::vector<lariov::DBChannelID_t> channels;
+    std::vector<std::int64_t> channel_values;
+    std::vector<double> values;
+    for (int i = 0; i < 100; ++i) {
+      channels.push_back(i);
+      channel_values.push_back(i);
+      values.push_back(begin + 0.5 * i);
+    }
+    std::vector<DBDataset::Column> columns;
+    columns.emplace_back(std::move(channel_values));
+    columns.emplace_back(std::move(values));
+    return DBDataset(IOVTimeStamp(begin, 0),
+                     IOVTimeStamp(end, 0),
+                     {"channel", "value"},
+                     {"integer", "real"},
+                     std::move(channels),
+                     std::move(columns));
+  }
+
+  DBSharedCache makeCache(std::uint64_t max_bytes = 1 << 20,
+                          std::string const& folder = "pedestals")
+  {
+    return DBSharedCache(kURL, folder, "v1", max_bytes, kSegmentPrefix);
+  }
+
+  bool segmentExists(std::string const& name)
+  {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+    close(fd);
+    return true;
+  }
+
+  // Sets the modification time of a segment to the specified number of
+  // seconds in the past.
+
+  void age(std::string const& name, time_t seconds)
+  {
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    BOOST_TEST_REQUIRE(fd >= 0);
+    struct timespec times[2];
+    times[0].tv_sec = times[1].tv_sec = time(nullptr) - seconds;
+    times[0].tv_nsec = times[1].tv_nsec = 0;
+    futimens(fd, times);
+    close(fd);
+  }
+
+  // Removes the segments of the test at the end of each test case.
+
+  struct SegmentCleanup {
+    ~SegmentCleanup()
+    {
+      for (auto const& entry : std::filesystem::directory_iterator("/dev/shm")) {
+        std::string const name = entry.path().filename().string();
+        if (name.compare(0, kSegmentPrefix.size(), kSegmentPrefix) == 0)
+          shm_unlink(("/" + name).c_str());
+      }
+    }
+  };
+
+} // local namespace
+
+BOOST_FIXTURE_TEST_SUITE(shared_cache, SegmentCleanup)
+
+BOOST_AUTO_TEST_CASE(store_find)
+{
+  DBSharedCache const cache = makeCache();
+  BOOST_TEST(cache.Prefix().compare(0, kSegmentPrefix.size() + 1, "/" + kSegmentPrefix) == 0);
+
+  DBDataset const data = makeDataset(100, 200);
+  DBDataset found;
+  BOOST_TEST(!cache.Find(data.beginTime(), found));
+  cache.Store(data);
+  BOOST_TEST(segmentExists(cache.SegmentName(data.beginTime())));
+  BOOST_TEST_REQUIRE(cache.Find(data.beginTime(), found));
+  BOOST_TEST((found.endTime() == data.endTime()));
+  BOOST_TEST(found.fingerprint() == data.fingerprint());
+  BOOST_TEST(found.getRow(7).getDoubleData(1) == 103.5);
+  BOOST_TEST(found.getColumn(1).borrowed()); // Viewed in place.
+
+  // Lookups are by exact IOV begin time.
+
+  BOOST_TEST(!cache.Find(IOVTimeStamp(150, 0), found));
+
+  // Storing again is harmless, and open-ended IOVs are not stored.
+
+  cache.Store(data);
+  DBDataset const open_ended(IOVTimeStamp(200, 0), IOVTimeStamp::MaxTimeStamp(), {}, {}, {}, {});
+  cache.Store(open_ended);
+  BOOST_TEST(!segmentExists(cache.SegmentName(open_ended.beginTime())));
+}
+
+BOOST_AUTO_TEST_CASE(second_reader)
+{
+  DBSharedCache const writer = makeCache();
+  DBDataset const data = makeDataset(100, 200);
+  writer.Store(data);
+
+  // Another process (here: another instance) maps the same segment.
+
+  DBSharedCache const reader = makeCache();
+  BOOST_TEST(reader.SegmentName(data.beginTime()) == writer.SegmentName(data.beginTime()));
+  DBDataset found1;
+  DBDataset found2;
+  BOOST_TEST_REQUIRE(writer.Find(data.beginTime(), found1));
+  BOOST_TEST_REQUIRE(reader.Find(data.beginTime(), found2));
+  BOOST_TEST(found2.fingerprint() == data.fingerprint());
+  BOOST_TEST(found1.getDoubleColumn(1).data() != found2.getDoubleColumn(1).data());
+
+  // Another folder or tag uses other segments.
+
+  DBSharedCache const other = makeCache(1 << 20, "gains");
+  BOOST_TEST(!other.Find(data.beginTime(), found1));
+
+  // Mapped datasets stay valid after the segment is removed.
+
+  shm_unlink(writer.SegmentName(data.beginTime()).c_str());
+  BOOST_TEST(!reader.Find(data.beginTime(), found1));
+  BOOST_TEST(found2.getRow(99).getDoubleData(1) == 149.5);
+}
+
+BOOST_AUTO_TEST_CASE(stale_writer_reclaimed)
+{
+  DBSharedCache const cache = makeCache();
+  DBDataset const data = makeDataset(100, 200);
+  std::string const name = cache.SegmentName(data.beginTime());
+  std::uint64_t const size = 64 + lariov::DatasetImageSize(data);
+
+  // A writer that is still alive holds the lock: its segment is left alone.
+
+  int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+  BOOST_TEST_REQUIRE(fd >= 0);
+  BOOST_TEST_REQUIRE(flock(fd, LOCK_EX) == 0);
+  BOOST_TEST_REQUIRE(ftruncate(fd, size) == 0);
+  DBDataset found;
+  BOOST_TEST(!cache.Find(data.beginTime(), found));
+  BOOST_TEST(segmentExists(name));
+  cache.Store(data); // Another process is storing this IOV.
+  BOOST_TEST(!cache.Find(data.beginTime(), found));
+
+  // The writer dies (its lock is released) before marking the segment ready.
+
+  close(fd);
+  BOOST_TEST(!cache.Find(data.beginTime(), found));
+  BOOST_TEST(!segmentExists(name));
+  cache.Store(data);
+  BOOST_TEST(cache.Find(data.beginTime(), found));
+  BOOST_TEST(found.fingerprint() == data.fingerprint());
+
+  // A writer that died before sizing the segment: reclaimed only once it is old,
+  // since a new writer may not have taken the lock yet.
+
+  DBDataset const data2 = makeDataset(200, 300);
+  std::string const name2 = cache.SegmentName(data2.beginTime());
+  fd = shm_open(name2.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+  BOOST_TEST_REQUIRE(fd >= 0);
+  close(fd);
+  BOOST_TEST(!cache.Find(data2.beginTime(), found));
+  BOOST_TEST(segmentExists(name2));
+  age(name2, 3600);
+  BOOST_TEST(!cache.Find(data2.beginTime(), found));
+  BOOST_TEST(!segmentExists(name2));
+}
+
+BOOST_AUTO_TEST_CASE(size_bound_eviction)
+{
+  std::uint64_t const size = 64 + lariov::DatasetImageSize(makeDataset(100, 200));
+  std::uint64_t const max_bytes = 2 * size + size / 2; // Room for two segments.
+  DBSharedCache const cache = makeCache(max_bytes);
+  DBSharedCache const gains = makeCache(max_bytes, "gains");
+  cache.Store(makeDataset(100, 200));
+  gains.Store(makeDataset(100, 200));
+
+  // The pedestal segment is older, but was used more recently.
+
+  age(cache.SegmentName(IOVTimeStamp(100, 0)), 3 * 3600);
+  age(gains.SegmentName(IOVTimeStamp(100, 0)), 2 * 3600);
+  DBDataset found;
+  BOOST_TEST(cache.Find(IOVTimeStamp(100, 0), found));
+
+  // Storing a third segment (of any folder) evicts the least recently used one.
+
+  cache.Store(makeDataset(200, 300));
+  BOOST_TEST(segmentExists(cache.SegmentName(IOVTimeStamp(100, 0))));
+  BOOST_TEST(!segmentExists(gains.SegmentName(IOVTimeStamp(100, 0))));
+  BOOST_TEST(segmentExists(cache.SegmentName(IOVTimeStamp(200, 0))));
+
+  // Payloads larger than the limit are not stored.
+
+  DBSharedCache const tiny = makeCache(size - 1, "tiny");
+  tiny.Store(makeDataset(100, 200));
+  BOOST_TEST(!segmentExists(tiny.SegmentName(IOVTimeStamp(100, 0))));
+  BOOST_TEST(segmentExists(cache.SegmentName(IOVTimeStamp(200, 0))));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
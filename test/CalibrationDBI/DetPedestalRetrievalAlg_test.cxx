@@ -0,0 +1,321 @@
+/**
+ * @file   DetPedestalRetrievalAlg_test.cxx
+ * @brief  Test of lariov::DetPedestalRetrievalAlg and its folder updates
+ * @date   October 18th, 2026
+ *
+ * Pedestals are served by a localhost stand-in for the conditions database
+ * server, in two folders:
+ * - `pedestals`: all values change in each IOV; the pedestal mean of
+ *   channel `ch` in IOV `iov` is `1000 (iov + 1) + ch`;
+ * - `partial`: only a few channels change in some IOVs (see kChanges), and
+ *   the payload of IOV 2 is the same as the one of IOV 1.
+ */
+
+// Boost libraries
+#define BOOST_TEST_MODULE (detpedestalretrievalalg_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "ConditionsStandInServer.h"
+#include "larevt/CalibrationDBI/Providers/DBFolder.h"
+#include "larevt/CalibrationDBI/Providers/DetPedestalRetrievalAlg.h"
+
+// C/C++ standard library
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  using lariov::DetPedestalRetrievalAlg;
+
+  constexpr unsigned long kFirstTime = 1600000000; // Seconds since epoch.
+  constexpr unsigned long kIOVLength = 3600;       // Seconds.
+  constexpr size_t kIOVs = 4;
+  constexpr size_t kChannels = 50;
+
+  float expectedMean(size_t iov, lariov::DBChannelID_t ch)
+  {
+    return 1000. * (iov + 1) + ch;
+  }
+
+  // Channels changed in each IOV of the partial folder (all are set in IOV 0).
+
+  std::map<size_t, std::set<lariov::DBChannelID_t>> const kChanges{{1, {3, 17}},
+                                                                   {3, {5, 40}}};
+
+  // Last IOV of the partial folder, up to iov, in which a channel changed.
+
+  size_t lastChange(size_t iov, lariov::DBChannelID_t ch)
+  {
+    size_t last = 0;
+    for (auto const& [changed_iov, channels] : kChanges)
+      if (changed_iov <= iov && channels.count(ch)) last = changed_iov;
+    return last;
+  }
+
+  // IOV begin time.
+
+  lariov::IOVTimeStamp beginTime(size_t iov)
+  {
+    return lariov::IOVTimeStamp(kFirstTime + iov * kIOVLength, 0);
+  }
+
+  // Raw event time in the middle of an IOV.
+
+  lariov::DBTimeStamp_t eventTime(size_t iov)
+  {
+    return (kFirstTime + iov * kIOVLength + kIOVLength / 2) * 1000000000ULL;
+  }
+
+  // Stand-in server with the pedestal folders.
+
+  struct PedestalServer {
+    lariov::test::ConditionsStandInServer server;
+
+    PedestalServer()
+    {
+      std::vector<lariov::IOVTimeStamp> begin_times;
+      for (size_t iov = 0; iov < kIOVs; ++iov)
+        begin_times.push_back(beginTime(iov));
+      server.AddFolder("pedestals",
+                       begin_times,
+                       {"channel", "mean", "mean_err", "rms", "rms_err"},
+                       {"integer", "real", "real", "real", "real"},
+                       [](size_t iov, std::ostream& out) {
+                         for (size_t ch = 0; ch < kChannels; ++ch)
+                           out << ch << ',' << expectedMean(iov, ch) << ",0.5,2.5,0.1\n";
+                       });
+      server.AddFolder("partial",
+                       begin_times,
+                       {"channel", "mean", "mean_err", "rms", "rms_err"},
+                       {"integer", "real", "real", "real", "real"},
+                       [](size_t iov, std::ostream& out) {
+                         for (size_t ch = 0; ch < kChannels; ++ch) {
+                           size_t const last = lastChange(iov, ch);
+                           out << ch << ',' << 1000. + ch + 100. * last << ",0.5,2.5,"
+                               << 0.1 * last << '\n';
+                         }
+                       });
+    }
+  };
+
+  // Check that a provider holds the pedestals of an IOV.
+
+  template <class Provider>
+  void checkIOV(Provider const& provider, size_t iov)
+  {
+    BOOST_TEST(provider.PedMean(0) == expectedMean(iov, 0));
+    BOOST_TEST(provider.PedMean(kChannels - 1) == expectedMean(iov, kChannels - 1));
+    BOOST_TEST(provider.PedMeans()[7] == expectedMean(iov, 7));
+    BOOST_TEST(provider.PedRms(7) == 2.5f);
+  }
+
+  // Check that two providers hold the same pedestals.
+
+  template <class Provider1, class Provider2>
+  void checkSame(Provider1 const& provider1, Provider2 const& provider2)
+  {
+    for (lariov::DBChannelID_t ch = 0; ch < kChannels; ++ch) {
+      BOOST_TEST(provider1.PedMean(ch) == provider2.PedMean(ch));
+      BOOST_TEST(provider1.PedMeanErr(ch) == provider2.PedMeanErr(ch));
+      BOOST_TEST(provider1.PedRms(ch) == provider2.PedRms(ch));
+      BOOST_TEST(provider1.PedRmsErr(ch) == provider2.PedRmsErr(ch));
+    }
+    auto const means1 = provider1.PedMeans();
+    auto const means2 = provider2.PedMeans();
+    BOOST_TEST(std::equal(means1.begin(), means1.end(), means2.begin(), means2.end()));
+    auto const rms_errs1 = provider1.PedRmsErrs();
+    auto const rms_errs2 = provider2.PedRmsErrs();
+    BOOST_TEST(std::equal(rms_errs1.begin(), rms_errs1.end(), rms_errs2.begin(), rms_errs2.end()));
+  }
+
+} // local namespace
+
+BOOST_FIXTURE_TEST_SUITE(interleaved_iovs, PedestalServer)
+
+BOOST_AUTO_TEST_CASE(handles_keep_their_iov)
+{
+  DetPedestalRetrievalAlg alg("pedestals", server.URL(), "v1");
+
+  // Events of IOVs 0, 1, 0, 2, 1, as processed by concurrent schedules.
+  // The legacy accessors follow the latest event.
+
+  std::vector<size_t> const event_iovs{0, 1, 0, 2, 1};
+  std::vector<std::shared_ptr<const DetPedestalRetrievalAlg::Handle>> handles;
+  for (size_t iov : event_iovs) {
+    handles.push_back(alg.HandleFor(eventTime(iov)));
+    alg.UpdateTimeStamp(eventTime(iov));
+    checkIOV(alg, iov);
+    checkIOV(*handles.back(), iov);
+  }
+
+  // Each handle still holds the data of its own event.
+
+  for (size_t i = 0; i < handles.size(); ++i)
+    checkIOV(*handles[i], event_iovs[i]);
+  BOOST_TEST((handles[0]->Start() == lariov::IOVTimeStamp(kFirstTime, 0)));
+  BOOST_TEST((handles[0]->End() == lariov::IOVTimeStamp(kFirstTime + kIOVLength, 0)));
+
+  // Handles of events in the same IOV share the same data.
+
+  BOOST_TEST(handles[0]->PedMeans().data() == handles[2]->PedMeans().data());
+  BOOST_TEST(handles[1]->PedMeans().data() == handles[4]->PedMeans().data());
+  BOOST_TEST(handles[0]->PedMeans().data() != handles[1]->PedMeans().data());
+
+  // Handles keep their data alive after many other IOVs were visited.
+
+  for (size_t round = 0; round < 3; ++round) {
+    for (size_t iov = 0; iov < kIOVs; ++iov)
+      alg.UpdateTimeStamp(eventTime(iov));
+  }
+  checkIOV(alg, kIOVs - 1);
+  for (size_t i = 0; i < handles.size(); ++i)
+    checkIOV(*handles[i], event_iovs[i]);
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_events)
+{
+  DetPedestalRetrievalAlg alg("pedestals", server.URL(), "v1");
+
+  // Several schedules process events of different IOVs at the same time,
+  // each through its own handle, while the latest event time keeps changing.
+
+  std::atomic<unsigned int> wrong{0};
+  std::vector<std::thread> schedules;
+  for (size_t schedule = 0; schedule < 4; ++schedule) {
+    schedules.emplace_back([&alg, &wrong, schedule] {
+      for (size_t event = 0; event < 50; ++event) {
+        size_t const iov = (schedule + event) % kIOVs;
+        alg.UpdateTimeStamp(eventTime(iov));
+        auto const handle = alg.HandleFor(eventTime(iov));
+        for (lariov::DBChannelID_t ch = 0; ch < kChannels; ++ch) {
+          if (handle->PedMean(ch) != expectedMean(iov, ch)) ++wrong;
+        }
+      }
+    });
+  }
+  for (auto& schedule : schedules)
+    schedule.join();
+  BOOST_TEST(wrong == 0U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_FIXTURE_TEST_SUITE(folder_updates, PedestalServer)
+
+BOOST_AUTO_TEST_CASE(patched_snapshot_equals_rebuild)
+{
+  // Visiting the IOVs in order patches the rows that changed, while a new
+  // provider for each IOV builds all rows.
+
+  DetPedestalRetrievalAlg patched("partial", server.URL(), "v1");
+  unsigned long touched = 0;
+  for (size_t iov = 0; iov < kIOVs; ++iov) {
+    BOOST_TEST_CONTEXT("IOV " << iov)
+    {
+      patched.UpdateTimeStamp(eventTime(iov));
+      DetPedestalRetrievalAlg rebuilt("partial", server.URL(), "v1");
+      rebuilt.UpdateTimeStamp(eventTime(iov));
+      checkSame(patched, rebuilt);
+      for (lariov::DBChannelID_t ch = 0; ch < kChannels; ++ch)
+        BOOST_TEST(patched.PedMean(ch) == 1000.f + ch + 100.f * lastChange(iov, ch));
+      BOOST_TEST(rebuilt.RowsTouched() == kChannels);
+
+      // Only changed rows are touched (none for the unchanged payload of IOV 2).
+
+      touched += (iov == 0) ? kChannels : (kChanges.count(iov) ? kChanges.at(iov).size() : 0);
+      BOOST_TEST(patched.RowsTouched() == touched);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(unchanged_payload_skipped)
+{
+  // The folder reports that no rows changed between payloads with the same
+  // fingerprint, in IOVs that differ.
+
+  lariov::DBFolder folder("partial", server.URL(), "", "v1");
+  BOOST_TEST(folder.UpdateData(eventTime(1)));
+  std::uint64_t const fingerprint = folder.CachedFingerprint();
+  BOOST_TEST(folder.UpdateData(eventTime(2)));
+  BOOST_TEST((folder.CachedStart() == beginTime(2)));
+  BOOST_TEST(folder.CachedFingerprint() == fingerprint);
+  BOOST_TEST(folder.PreviousFingerprint() == fingerprint);
+  BOOST_TEST(folder.HasChangedRows());
+  BOOST_TEST(folder.ChangedRows().empty());
+  BOOST_TEST(folder.UpdateData(eventTime(3)));
+  BOOST_TEST(folder.CachedFingerprint() != fingerprint);
+  BOOST_TEST(folder.ChangedRows() == std::vector<size_t>({5, 40}),
+             boost::test_tools::per_element());
+
+  // The provider keeps the snapshot, with the new validity range.
+
+  DetPedestalRetrievalAlg alg("partial", server.URL(), "v1");
+  auto const handle1 = alg.HandleFor(eventTime(1));
+  unsigned long const touched = alg.RowsTouched();
+  auto const handle2 = alg.HandleFor(eventTime(2));
+  BOOST_TEST(alg.RowsTouched() == touched);
+  BOOST_TEST((handle2->Start() == beginTime(2)));
+  BOOST_TEST((handle2->End() == beginTime(3)));
+  BOOST_TEST((handle1->End() == beginTime(2)));
+  checkSame(*handle1, *handle2);
+}
+
+BOOST_AUTO_TEST_CASE(iov_index)
+{
+  lariov::DBFolder folder("partial", server.URL(), "", "v1");
+  BOOST_TEST(!folder.HasIOVIndex());
+  lariov::IOVTimeStamp begin(0, 0);
+  lariov::IOVTimeStamp end(0, 0);
+  BOOST_TEST(!folder.FindIOV(beginTime(1), begin, end));
+
+  BOOST_TEST_REQUIRE(folder.LoadIOVIndex());
+  BOOST_TEST(folder.IOVBeginTimes().size() == kIOVs);
+
+  // IOV containing a time: from its begin time (included) to the next one.
+
+  BOOST_TEST(!folder.FindIOV(lariov::IOVTimeStamp(kFirstTime - 1, 0), begin, end));
+  BOOST_TEST(folder.FindIOV(beginTime(0), begin, end));
+  BOOST_TEST((begin == beginTime(0)));
+  BOOST_TEST((end == beginTime(1)));
+  BOOST_TEST(folder.FindIOV(lariov::IOVTimeStamp(kFirstTime + 2 * kIOVLength - 1, 0), begin, end));
+  BOOST_TEST((begin == beginTime(1)));
+  BOOST_TEST(folder.FindIOV(lariov::IOVTimeStamp(kFirstTime + 10 * kIOVLength, 0), begin, end));
+  BOOST_TEST((begin == beginTime(kIOVs - 1)));
+  BOOST_TEST((end == lariov::IOVTimeStamp::MaxTimeStamp()));
+
+  // IOVs overlapping [begin, end).
+
+  auto const in_range = [&folder](unsigned long begin, unsigned long end) {
+    std::vector<lariov::IOVTimeStamp> const iovs =
+      folder.IOVsInRange(lariov::IOVTimeStamp(begin, 0), lariov::IOVTimeStamp(end, 0));
+    std::vector<size_t> numbers;
+    for (auto const& iov : iovs)
+      numbers.push_back((iov.Stamp() - kFirstTime) / kIOVLength);
+    return numbers;
+  };
+  unsigned long const t0 = kFirstTime;
+  unsigned long const len = kIOVLength;
+  BOOST_TEST(in_range(t0, t0 + len) == std::vector<size_t>({0}), boost::test_tools::per_element());
+  BOOST_TEST(in_range(t0 + 10, t0 + len + 1) == std::vector<size_t>({0, 1}),
+             boost::test_tools::per_element());
+  BOOST_TEST(in_range(t0 + len, t0 + 3 * len) == std::vector<size_t>({1, 2}),
+             boost::test_tools::per_element());
+  BOOST_TEST(in_range(t0 + 3 * len + 5, t0 + 100 * len) == std::vector<size_t>({3}),
+             boost::test_tools::per_element());
+
+  // Data are requested at the IOV begin time, and match the IOV found.
+
+  BOOST_TEST(folder.UpdateData(eventTime(2)));
+  BOOST_TEST((folder.CachedStart() == beginTime(2)));
+  BOOST_TEST((folder.CachedEnd() == beginTime(3)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,168 @@
+/**
+ * @file   Snapshot_test.cxx
+ * @brief  Test of lariov::Snapshot
+ * @date   October 18th, 2026
+ */
+
+// Boost libraries
+#define BOOST_TEST_MODULE (snapshot_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "larevt/CalibrationDBI/IOVData/DetPedestal.h"
+#include "larevt/CalibrationDBI/IOVData/IOVDataError.h"
+#include "larevt/CalibrationDBI/IOVData/Snapshot.h"
+
+// C/C++ standard library
+#include <vector>
+
+namespace {
+
+  using Snapshot_t = lariov::Snapshot<lariov::DetPedestal>;
+
+  lariov::DetPedestal makePedestal(unsigned int ch, float mean)
+  {
+    lariov::DetPedestal pd(ch);
+    pd.SetPedMean(mean);
+    return pd;
+  }
+
+  // Build a snapshot from (channel, mean) pairs, in the order given.
+
+  using Duplicates = Snapshot_t::Builder::Duplicates;
+
+  Snapshot_t build(std::vector<std::pair<unsigned int, float>> const& rows,
+                   Duplicates policy = Duplicates::kKeepLast)
+  {
+    Snapshot_t snapshot;
+    Snapshot_t::Builder builder(policy);
+    builder.Reserve(rows.size());
+    for (auto const& [ch, mean] : rows)
+      builder.Append(makePedestal(ch, mean));
+    builder.Finalize(snapshot);
+    return snapshot;
+  }
+
+  void checkSorted(Snapshot_t const& snapshot)
+  {
+    auto const& data = snapshot.Data();
+    for (size_t i = 1; i < data.size(); ++i)
+      BOOST_TEST(data[i - 1].Channel() < data[i].Channel());
+  }
+
+} // local namespace
+
+BOOST_AUTO_TEST_CASE(builder_sorted_input)
+{
+  Snapshot_t snapshot = build({{0, 1.f}, {1, 2.f}, {5, 3.f}});
+  BOOST_TEST(snapshot.NChannels() == 3U);
+  checkSorted(snapshot);
+  BOOST_TEST(snapshot.GetRow(5).PedMean() == 3.f);
+  BOOST_TEST(!snapshot.HasChannel(2));
+}
+
+BOOST_AUTO_TEST_CASE(builder_unsorted_input)
+{
+  Snapshot_t snapshot = build({{7, 7.f}, {3, 3.f}, {9, 9.f}, {1, 1.f}});
+  BOOST_TEST(snapshot.NChannels() == 4U);
+  checkSorted(snapshot);
+  for (unsigned int ch : {1U, 3U, 7U, 9U})
+    BOOST_TEST(snapshot.GetRow(ch).PedMean() == float(ch));
+}
+
+BOOST_AUTO_TEST_CASE(builder_duplicates)
+{
+  std::vector<std::pair<unsigned int, float>> const rows{{4, 1.f}, {2, 2.f}, {4, 3.f}, {4, 4.f}};
+
+  // Keeping the last row matches AddOrReplaceRow.
+
+  Snapshot_t last = build(rows, Duplicates::kKeepLast);
+  BOOST_TEST(last.NChannels() == 2U);
+  BOOST_TEST(last.GetRow(4).PedMean() == 4.f);
+  Snapshot_t reference;
+  for (auto const& [ch, mean] : rows)
+    reference.AddOrReplaceRow(makePedestal(ch, mean));
+  BOOST_TEST(reference.GetRow(4).PedMean() == last.GetRow(4).PedMean());
+
+  Snapshot_t first = build(rows, Duplicates::kKeepFirst);
+  BOOST_TEST(first.NChannels() == 2U);
+  BOOST_TEST(first.GetRow(4).PedMean() == 1.f);
+
+  BOOST_CHECK_THROW(build(rows, Duplicates::kThrow), lariov::IOVDataError);
+}
+
+BOOST_AUTO_TEST_CASE(builder_replaces_data)
+{
+  Snapshot_t snapshot = build({{1, 1.f}, {2, 2.f}});
+  Snapshot_t::Builder builder;
+  builder.Append(makePedestal(3, 3.f));
+  builder.Finalize(snapshot);
+  BOOST_TEST(snapshot.NChannels() == 1U);
+  BOOST_TEST(snapshot.HasChannel(3));
+  BOOST_TEST(builder.Size() == 0U);
+}
+
+BOOST_AUTO_TEST_CASE(dense_index)
+{
+  // Compact channel range with a gap: dense index, missing channels not found.
+
+  Snapshot_t dense = build({{10, 10.f}, {11, 11.f}, {13, 13.f}});
+  BOOST_TEST(dense.HasDenseIndex());
+  BOOST_TEST(dense.GetRow(13).PedMean() == 13.f);
+  for (unsigned int ch : {0U, 9U, 12U, 14U, 1000U})
+    BOOST_TEST(!dense.HasChannel(ch));
+  BOOST_CHECK_THROW(dense.GetRow(12), lariov::IOVDataError);
+
+  // Adding a row keeps the index consistent.
+
+  dense.AddOrReplaceRow(makePedestal(12, 12.f));
+  dense.AddOrReplaceRow(makePedestal(5, 5.f));
+  dense.AddOrReplaceRow(makePedestal(11, 21.f));
+  BOOST_TEST(dense.HasDenseIndex());
+  for (unsigned int ch : {5U, 10U, 12U, 13U})
+    BOOST_TEST(dense.GetRow(ch).PedMean() == float(ch));
+  BOOST_TEST(dense.GetRow(11).PedMean() == 21.f);
+  BOOST_TEST(!dense.HasChannel(6));
+
+  // Sparse channel range: binary search, same answers.
+
+  Snapshot_t sparse = build({{1, 1.f}, {100000, 2.f}});
+  BOOST_TEST(!sparse.HasDenseIndex());
+  BOOST_TEST(sparse.GetRow(100000).PedMean() == 2.f);
+  BOOST_TEST(!sparse.HasChannel(50000));
+
+  sparse.Clear();
+  BOOST_TEST(!sparse.HasChannel(1));
+}
+
+BOOST_AUTO_TEST_CASE(incremental_index)
+{
+  // Rows added in channel order extend the index, lookups interleaved.
+
+  Snapshot_t snapshot;
+  for (unsigned int ch = 0; ch < 1000; ch += 2) {
+    snapshot.AddOrReplaceRow(makePedestal(ch, float(ch)));
+    BOOST_TEST(snapshot.GetRow(ch).PedMean() == float(ch));
+    BOOST_TEST(!snapshot.HasChannel(ch + 1));
+  }
+  BOOST_TEST(snapshot.HasDenseIndex());
+
+  // Rows inserted before the back: index rebuilt at the next lookup.
+
+  snapshot.AddOrReplaceRow(makePedestal(1, 1.f));
+  snapshot.AddOrReplaceRow(makePedestal(501, 501.f));
+  snapshot.UpdateIndex();
+  BOOST_TEST(snapshot.HasDenseIndex());
+  for (unsigned int ch : {0U, 1U, 2U, 500U, 501U, 998U})
+    BOOST_TEST(snapshot.GetRow(ch).PedMean() == float(ch));
+  BOOST_TEST(!snapshot.HasChannel(3));
+
+  // A far channel makes the range sparse, a copy keeps the lookups.
+
+  snapshot.AddOrReplaceRow(makePedestal(1000000, 1.f));
+  Snapshot_t const copy = snapshot;
+  BOOST_TEST(!copy.HasDenseIndex());
+  BOOST_TEST(copy.GetRow(1000000).PedMean() == 1.f);
+  BOOST_TEST(copy.GetRow(998).PedMean() == 998.f);
+  BOOST_TEST(!copy.HasChannel(999));
+}